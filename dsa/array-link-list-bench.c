@@ -0,0 +1,100 @@
+// Build: gcc -O2 array-link-list-bench.c array-link-list.c link-list.c list-index.c list-split.c node-pool.c -o array-link-list-bench
+// Usage: ./array-link-list-bench [nodes]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "array-link-list.h"
+#include "link-list.h"
+
+#define SCANS 5
+
+// Scan time per element for a key search that finds nothing
+double time_plain_scan(const LinkList *list)
+{
+  double start = now_seconds();
+  int found = 0;
+  for (int s = 0; s < SCANS; s++)
+  {
+    const sNode *temp = list_front(list);
+    while (temp != NULL && temp->data != -1)
+      temp = temp->link;
+    found += temp != NULL;
+  }
+  return (now_seconds() - start) * 1e9 / ((double)list->length * SCANS) + found;
+}
+
+double time_array_scan(const ArrayList *list)
+{
+  double start = now_seconds();
+  int found = 0;
+  for (int s = 0; s < SCANS; s++)
+    found += alist_contains(list, -1);
+  return (now_seconds() - start) * 1e9 / ((double)list->length * SCANS) + found;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  printf("=== Array-Backed vs Pointer Linked List (%d nodes) ===\n", n);
+  printf("Node size: sNode %zu bytes, aNode %zu bytes\n\n", sizeof(sNode),
+         sizeof(aNode));
+
+  // Build both lists by inserting after a random existing node, so the
+  // traversal order ends up scattered across memory
+  LinkList list;
+  ArrayList alist;
+  sNode **nodes = malloc(n * sizeof(sNode *));
+  uint32_t *slots = malloc(n * sizeof(uint32_t));
+
+  list_init(&list);
+  alist_init(&alist, 16);
+
+  double start = now_seconds();
+  nodes[0] = list_append(&list, 0);
+  srand(9);
+  for (int i = 1; i < n; i++)
+    nodes[i] = list_insert_after(&list, nodes[rand() % i], i);
+  double plain_build = now_seconds() - start;
+
+  start = now_seconds();
+  slots[0] = alist_append(&alist, 0);
+  srand(9);
+  for (int i = 1; i < n; i++)
+    slots[i] = alist_insert_after(&alist, slots[rand() % i], i);
+  double array_build = now_seconds() - start;
+
+  // Same order in both
+  int same = 1;
+  const sNode *temp = list_front(&list);
+  for (uint32_t s = alist.front; s != ALIST_NIL && same; s = alist.nodes[s].link, temp = temp->link)
+    same = temp->data == alist.nodes[s].data;
+
+  printf("Build (random insert-after)  plain %.3fs  array %.3fs  (%s order)\n",
+         plain_build, array_build, same ? "same" : "DIFFERENT");
+  printf("Memory  plain %.1f MB  array %.1f MB (capacity %u)\n",
+         (double)n * sizeof(sNode) / 1e6, (double)alist.capacity * sizeof(aNode) / 1e6,
+         alist.capacity);
+
+  printf("\nKey-search scan, ns/element:\n");
+  double plain_scattered = time_plain_scan(&list);
+  double array_scattered = time_array_scan(&alist);
+  printf("  plain list, scattered    %6.2f\n", plain_scattered);
+  printf("  array list, scattered    %6.2f\n", array_scattered);
+
+  start = now_seconds();
+  alist_compact(&alist);
+  double compact = now_seconds() - start;
+  double array_compact = time_array_scan(&alist);
+  printf("  array list, compacted    %6.2f  (compaction %.3fs, %.1fx faster than plain)\n",
+         array_compact, compact, plain_scattered / array_compact);
+
+  free(nodes);
+  free(slots);
+  list_destroy(&list);
+  alist_destroy(&alist);
+
+  return 0;
+}
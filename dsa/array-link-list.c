@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array-link-list.h"
+
+#define MIN_CAPACITY 16 // Slots in a new array
+
+_Static_assert(sizeof(aNode) == 8, "aNode must stay half the size of sNode");
+
+int alist_init(ArrayList *list, uint32_t capacity)
+{
+  if (capacity == 0)
+  {
+    capacity = MIN_CAPACITY;
+  }
+  list->nodes = malloc((size_t)capacity * sizeof(aNode));
+  list->capacity = list->nodes != NULL ? capacity : 0;
+  list->used = 0;
+  list->free_list = ALIST_NIL;
+  list->front = ALIST_NIL;
+  list->tail = ALIST_NIL;
+  list->length = 0;
+  return list->nodes != NULL;
+}
+
+void alist_destroy(ArrayList *list)
+{
+  free(list->nodes);
+  list->nodes = NULL;
+  list->capacity = 0;
+  list->used = 0;
+  list->free_list = ALIST_NIL;
+  list->front = ALIST_NIL;
+  list->tail = ALIST_NIL;
+  list->length = 0;
+}
+
+// Take a free slot, doubling the array when it is full. A list whose
+// alist_init() failed has no array yet and starts at MIN_CAPACITY.
+static uint32_t alloc_slot(ArrayList *list)
+{
+  if (list->free_list != ALIST_NIL)
+  {
+    uint32_t slot = list->free_list;
+    list->free_list = list->nodes[slot].link;
+    return slot;
+  }
+
+  if (list->used == list->capacity)
+  {
+    if (list->capacity >= ALIST_NIL / 2)
+    {
+      return ALIST_NIL;
+    }
+    uint32_t capacity = list->capacity > 0 ? list->capacity * 2 : MIN_CAPACITY;
+    aNode *grown = realloc(list->nodes, (size_t)capacity * sizeof(aNode));
+    if (grown == NULL)
+    {
+      return ALIST_NIL;
+    }
+    list->nodes = grown;
+    list->capacity = capacity;
+  }
+  return list->used++;
+}
+
+uint32_t alist_insert_after(ArrayList *list, uint32_t prev, int data)
+{
+  uint32_t slot = alloc_slot(list);
+  if (slot == ALIST_NIL)
+  {
+    return ALIST_NIL;
+  }
+
+  list->nodes[slot].data = data;
+  if (prev == ALIST_NIL)
+  {
+    list->nodes[slot].link = list->front;
+    list->front = slot;
+  }
+  else
+  {
+    list->nodes[slot].link = list->nodes[prev].link;
+    list->nodes[prev].link = slot;
+  }
+  if (list->nodes[slot].link == ALIST_NIL)
+  {
+    list->tail = slot;
+  }
+  list->length++;
+  return slot;
+}
+
+uint32_t alist_push_front(ArrayList *list, int data)
+{
+  return alist_insert_after(list, ALIST_NIL, data);
+}
+
+uint32_t alist_append(ArrayList *list, int data)
+{
+  return alist_insert_after(list, list->tail, data);
+}
+
+int alist_insert_at(ArrayList *list, int data, uint32_t position)
+{
+  if (position < 1 || position > list->length + 1)
+  {
+    return 0;
+  }
+
+  uint32_t prev = ALIST_NIL;
+  if (position > 1)
+  {
+    prev = list->front;
+    for (uint32_t i = 2; i < position; i++)
+    {
+      prev = list->nodes[prev].link;
+    }
+  }
+  return alist_insert_after(list, prev, data) != ALIST_NIL;
+}
+
+int alist_delete_key(ArrayList *list, int key)
+{
+  uint32_t prev = ALIST_NIL;
+  uint32_t temp = list->front;
+
+  while (temp != ALIST_NIL && list->nodes[temp].data != key)
+  {
+    prev = temp;
+    temp = list->nodes[temp].link;
+  }
+  if (temp == ALIST_NIL)
+  {
+    return 0;
+  }
+
+  uint32_t next = list->nodes[temp].link;
+  if (prev == ALIST_NIL)
+    list->front = next;
+  else
+    list->nodes[prev].link = next;
+  if (list->tail == temp)
+    list->tail = prev;
+
+  list->nodes[temp].link = list->free_list;
+  list->free_list = temp;
+  list->length--;
+  return 1;
+}
+
+int alist_contains(const ArrayList *list, int key)
+{
+  for (uint32_t temp = list->front; temp != ALIST_NIL; temp = list->nodes[temp].link)
+  {
+    if (list->nodes[temp].data == key)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int alist_compact(ArrayList *list)
+{
+  aNode *packed = malloc((size_t)list->capacity * sizeof(aNode));
+  if (packed == NULL)
+  {
+    return 0;
+  }
+
+  // Node number i of the traversal lands in slot i and links to i + 1
+  uint32_t i = 0;
+  for (uint32_t temp = list->front; temp != ALIST_NIL; temp = list->nodes[temp].link)
+  {
+    packed[i].data = list->nodes[temp].data;
+    packed[i].link = i + 1;
+    i++;
+  }
+
+  free(list->nodes);
+  list->nodes = packed;
+  list->used = list->length;
+  list->free_list = ALIST_NIL;
+  if (list->length == 0)
+  {
+    list->front = ALIST_NIL;
+    list->tail = ALIST_NIL;
+  }
+  else
+  {
+    packed[list->length - 1].link = ALIST_NIL;
+    list->front = 0;
+    list->tail = list->length - 1;
+  }
+  return 1;
+}
+
+void alist_print(const ArrayList *list, const char *label)
+{
+  printf("%s: ", label);
+  for (uint32_t temp = list->front; temp != ALIST_NIL; temp = list->nodes[temp].link)
+  {
+    printf("%d -> ", list->nodes[temp].data);
+  }
+  printf("NULL\n");
+}
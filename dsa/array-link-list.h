@@ -0,0 +1,59 @@
+#ifndef ARRAY_LINK_LIST_H
+#define ARRAY_LINK_LIST_H
+
+#include <stdint.h>
+
+// Linked list stored in one contiguous array, with 32-bit indices as links.
+//
+// A node is 8 bytes (int + uint32 link) instead of the 16 of sNode, growth
+// is a single realloc that doubles the array (indices stay valid), and
+// alist_compact() rewrites the array in traversal order so a scan becomes
+// a sequential sweep.
+
+#define ALIST_NIL UINT32_MAX
+
+typedef struct
+{
+  int data;
+  uint32_t link; // Index of the next node, ALIST_NIL at the end
+} aNode;
+
+typedef struct
+{
+  aNode *nodes;
+  uint32_t capacity;  // Slots allocated
+  uint32_t used;      // Slots handed out at least once
+  uint32_t free_list; // Recycled slots, linked through link
+  uint32_t front;
+  uint32_t tail;
+  uint32_t length;
+} ArrayList;
+
+int alist_init(ArrayList *list, uint32_t capacity);
+void alist_destroy(ArrayList *list);
+
+// Insert and return the new node's index, ALIST_NIL if out of memory.
+// alist_insert_after() takes ALIST_NIL as prev to insert at the front.
+uint32_t alist_append(ArrayList *list, int data);
+uint32_t alist_push_front(ArrayList *list, int data);
+uint32_t alist_insert_after(ArrayList *list, uint32_t prev, int data);
+
+// Insert data so it becomes node number position (1 = front), returns 1 on
+// success and 0 if the position is out of range
+int alist_insert_at(ArrayList *list, int data, uint32_t position);
+
+// Delete the first node holding key, returns 1 if one was removed
+int alist_delete_key(ArrayList *list, int key);
+
+// Returns 1 if key is in the list
+int alist_contains(const ArrayList *list, int key);
+
+// Relink nodes in traversal order and drop free slots, returns 0 if out
+// of memory (the list is unchanged then). Nodes are renumbered, so indices
+// returned by the insert functions before it no longer refer to them.
+int alist_compact(ArrayList *list);
+
+// Print as "label: 2 -> 20 -> 100 -> NULL"
+void alist_print(const ArrayList *list, const char *label);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <time.h>
+
+// Shared by the *-bench.c programs, header-only so their Build lines need
+// no extra source file
+
+// Monotonic time in seconds
+static inline double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#endif
@@ -1,47 +1,29 @@
+// Build: gcc create-link-list.c link-list.c list-index.c list-split.c node-pool.c -o create-link-list
+// Usage: ./create-link-list
+
 #include <stdio.h>
-#include <stdlib.h>
 
-// Defining self referencing structure
-typedef struct sNode
-{
-  int data;
-  struct sNode *link;
-} sNode;
+#include "link-list.h"
 
 int main()
 {
+  // creating the list, nodes come from its pool instead of one malloc each
+  LinkList list;
+  list_init(&list);
 
-  // creating front node
-  sNode *front = NULL;
-  sNode *first = NULL;
-  sNode *second = NULL;
-
-  // allocate memory for front node
-  front = (sNode *)malloc(sizeof(sNode));
-  front->data = 2;
-
-  // allocate memory for first node
-  first = (sNode *)malloc(sizeof(sNode));
-  first->data = 20;
-
-  // allocate memory for second node
-  second = (sNode *)malloc(sizeof(sNode));
-  second->data = 100;
-
-  // linking part
-  front->link = first;
-  first->link = second;
-  second->link = NULL;
-
-  sNode *temp = front;
-
-  printf("SingleLinked list: ");
-  while (temp != NULL)
+  // front node, first node and second node
+  if (list_append(&list, 2) == NULL || list_append(&list, 20) == NULL ||
+      list_append(&list, 100) == NULL)
   {
-    printf("%d -> ", temp->data);
-    temp = temp->link;
+    printf("Out of memory!\n");
+    list_destroy(&list);
+    return 1;
   }
-  printf("NULL\n");
+
+  list_print(&list, "SingleLinked list");
+
+  // free every node before exiting
+  list_destroy(&list);
 
   return 0;
-}
\ No newline at end of file
+}
@@ -1,87 +1,45 @@
+// Build: gcc delete-link-list.c link-list.c list-index.c list-split.c node-pool.c -o delete-link-list
+// Usage: ./delete-link-list
+
 #include <stdio.h>
-#include <stdlib.h>
 
-// Defining self referencing structure
-typedef struct sNode
-{
-  int data;
-  struct sNode *link;
-} sNode;
+#include "link-list.h"
 
 int main()
 {
-
-  // creating front node
-  sNode *front = NULL;
-  sNode *first = NULL;
-  sNode *second = NULL;
-
-  // allocate memory for front node
-  front = (sNode *)malloc(sizeof(sNode));
-  front->data = 2;
-
-  // allocate memory for first node
-  first = (sNode *)malloc(sizeof(sNode));
-  first->data = 20;
-
-  // allocate memory for second node
-  second = (sNode *)malloc(sizeof(sNode));
-  second->data = 100;
-
-  // linking part
-  front->link = first;
-  first->link = second;
-  second->link = NULL;
-
-  // deletion part
-  sNode *temp = front;
-
-  // before deletion
-  printf("Original list: ");
-  while (temp != NULL)
+  // creating the list with its front, first and second node
+  LinkList list;
+  list_init(&list);
+  if (list_append(&list, 2) == NULL || list_append(&list, 20) == NULL ||
+      list_append(&list, 100) == NULL)
   {
-    printf("%d -> ", temp->data);
-    temp = temp->link;
+    printf("Out of memory!\n");
+    list_destroy(&list);
+    return 1;
   }
-  printf("NULL\n");
 
-  sNode *prev = NULL;
-  temp = front;
+  // before deletion
+  list_print(&list, "Original list");
 
   // key to search which to delete
-  int key;
+  int key = 0;
   printf("Enter the key you want to delete: ");
   scanf("%d", &key);
 
-  if (temp != NULL && temp->data == key) // if it is the head to delete
-  {
-    front = temp->link;
-    free(temp);
-  }
-  // if it is not the head to delete
-  else
+  // the head and any later node are unlinked the same way, through the
+  // list's sentinel, and go back to the pool
+  if (!list_delete_key(&list, key))
   {
-    while (temp != NULL && temp->data != key)
-    {
-      prev = temp;
-      temp = temp->link;
-    }
-    if (temp != NULL)
-    {
-      prev->link = temp->link;
-      free(temp);
-    }
+    printf("Key %d not found\n", key);
   }
 
   // after deletion
-  printf("After deletion %d : ", key);
-  temp = front;
-  while (temp != NULL)
-  {
-    printf("%d -> ", temp->data);
-    temp = temp->link;
-  }
-  printf("NULL\n");
+  char label[64];
+  snprintf(label, sizeof(label), "After deletion %d", key);
+  list_print(&list, label);
+
+  // free every node before exiting
+  list_destroy(&list);
 
   return 0;
-}
\ No newline at end of file
+}
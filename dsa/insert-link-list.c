@@ -1,50 +1,29 @@
+// Build: gcc insert-link-list.c link-list.c list-index.c list-split.c node-pool.c -o insert-link-list
+// Usage: ./insert-link-list
+
 #include <stdio.h>
-#include <stdlib.h>
 
-// Defining self referencing structure
-typedef struct sNode
-{
-  int data;
-  struct sNode *link;
-} sNode;
+#include "link-list.h"
 
 int main()
 {
-  // creating nodes
-  sNode *front = NULL;
-  sNode *first = NULL;
-  sNode *second = NULL;
-
-  // allocate memory for front node
-  front = (sNode *)malloc(sizeof(sNode));
-  front->data = 2;
-
-  // allocate memory for first node
-  first = (sNode *)malloc(sizeof(sNode));
-  first->data = 20;
-
-  // allocate memory for second node
-  second = (sNode *)malloc(sizeof(sNode));
-  second->data = 100;
-
-  // linking part
-  front->link = first;
-  first->link = second;
-  second->link = NULL;
-
-  // before inserting
-  printf("Original list: ");
-  sNode *temp = front;
-  while (temp != NULL)
+  // creating the list with its front, first and second node
+  LinkList list;
+  list_init(&list);
+  if (list_append(&list, 2) == NULL || list_append(&list, 20) == NULL ||
+      list_append(&list, 100) == NULL)
   {
-    printf("%d -> ", temp->data);
-    temp = temp->link;
+    printf("Out of memory!\n");
+    list_destroy(&list);
+    return 1;
   }
-  printf("NULL\n");
+
+  // before inserting
+  list_print(&list, "Original list");
 
   // inserting with position
-  int position;
-  int addData;
+  int position = 0;
+  int addData = 0;
 
   printf("Enter the data you want to insert: ");
   scanf("%d", &addData);
@@ -52,46 +31,19 @@ int main()
   printf("Enter the position you want to insert: ");
   scanf("%d", &position);
 
-  // create newNode
-  sNode *newNode = (sNode *)malloc(sizeof(sNode));
-  newNode->data = addData;
-  newNode->link = NULL;
-
-  if (position == 1)
-  {
-    // inserting at the beginning
-    newNode->link = front;
-    front = newNode;
-  }
-  // inserting in between
-  else
+  // position 1 inserts at the beginning, anything else in between
+  if (!list_insert_at(&list, addData, position))
   {
-    temp = front;
-    for (int i = 1; i < position - 1 && temp != NULL; i++)
-    {
-      temp = temp->link;
-    }
-    // if the position is invalid
-    if (temp == NULL)
-    {
-      printf("Position out of range!\n");
-    }
-    else
-    {
-      newNode->link = temp->link;
-      temp->link = newNode;
-    }
+    printf("Position out of range!\n");
   }
 
   // after insertion
-  printf("After inserting %d at position %d: ", addData, position);
-  temp = front;
-  while (temp != NULL)
-  {
-    printf("%d -> ", temp->data);
-    temp = temp->link;
-  }
-  printf("NULL\n");
+  char label[64];
+  snprintf(label, sizeof(label), "After inserting %d at position %d", addData, position);
+  list_print(&list, label);
+
+  // free every node before exiting
+  list_destroy(&list);
 
   return 0;
 }
@@ -0,0 +1,95 @@
+// Build: gcc -O2 link-list-bench.c link-list.c list-index.c list-split.c node-pool.c -o link-list-bench
+// Usage: ./link-list-bench [nodes]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "link-list.h"
+
+// Classic list: one malloc per node, one free per node
+void bench_malloc(int n)
+{
+  double start = now_seconds();
+
+  sNode *front = NULL;
+  sNode *last = NULL;
+  for (int i = 0; i < n; i++)
+  {
+    sNode *newNode = (sNode *)malloc(sizeof(sNode));
+    newNode->data = i;
+    newNode->link = NULL;
+    if (front == NULL)
+      front = newNode;
+    else
+      last->link = newNode;
+    last = newNode;
+  }
+  double built = now_seconds();
+
+  long long sum = 0;
+  for (sNode *temp = front; temp != NULL; temp = temp->link)
+  {
+    sum += temp->data;
+  }
+  double scanned = now_seconds();
+
+  while (front != NULL)
+  {
+    sNode *next = front->link;
+    free(front);
+    front = next;
+  }
+  double freed = now_seconds();
+
+  printf("%-14s build %7.3fs  scan %7.3fs  teardown %7.3fs  (sum %lld)\n",
+         "malloc/free", built - start, scanned - built, freed - scanned, sum);
+}
+
+// Pooled list: chunked allocation, bulk teardown
+void bench_pool(int n)
+{
+  double start = now_seconds();
+
+  LinkList list;
+  list_init(&list);
+  for (int i = 0; i < n; i++)
+  {
+    list_append(&list, i);
+  }
+  double built = now_seconds();
+
+  long long sum = 0;
+  for (sNode *temp = list_front(&list); temp != NULL; temp = temp->link)
+  {
+    sum += temp->data;
+  }
+  double scanned = now_seconds();
+
+  PoolStats stats;
+  pool_stats(&list.pool, &stats);
+
+  list_destroy(&list);
+  double freed = now_seconds();
+
+  printf("%-14s build %7.3fs  scan %7.3fs  teardown %7.3fs  (sum %lld)\n",
+         "node pool", built - start, scanned - built, freed - scanned, sum);
+  pool_print_stats(&stats, "  pool");
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  printf("=== Linked List Allocation Benchmark (%d nodes) ===\n", n);
+  bench_malloc(n);
+  bench_pool(n);
+
+  // Every list has been destroyed, so nothing may be left registered
+  PoolStats total;
+  pool_total_stats(&total);
+  printf("\nLeak check: %zu pools, %zu nodes still live\n", total.pools,
+         total.live_objects);
+
+  return 0;
+}
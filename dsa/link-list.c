@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "link-list.h"
+
+void list_init(LinkList *list)
+{
+  list->head.data = 0;
+  list->head.link = NULL;
+  list->tail = &list->head;
+  list->length = 0;
+  list->index = NULL;
+  list->split = NULL;
+  pool_init(&list->pool, sizeof(sNode));
+}
+
+void list_destroy(LinkList *list)
+{
+  list_index_detach(list);
+  list_split_detach(list);
+
+  // No per-node walk: the nodes all live in the pool's chunks
+  pool_destroy(&list->pool);
+  list->head.link = NULL;
+  list->tail = &list->head;
+  list->length = 0;
+}
+
+sNode *list_front(const LinkList *list)
+{
+  return list->head.link;
+}
+
+sNode *list_insert_after(LinkList *list, sNode *prev, int data)
+{
+  sNode *newNode = pool_alloc(&list->pool);
+  if (newNode == NULL)
+  {
+    return NULL;
+  }
+  if (list->index != NULL && !index_reserve(list->index))
+  {
+    pool_free(&list->pool, newNode);
+    return NULL;
+  }
+
+  sNode *next = prev->link;
+  newNode->data = data;
+  newNode->link = next;
+  prev->link = newNode;
+
+  if (list->index != NULL)
+  {
+    // The old successor now follows the new node
+    if (next != NULL)
+    {
+      index_repoint(list->index, next->data, prev, newNode);
+    }
+    index_add(list->index, prev);
+  }
+
+  if (list->split != NULL)
+  {
+    split_insert(list->split, newNode,
+                 prev == &list->head ? SPLIT_FRONT
+                 : prev == list->tail ? SPLIT_BACK
+                                      : SPLIT_MIDDLE);
+  }
+
+  if (prev == list->tail)
+  {
+    list->tail = newNode;
+  }
+  list->length++;
+  return newNode;
+}
+
+sNode *list_push_front(LinkList *list, int data)
+{
+  return list_insert_after(list, &list->head, data);
+}
+
+sNode *list_append(LinkList *list, int data)
+{
+  return list_insert_after(list, list->tail, data);
+}
+
+int list_insert_at(LinkList *list, int data, int position)
+{
+  if (position < 1 || (size_t)position > list->length + 1)
+  {
+    return 0;
+  }
+
+  // Walk to the node before the position, the sentinel stands in for 0
+  sNode *prev = &list->head;
+  for (int i = 1; i < position; i++)
+  {
+    prev = prev->link;
+  }
+  return list_insert_after(list, prev, data) != NULL;
+}
+
+void list_remove_after(LinkList *list, sNode *prev)
+{
+  sNode *temp = prev->link;
+  sNode *next = temp->link;
+
+  if (list->index != NULL)
+  {
+    index_erase(list->index, prev);
+  }
+  if (list->split != NULL)
+  {
+    split_remove(list->split, temp);
+  }
+  prev->link = next;
+  if (list->index != NULL && next != NULL)
+  {
+    index_repoint(list->index, next->data, temp, prev);
+  }
+
+  if (temp == list->tail)
+  {
+    list->tail = prev;
+  }
+  list->length--;
+  pool_free(&list->pool, temp);
+}
+
+int list_delete_key(LinkList *list, int key)
+{
+  if (list->index != NULL)
+  {
+    sNode *pred = index_find_pred(list->index, key);
+    if (pred == NULL)
+    {
+      return 0;
+    }
+    list_remove_after(list, pred);
+    return 1;
+  }
+
+  sNode *prev = &list->head;
+
+  while (prev->link != NULL && prev->link->data != key)
+  {
+    prev = prev->link;
+  }
+  if (prev->link == NULL)
+  {
+    return 0;
+  }
+  list_remove_after(list, prev);
+  return 1;
+}
+
+int list_delete_all_keys(LinkList *list, int key)
+{
+  int removed = 0;
+
+  if (list->index != NULL)
+  {
+    sNode *pred;
+    while ((pred = index_find_pred(list->index, key)) != NULL)
+    {
+      list_remove_after(list, pred);
+      removed++;
+    }
+    return removed;
+  }
+
+  // One pass, staying on prev after a removal to check the new successor
+  sNode *prev = &list->head;
+  while (prev->link != NULL)
+  {
+    if (prev->link->data == key)
+    {
+      list_remove_after(list, prev);
+      removed++;
+    }
+    else
+    {
+      prev = prev->link;
+    }
+  }
+  return removed;
+}
+
+sNode *list_find_key(const LinkList *list, int key)
+{
+  if (list->index != NULL)
+  {
+    sNode *pred = index_find_pred(list->index, key);
+    return pred != NULL ? pred->link : NULL;
+  }
+
+  sNode *temp = list->head.link;
+  while (temp != NULL && temp->data != key)
+  {
+    temp = temp->link;
+  }
+  return temp;
+}
+
+int list_index_attach(LinkList *list)
+{
+  if (list->index != NULL)
+  {
+    return 1;
+  }
+
+  ListIndex *index = malloc(sizeof(ListIndex));
+  if (index == NULL || !index_build(index, &list->head, list->length))
+  {
+    free(index);
+    return 0;
+  }
+  list->index = index;
+  return 1;
+}
+
+void list_index_detach(LinkList *list)
+{
+  if (list->index != NULL)
+  {
+    index_free(list->index);
+    free(list->index);
+    list->index = NULL;
+  }
+}
+
+int list_index_reserve(LinkList *list, size_t length)
+{
+  return list->index == NULL || index_reserve_total(list->index, length);
+}
+
+void list_index_rebuild(LinkList *list)
+{
+  if (list->index != NULL)
+  {
+    index_refill(list->index, &list->head);
+  }
+}
+
+int list_split_attach(LinkList *list, int segments)
+{
+  if (list->split != NULL)
+  {
+    return 1;
+  }
+
+  ListSplit *split = malloc(sizeof(ListSplit));
+  if (split == NULL || !split_init(split, segments))
+  {
+    free(split);
+    return 0;
+  }
+  split_build(split, list_front(list), list->length);
+  list->split = split;
+  return 1;
+}
+
+void list_split_detach(LinkList *list)
+{
+  if (list->split != NULL)
+  {
+    split_free(list->split);
+    free(list->split);
+    list->split = NULL;
+  }
+}
+
+void list_split_appended(LinkList *list, sNode *run, size_t count)
+{
+  if (list->split != NULL)
+  {
+    split_append_run(list->split, run, count);
+  }
+}
+
+void list_split_relinked(LinkList *list)
+{
+  if (list->split != NULL)
+  {
+    split_relinked(list->split, list_front(list), list->length);
+  }
+}
+
+void list_print(const LinkList *list, const char *label)
+{
+  printf("%s: ", label);
+  for (sNode *temp = list_front(list); temp != NULL; temp = temp->link)
+  {
+    printf("%d -> ", temp->data);
+  }
+  printf("NULL\n");
+}
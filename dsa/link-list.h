@@ -0,0 +1,91 @@
+#ifndef LINK_LIST_H
+#define LINK_LIST_H
+
+#include <stddef.h>
+
+#include "list-index.h"
+#include "list-split.h"
+#include "node-pool.h"
+
+// Singly linked list of ints whose nodes come from a NodePool.
+//
+// Inserts never call malloc once the pool has warmed up, deleted nodes are
+// recycled through the pool's free list, and list_destroy() releases the
+// whole list chunk by chunk.
+
+// Defining self referencing structure
+typedef struct sNode
+{
+  int data;
+  struct sNode *link;
+} sNode;
+
+typedef struct
+{
+  sNode head;    // Sentinel: head.link is the front node
+  sNode *tail;   // Last node, or &head when empty
+  size_t length;
+  NodePool pool;
+  ListIndex *index; // Key index, NULL when not attached
+  ListSplit *split; // Segment starts for parallel walks, NULL when not attached
+} LinkList;
+
+void list_init(LinkList *list);
+void list_destroy(LinkList *list);
+
+// First node (NULL when empty)
+sNode *list_front(const LinkList *list);
+
+// Insert at the front / back, return the new node or NULL if out of memory
+sNode *list_push_front(LinkList *list, int data);
+sNode *list_append(LinkList *list, int data);
+
+// Insert after a node (use &list->head for the front)
+sNode *list_insert_after(LinkList *list, sNode *prev, int data);
+
+// Insert data so it becomes node number position (1 = front), returns 1 on
+// success and 0 if the position is out of range
+int list_insert_at(LinkList *list, int data, int position);
+
+// Delete the first node holding key, returns 1 if one was removed
+int list_delete_key(LinkList *list, int key);
+
+// Delete every node holding key, returns how many were removed
+int list_delete_all_keys(LinkList *list, int key);
+
+// First node holding key (any node holding key when indexed), or NULL
+sNode *list_find_key(const LinkList *list, int key);
+
+// Unlink and recycle the node after prev
+void list_remove_after(LinkList *list, sNode *prev);
+
+// Build the key index in one pass and keep it in sync from now on.
+// Returns 0 if out of memory.
+int list_index_attach(LinkList *list);
+void list_index_detach(LinkList *list);
+
+// For bulk operations that relink nodes without the per-node hooks: reserve
+// before relinking for the longest the list will get (returns 0 if out of
+// memory, with nothing changed), rebuild after. The rebuild cannot fail,
+// so an attached index never silently goes away. Both are no-ops without
+// an index; shrinking needs no reserve.
+int list_index_reserve(LinkList *list, size_t length);
+void list_index_rebuild(LinkList *list);
+
+// Attach segment starts for the walks of list-parallel.h, kept valid by
+// every insert and remove from then on. Attaching to a non-empty list
+// takes one walk; attach before building the list to never pay for it.
+// Returns 0 if out of memory or segments < 1.
+int list_split_attach(LinkList *list, int segments);
+void list_split_detach(LinkList *list);
+
+// For bulk operations, like the index calls above: count nodes appended
+// as one contiguous run in list order, or nodes linked in anywhere with
+// none removed. No-ops without a split.
+void list_split_appended(LinkList *list, sNode *run, size_t count);
+void list_split_relinked(LinkList *list);
+
+// Print as "label: 2 -> 20 -> 100 -> NULL"
+void list_print(const LinkList *list, const char *label);
+
+#endif
@@ -0,0 +1,115 @@
+// Build: gcc -O2 list-index-bench.c link-list.c list-index.c list-split.c node-pool.c -o list-index-bench
+// Usage: ./list-index-bench [nodes]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "link-list.h"
+
+#define SCAN_DELETES 2000
+
+// Keys repeat about four times each, in random order
+void fill(LinkList *list, int n)
+{
+  srand(5);
+  for (int i = 0; i < n; i++)
+  {
+    list_append(list, rand() % (n / 4));
+  }
+}
+
+int same_contents(const LinkList *a, const LinkList *b)
+{
+  if (a->length != b->length)
+    return 0;
+  const sNode *x = list_front(a);
+  const sNode *y = list_front(b);
+  for (; x != NULL; x = x->link, y = y->link)
+  {
+    if (x->data != y->data)
+      return 0;
+  }
+  return 1;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  LinkList scanned, indexed;
+
+  printf("=== Hash-Indexed Delete by Key (%d nodes) ===\n", n);
+  list_init(&scanned);
+  list_init(&indexed);
+  fill(&scanned, n);
+  fill(&indexed, n);
+
+  double start = now_seconds();
+  list_index_attach(&indexed);
+  double build = now_seconds() - start;
+  printf("Index build: %.3fs, %zu slots, %.1f bytes per node\n", build,
+         indexed.index->mask + 1,
+         (double)(indexed.index->mask + 1) * sizeof(sNode *) / n);
+
+  int *keys = malloc(SCAN_DELETES * sizeof(int));
+  for (int i = 0; i < SCAN_DELETES; i++)
+  {
+    keys[i] = rand() % (n / 4);
+  }
+
+  // Linear scan, as in delete-link-list.c
+  start = now_seconds();
+  for (int i = 0; i < SCAN_DELETES; i++)
+    list_delete_key(&scanned, keys[i]);
+  double scan_time = now_seconds() - start;
+
+  start = now_seconds();
+  for (int i = 0; i < SCAN_DELETES; i++)
+    list_delete_key(&indexed, keys[i]);
+  double index_time = now_seconds() - start;
+
+  printf("\nDelete first match, %d keys:\n", SCAN_DELETES);
+  printf("  linear scan  %9.1f ns/delete\n", scan_time * 1e9 / SCAN_DELETES);
+  printf("  hash index   %9.1f ns/delete  (%.0fx faster)\n",
+         index_time * 1e9 / SCAN_DELETES, scan_time / index_time);
+
+  // Which duplicate goes first may differ, so compare after removing all
+  int removed_scan = 0, removed_index = 0;
+  start = now_seconds();
+  for (int i = 0; i < SCAN_DELETES; i++)
+    removed_scan += list_delete_all_keys(&scanned, keys[i]);
+  scan_time = now_seconds() - start;
+
+  start = now_seconds();
+  for (int i = 0; i < SCAN_DELETES; i++)
+    removed_index += list_delete_all_keys(&indexed, keys[i]);
+  index_time = now_seconds() - start;
+
+  printf("\nDelete all matches, %d keys:\n", SCAN_DELETES);
+  printf("  linear scan  %9.1f ns/key  (%d removed)\n",
+         scan_time * 1e9 / SCAN_DELETES, removed_scan);
+  printf("  hash index   %9.1f ns/key  (%d removed)\n",
+         index_time * 1e9 / SCAN_DELETES, removed_index);
+  printf("  contents: %s\n", same_contents(&scanned, &indexed) ? "identical" : "DIFFERENT");
+
+  // Index stays in sync through positional inserts too
+  for (int i = 0; i < 1000; i++)
+  {
+    list_insert_at(&scanned, -i, 1 + i * 7);
+    list_insert_at(&indexed, -i, 1 + i * 7);
+  }
+  int found = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    sNode *node = list_find_key(&indexed, -i);
+    found += node != NULL && node->data == -i;
+  }
+  printf("\nAfter 1000 positional inserts: %d/1000 found through the index, "
+         "contents %s\n", found,
+         same_contents(&scanned, &indexed) ? "identical" : "DIFFERENT");
+
+  free(keys);
+  list_destroy(&scanned);
+  list_destroy(&indexed);
+  return 0;
+}
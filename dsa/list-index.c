@@ -0,0 +1,206 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "link-list.h"
+#include "list-index.h"
+
+#define MIN_BITS 4
+#define MAX_LOAD_PERCENT 70
+
+// Fibonacci hashing onto the table's bits
+static size_t hash_key(const ListIndex *index, int key)
+{
+  return (size_t)(((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL) >> (64 - index->bits));
+}
+
+static int alloc_slots(ListIndex *index, int bits)
+{
+  index->slots = calloc((size_t)1 << bits, sizeof(sNode *));
+  if (index->slots == NULL)
+  {
+    return 0;
+  }
+  index->bits = bits;
+  index->mask = ((size_t)1 << bits) - 1;
+  index->count = 0;
+  return 1;
+}
+
+// Insert without checking the load factor
+static void place(ListIndex *index, sNode *pred)
+{
+  size_t i = hash_key(index, pred->link->data);
+  while (index->slots[i] != NULL)
+  {
+    i = (i + 1) & index->mask;
+  }
+  index->slots[i] = pred;
+  index->count++;
+}
+
+// Smallest table that keeps entries under the load limit
+static int bits_for(size_t entries)
+{
+  int bits = MIN_BITS;
+  while (((size_t)1 << bits) * MAX_LOAD_PERCENT / 100 < entries + 1)
+  {
+    bits++;
+  }
+  return bits;
+}
+
+int index_build(ListIndex *index, sNode *head, size_t length)
+{
+  if (!alloc_slots(index, bits_for(length)))
+  {
+    return 0;
+  }
+  for (sNode *pred = head; pred->link != NULL; pred = pred->link)
+  {
+    place(index, pred);
+  }
+  return 1;
+}
+
+void index_free(ListIndex *index)
+{
+  free(index->slots);
+  index->slots = NULL;
+  index->count = 0;
+}
+
+int index_reserve(ListIndex *index)
+{
+  if ((index->count + 1) * 100 <= (index->mask + 1) * MAX_LOAD_PERCENT)
+  {
+    return 1;
+  }
+
+  ListIndex grown;
+  if (!alloc_slots(&grown, index->bits + 1))
+  {
+    return 0;
+  }
+  for (size_t i = 0; i <= index->mask; i++)
+  {
+    if (index->slots[i] != NULL)
+    {
+      place(&grown, index->slots[i]);
+    }
+  }
+  free(index->slots);
+  *index = grown;
+  return 1;
+}
+
+int index_reserve_total(ListIndex *index, size_t entries)
+{
+  int bits = bits_for(entries);
+  if (bits <= index->bits)
+  {
+    return 1;
+  }
+
+  ListIndex grown;
+  if (!alloc_slots(&grown, bits))
+  {
+    return 0;
+  }
+  for (size_t i = 0; i <= index->mask; i++)
+  {
+    if (index->slots[i] != NULL)
+    {
+      place(&grown, index->slots[i]);
+    }
+  }
+  free(index->slots);
+  *index = grown;
+  return 1;
+}
+
+void index_refill(ListIndex *index, sNode *head)
+{
+  for (size_t i = 0; i <= index->mask; i++)
+  {
+    index->slots[i] = NULL;
+  }
+  index->count = 0;
+  for (sNode *pred = head; pred->link != NULL; pred = pred->link)
+  {
+    place(index, pred);
+  }
+}
+
+void index_add(ListIndex *index, sNode *pred)
+{
+  place(index, pred);
+}
+
+// Slot holding exactly this predecessor for key, or -1
+static long find_slot(const ListIndex *index, int key, const sNode *pred)
+{
+  size_t i = hash_key(index, key);
+  while (index->slots[i] != NULL)
+  {
+    if (index->slots[i] == pred)
+    {
+      return (long)i;
+    }
+    i = (i + 1) & index->mask;
+  }
+  return -1;
+}
+
+void index_erase(ListIndex *index, sNode *pred)
+{
+  long found = find_slot(index, pred->link->data, pred);
+  if (found < 0)
+  {
+    return;
+  }
+
+  // Backward shift: pull later entries of the cluster into the hole
+  size_t hole = (size_t)found;
+  size_t i = hole;
+  while (1)
+  {
+    i = (i + 1) & index->mask;
+    sNode *entry = index->slots[i];
+    if (entry == NULL)
+    {
+      break;
+    }
+    size_t home = hash_key(index, entry->link->data);
+    // Move it if its home is not cyclically within (hole, i]
+    if (((i - home) & index->mask) >= ((i - hole) & index->mask))
+    {
+      index->slots[hole] = entry;
+      hole = i;
+    }
+  }
+  index->slots[hole] = NULL;
+  index->count--;
+}
+
+void index_repoint(ListIndex *index, int key, sNode *old_pred, sNode *new_pred)
+{
+  long found = find_slot(index, key, old_pred);
+  if (found >= 0)
+  {
+    index->slots[found] = new_pred;
+  }
+}
+
+sNode *index_find_pred(const ListIndex *index, int key)
+{
+  size_t i = hash_key(index, key);
+  while (index->slots[i] != NULL)
+  {
+    if (index->slots[i]->link->data == key)
+    {
+      return index->slots[i];
+    }
+    i = (i + 1) & index->mask;
+  }
+  return NULL;
+}
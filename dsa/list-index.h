@@ -0,0 +1,54 @@
+#ifndef LIST_INDEX_H
+#define LIST_INDEX_H
+
+#include <stddef.h>
+
+// Open-addressing hash index over a singly linked list.
+//
+// Each slot holds only the predecessor of an indexed node (8 bytes); the
+// key is read through it as pred->link->data. Knowing the predecessor is
+// what makes an O(1) unlink possible in a singly linked list. Linear
+// probing with backward-shift deletion, so there are no tombstones.
+//
+// Invariant between operations: for every slot, slot->link is the node it
+// indexes. link-list.c calls these hooks around every relink.
+
+struct sNode;
+
+typedef struct ListIndex
+{
+  struct sNode **slots; // NULL marks an empty slot
+  size_t mask;          // capacity - 1, capacity is a power of two
+  int bits;             // log2(capacity)
+  size_t count;
+} ListIndex;
+
+// Build from scratch in one pass over the list starting after head
+int index_build(ListIndex *index, struct sNode *head, size_t length);
+void index_free(ListIndex *index);
+
+// Make room for one more entry, returns 0 if out of memory
+int index_reserve(ListIndex *index);
+
+// Make room for entries in total, so index_refill() for a list of up to
+// that many nodes needs no memory. Returns 0 if out of memory.
+int index_reserve_total(ListIndex *index, size_t entries);
+
+// Rebuild in place from the list starting after head. Never allocates;
+// the list must not be longer than reserved for.
+void index_refill(ListIndex *index, struct sNode *head);
+
+// Add the entry for pred->link (after linking it in)
+void index_add(ListIndex *index, struct sNode *pred);
+
+// Remove the entry for pred->link (before unlinking it)
+void index_erase(ListIndex *index, struct sNode *pred);
+
+// The node holding key used to follow old_pred, it now follows new_pred
+void index_repoint(ListIndex *index, int key, struct sNode *old_pred,
+                   struct sNode *new_pred);
+
+// Predecessor of some node holding key, NULL if there is none
+struct sNode *index_find_pred(const ListIndex *index, int key);
+
+#endif
@@ -0,0 +1,59 @@
+// Build: gcc -O2 list-io-bench.c list-io.c link-list.c list-index.c list-split.c node-pool.c -o list-io-bench
+// Usage: ./list-io-bench [elements] [file]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "list-io.h"
+
+// Walk the list and check it holds 0, 1, 2, ...
+int check_sequence(const LinkList *list)
+{
+  int expected = 0;
+  for (const sNode *temp = list_front(list); temp != NULL; temp = temp->link)
+  {
+    if (temp->data != expected++)
+      return 0;
+  }
+  return (size_t)expected == list->length;
+}
+
+int main(int argc, char *argv[])
+{
+  long n = argc > 1 ? atol(argv[1]) : 100000000;
+  const char *path = argc > 2 ? argv[2] : "/tmp/link-list.bin";
+  double mb = n * sizeof(int) / 1e6;
+
+  printf("=== Bulk List Load / Save (%ld elements, %.0f MB file) ===\n\n", n, mb);
+
+  // Build the source list one append at a time and save it
+  LinkList list;
+  list_init(&list);
+  double start = now_seconds();
+  for (long i = 0; i < n; i++)
+    list_append(&list, (int)i);
+  double append = now_seconds() - start;
+  printf("Append one by one   %7.3fs  %7.1f M nodes/s\n", append, n / append / 1e6);
+
+  start = now_seconds();
+  if (list_save_file(&list, path) < 0)
+    return 1;
+  double save = now_seconds() - start;
+  printf("Streaming save      %7.3fs  %7.1f MB/s\n", save, mb / save);
+  list_destroy(&list);
+
+  // Load it back in one pass (the first run also pulls the file into cache)
+  list_init(&list);
+  start = now_seconds();
+  long loaded = list_load_file(&list, path);
+  double load = now_seconds() - start;
+  printf("Bulk load           %7.3fs  %7.1f M nodes/s  %7.1f MB/s  (%.1fx append)\n",
+         load, loaded / load / 1e6, mb / load, append / load);
+  printf("Loaded %ld nodes, contents %s\n", loaded,
+         loaded == n && check_sequence(&list) ? "match" : "DIFFER");
+  list_destroy(&list);
+
+  remove(path);
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "list-io.h"
+
+#define WRITE_BUFFER_INTS (1 << 16) // 256 KB per write() call
+
+long list_load_file(LinkList *list, const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+  {
+    perror(path);
+    close(fd);
+    return -1;
+  }
+  if (st.st_size % sizeof(int) != 0)
+  {
+    fprintf(stderr, "%s: not a file of 32-bit ints\n", path);
+    close(fd);
+    return -1;
+  }
+
+  size_t count = st.st_size / sizeof(int);
+  if (count == 0)
+  {
+    close(fd);
+    return 0;
+  }
+
+  const int *values = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (values == MAP_FAILED)
+  {
+    perror(path);
+    return -1;
+  }
+  madvise((void *)values, st.st_size, MADV_SEQUENTIAL);
+
+  // Room for the new keys first, so nothing is added if the index cannot
+  // grow
+  sNode *nodes = NULL;
+  if (list_index_reserve(list, list->length + count))
+  {
+    nodes = pool_alloc_bulk(&list->pool, count);
+  }
+  if (nodes == NULL)
+  {
+    munmap((void *)values, st.st_size);
+    return -1;
+  }
+
+  // Nodes sit in file order, so the new part of the list is one
+  // sequential run of memory
+  for (size_t i = 0; i + 1 < count; i++)
+  {
+    nodes[i].data = values[i];
+    nodes[i].link = &nodes[i + 1];
+  }
+  nodes[count - 1].data = values[count - 1];
+  nodes[count - 1].link = NULL;
+  munmap((void *)values, st.st_size);
+
+  list->tail->link = nodes;
+  list->tail = &nodes[count - 1];
+  list->length += count;
+
+  // Rebuilding once is cheaper than count index_add() calls
+  list_index_rebuild(list);
+  list_split_appended(list, nodes, count);
+  return (long)count;
+}
+
+// Write the whole buffer, retrying short and interrupted writes
+static int write_all(int fd, const int *buffer, size_t count)
+{
+  const char *bytes = (const char *)buffer;
+  size_t left = count * sizeof(int);
+
+  while (left > 0)
+  {
+    ssize_t written = write(fd, bytes, left);
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (written < 0)
+    {
+      return -1;
+    }
+    bytes += written;
+    left -= written;
+  }
+  return 0;
+}
+
+int list_save_file(const LinkList *list, const char *path)
+{
+  int *buffer = malloc(WRITE_BUFFER_INTS * sizeof(int));
+  if (buffer == NULL)
+  {
+    return -1;
+  }
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    perror(path);
+    free(buffer);
+    return -1;
+  }
+
+  size_t used = 0;
+  int status = 0;
+
+  for (const sNode *temp = list_front(list); temp != NULL && status == 0; temp = temp->link)
+  {
+    buffer[used++] = temp->data;
+    if (used == WRITE_BUFFER_INTS)
+    {
+      status = write_all(fd, buffer, used);
+      used = 0;
+    }
+  }
+  if (status == 0)
+  {
+    status = write_all(fd, buffer, used);
+  }
+
+  if (status < 0)
+  {
+    perror(path);
+  }
+  if (close(fd) < 0 && status == 0)
+  {
+    perror(path);
+    status = -1;
+  }
+  free(buffer);
+  return status;
+}
@@ -0,0 +1,21 @@
+#ifndef LIST_IO_H
+#define LIST_IO_H
+
+#include "link-list.h"
+
+// Bulk load and save of a LinkList as a flat binary file of native-endian
+// 32-bit ints, front to back.
+//
+// list_load_file() maps the file and builds every node in one sequential
+// pass over a single pool allocation, so loading runs at memory bandwidth
+// instead of allocator speed. list_save_file() streams the list out through
+// a fixed-size buffer.
+
+// Append every int in the file to the list, returns the number of nodes
+// added or -1 on error (nothing is added then)
+long list_load_file(LinkList *list, const char *path);
+
+// Write the whole list, returns 0 on success and -1 on error
+int list_save_file(const LinkList *list, const char *path);
+
+#endif
@@ -0,0 +1,192 @@
+// Build: gcc -O2 list-parallel-bench.c list-parallel.c thread-pool.c link-list.c list-index.c list-split.c node-pool.c -o list-parallel-bench -pthread
+// Usage: ./list-parallel-bench [nodes] [max-threads]
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench-timer.h"
+#include "list-parallel.h"
+
+#define SEGMENTS_PER_THREAD 4
+
+int is_even(int value, void *ctx)
+{
+  (void)ctx;
+  return value % 2 == 0;
+}
+
+int add_one(int value, void *ctx)
+{
+  (void)ctx;
+  return value + 1;
+}
+
+// Serial results to check the parallel ones against
+typedef struct
+{
+  long long sum;
+  int min, max;
+  size_t even;
+} Expected;
+
+Expected serial_pass(const LinkList *list)
+{
+  Expected e = {0, INT_MAX, INT_MIN, 0};
+  for (const sNode *temp = list_front(list); temp != NULL; temp = temp->link)
+  {
+    e.sum += temp->data;
+    e.min = temp->data < e.min ? temp->data : e.min;
+    e.max = temp->data > e.max ? temp->data : e.max;
+    e.even += temp->data % 2 == 0;
+  }
+  return e;
+}
+
+// Largest segment of the list's split, in nodes
+size_t largest_segment(const LinkList *list)
+{
+  size_t largest = 0;
+  for (int s = 0; s < list->split->used; s++)
+    largest = list->split->counts[s] > largest ? list->split->counts[s] : largest;
+  return largest;
+}
+
+// Shuffled values so min/max/filter do real work
+double build(LinkList *list, long n)
+{
+  double start = now_seconds();
+  srand(3);
+  for (long i = 0; i < n; i++)
+    list_append(list, rand() % 1000000);
+  return now_seconds() - start;
+}
+
+int main(int argc, char *argv[])
+{
+  long n = argc > 1 ? atol(argv[1]) : 100000000;
+  int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int max_threads = argc > 2 ? atoi(argv[2]) : cpus;
+  int segments = max_threads * SEGMENTS_PER_THREAD;
+
+  printf("=== Parallel List Operations (%ld nodes, %d CPUs online) ===\n\n", n, cpus);
+
+  // The split is kept up by the appends; what that costs is the difference
+  // to building the same list without one
+  LinkList list;
+  list_init(&list);
+  double t_plain = build(&list, n);
+  list_destroy(&list);
+
+  list_init(&list);
+  list_split_attach(&list, segments);
+  double t_build = build(&list, n);
+  double t_upkeep = t_build > t_plain ? t_build - t_plain : 0;
+
+  list_split_detach(&list);
+  double start = now_seconds();
+  list_split_attach(&list, segments);
+  double t_attach = now_seconds() - start;
+
+  printf("Build: %.3fs plain, %.3fs with a %d-segment split attached (upkeep %.3fs)\n",
+         t_plain, t_build, list.split->used, t_upkeep);
+  printf("Attaching to the built list instead: %.3fs (one walk)\n", t_attach);
+
+  start = now_seconds();
+  long long serial_sum = 0;
+  for (const sNode *temp = list_front(&list); temp != NULL; temp = temp->link)
+    serial_sum += temp->data;
+  double t_serial_sum = now_seconds() - start;
+
+  start = now_seconds();
+  Expected e = serial_pass(&list);
+  double serial = now_seconds() - start;
+  printf("Serial walk: %.3fs sum only, %.3fs sum+min+max+count\n\n", t_serial_sum, serial);
+
+  // Speedup is against the serial sum with the whole build-time upkeep of
+  // the split charged to the parallel one
+  printf("Threads     sum     min     max  count_if  map     ok   speedup(sum, split included)\n");
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    ThreadPool pool;
+    tpool_init(&pool, threads);
+
+    long long sum = 0;
+    int min = 0, max = 0, mapped = 0;
+    size_t even = 0;
+    int ok = 1;
+
+    start = now_seconds();
+    ok &= list_par_sum(&list, &pool, &sum);
+    double t_sum = now_seconds() - start;
+
+    start = now_seconds();
+    ok &= list_par_min(&list, &pool, &min);
+    double t_min = now_seconds() - start;
+
+    start = now_seconds();
+    ok &= list_par_max(&list, &pool, &max);
+    double t_max = now_seconds() - start;
+
+    start = now_seconds();
+    ok &= list_par_count_if(&list, &pool, is_even, NULL, &even);
+    double t_count = now_seconds() - start;
+
+    // Map forward then back so every round sees the same values
+    start = now_seconds();
+    ok &= list_par_map(&list, &pool, add_one, NULL);
+    double t_map = now_seconds() - start;
+    ok &= list_par_min(&list, &pool, &mapped);
+    for (sNode *temp = list_front(&list); temp != NULL; temp = temp->link)
+      temp->data--;
+
+    ok &= sum == e.sum && serial_sum == e.sum && min == e.min && max == e.max &&
+          even == e.even && mapped == e.min + 1;
+    printf("%7d  %6.3f  %6.3f  %6.3f  %8.3f  %6.3f  %-4s %5.2fx\n", threads, t_sum, t_min,
+           t_max, t_count, t_map, ok ? "yes" : "NO", t_serial_sum / (t_sum + t_upkeep));
+
+    tpool_destroy(&pool);
+  }
+
+  ThreadPool pool;
+  tpool_init(&pool, max_threads);
+
+  // Front inserts pile into the first segment; they are counted, so the
+  // next walk evens the starts out first
+  long pushed = n / 4;
+  for (long i = 0; i < pushed; i++)
+    list_push_front(&list, 1);
+  printf("\nAfter %ld front inserts (largest segment %.0f%%), sums:", pushed,
+         100.0 * largest_segment(&list) / list.length);
+  int sums_ok = 1;
+  for (int round = 0; round < 3; round++)
+  {
+    long long sum = 0;
+    start = now_seconds();
+    list_par_sum(&list, &pool, &sum);
+    double t_sum = now_seconds() - start;
+    sums_ok &= sum == e.sum + pushed;
+    printf(" %.3fs %.0f%%", t_sum, 100.0 * largest_segment(&list) / list.length);
+  }
+  printf(", %s\n", sums_ok ? "ok" : "WRONG");
+  for (long i = 0; i < pushed; i++)
+    list_remove_after(&list, &list.head);
+
+  // Filter last, it changes the list
+  size_t removed = 0, even = 0;
+  start = now_seconds();
+  list_par_filter(&list, &pool, is_even, NULL, &removed);
+  double t_filter = now_seconds() - start;
+  Expected after = serial_pass(&list);
+  printf("Filter (keep even) on %d threads: %.3fs, removed %zu, %s\n", max_threads, t_filter,
+         removed,
+         after.even == e.even && list.length == e.even &&
+                 list_par_count_if(&list, &pool, is_even, NULL, &even) && even == e.even
+             ? "ok"
+             : "WRONG");
+  tpool_destroy(&pool);
+  list_destroy(&list);
+
+  return 0;
+}
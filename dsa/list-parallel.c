@@ -0,0 +1,326 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "list-parallel.h"
+
+// End of segment s: the next segment's start, NULL after the last one
+static inline sNode *segment_end(const ListSplit *split, int s)
+{
+  return s + 1 < split->used ? split->starts[s + 1] : NULL;
+}
+
+// ---------- Rebalancing ----------
+
+// Rank of the first node of each old segment, one cache line each
+typedef struct
+{
+  size_t first;
+} __attribute__((aligned(64))) RankResult;
+
+typedef struct
+{
+  ListSplit *split;
+  size_t length;
+  int target;          // Segments wanted
+  RankResult *ranks;
+} RebalanceJob;
+
+// Rank of the first node of new segment j
+static inline size_t new_start(const RebalanceJob *job, int j)
+{
+  return (size_t)j * job->length / job->target;
+}
+
+// Record the new starts that fall inside old segment s
+static void rebalance_task(void *arg, int s)
+{
+  RebalanceJob *job = arg;
+  ListSplit *split = job->split;
+  size_t rank = job->ranks[s].first;
+  size_t stop = rank + split->counts[s];
+  int j = 0;
+
+  while (j < job->target && new_start(job, j) < rank)
+  {
+    j++;
+  }
+  for (sNode *temp = split->starts[s]; j < job->target && new_start(job, j) < stop;
+       temp = temp->link, rank++)
+  {
+    if (new_start(job, j) == rank)
+    {
+      split->spare_starts[j++] = temp;
+    }
+  }
+}
+
+// When the last walk found the segments uneven, move the starts back to
+// even spacing: one parallel pass, each task placing the new starts that
+// fall in its own segment
+static void rebalance(const LinkList *list, ThreadPool *pool)
+{
+  ListSplit *split = list->split;
+  if (!split_skewed(split, list->length))
+  {
+    return;
+  }
+
+  size_t wanted = list->length / SPLIT_MIN_GRAIN + 1;
+  RebalanceJob job = {split, list->length,
+                      wanted < (size_t)split->segments ? (int)wanted : split->segments,
+                      split->results};
+  size_t rank = 0;
+  for (int s = 0; s < split->used; s++)
+  {
+    job.ranks[s].first = rank;
+    rank += split->counts[s];
+  }
+
+  tpool_run(pool, split->used, rebalance_task, &job);
+
+  for (int j = 0; j < job.target; j++)
+  {
+    size_t next = j + 1 < job.target ? new_start(&job, j + 1) : job.length;
+    split->spare_counts[j] = next - new_start(&job, j);
+  }
+  split_assign(split, split->spare_starts, split->spare_counts, job.target);
+}
+
+// ---------- Reductions ----------
+
+#define OP_SUM 0
+#define OP_MIN 1
+#define OP_MAX 2
+#define OP_COUNT_IF 3
+#define OP_MAP 4
+
+// Per-segment result on its own cache line so tasks don't false-share
+typedef struct
+{
+  long long value;
+  size_t count; // Nodes walked
+} __attribute__((aligned(64))) SegmentResult;
+
+typedef struct
+{
+  const ListSplit *split;
+  int op;
+  list_pred pred; // Map function for OP_MAP (same signature)
+  void *ctx;
+  SegmentResult *results;
+} ReduceJob;
+
+static void reduce_task(void *arg, int s)
+{
+  ReduceJob *job = arg;
+  sNode *temp = job->split->starts[s];
+  sNode *end = segment_end(job->split, s);
+  size_t count = 0;
+  long long acc = job->op == OP_MIN ? INT_MAX : job->op == OP_MAX ? INT_MIN : 0;
+
+  // One loop per op keeps the switch out of the pointer chase
+  switch (job->op)
+  {
+  case OP_SUM:
+    for (; temp != end; temp = temp->link, count++)
+      acc += temp->data;
+    break;
+  case OP_MIN:
+    for (; temp != end; temp = temp->link, count++)
+      acc = temp->data < acc ? temp->data : acc;
+    break;
+  case OP_MAX:
+    for (; temp != end; temp = temp->link, count++)
+      acc = temp->data > acc ? temp->data : acc;
+    break;
+  case OP_COUNT_IF:
+    for (; temp != end; temp = temp->link, count++)
+      acc += job->pred(temp->data, job->ctx) != 0;
+    break;
+  case OP_MAP:
+    for (; temp != end; temp = temp->link, count++)
+      temp->data = job->pred(temp->data, job->ctx);
+    break;
+  }
+  job->results[s].value = acc;
+  job->results[s].count = count;
+}
+
+// Run op over every segment and combine the per-segment results. The
+// split is bookkeeping rather than list contents, so the walk refreshes
+// its counts even for a const list.
+static int run_reduce(const LinkList *list, ThreadPool *pool, int op, list_pred pred,
+                      void *ctx, long long *result)
+{
+  ListSplit *split = list->split;
+  if (split == NULL)
+  {
+    return 0;
+  }
+  rebalance(list, pool);
+
+  ReduceJob job = {split, op, pred, ctx, split->results};
+  long long total = op == OP_MIN ? INT_MAX : op == OP_MAX ? INT_MIN : 0;
+
+  tpool_run(pool, split->used, reduce_task, &job);
+
+  for (int s = 0; s < split->used; s++)
+  {
+    long long v = job.results[s].value;
+    total = op == OP_MIN   ? (v < total ? v : total)
+            : op == OP_MAX ? (v > total ? v : total)
+                           : total + v;
+    split->counts[s] = job.results[s].count;
+  }
+  split->exact = 1;
+  *result = total;
+  return 1;
+}
+
+int list_par_sum(const LinkList *list, ThreadPool *pool, long long *sum)
+{
+  return run_reduce(list, pool, OP_SUM, NULL, NULL, sum);
+}
+
+int list_par_min(const LinkList *list, ThreadPool *pool, int *min)
+{
+  long long value;
+  if (!run_reduce(list, pool, OP_MIN, NULL, NULL, &value))
+    return 0;
+  *min = (int)value;
+  return 1;
+}
+
+int list_par_max(const LinkList *list, ThreadPool *pool, int *max)
+{
+  long long value;
+  if (!run_reduce(list, pool, OP_MAX, NULL, NULL, &value))
+    return 0;
+  *max = (int)value;
+  return 1;
+}
+
+int list_par_count_if(const LinkList *list, ThreadPool *pool, list_pred pred, void *ctx,
+                      size_t *count)
+{
+  long long value;
+  if (!run_reduce(list, pool, OP_COUNT_IF, pred, ctx, &value))
+    return 0;
+  *count = (size_t)value;
+  return 1;
+}
+
+int list_par_map(LinkList *list, ThreadPool *pool, list_map_fn fn, void *ctx)
+{
+  long long unused;
+  if (!run_reduce(list, pool, OP_MAP, fn, ctx, &unused))
+    return 0;
+
+  // The keys changed under the index, rebuild it in place
+  list_index_rebuild(list);
+  return 1;
+}
+
+// ---------- Filter ----------
+
+// What one segment keeps and drops. Dropped nodes are chained through their
+// first word, the format pool_free_chain() takes.
+typedef struct
+{
+  sNode *kept_first;
+  sNode *kept_last;
+  size_t kept;
+  void *dead_first;
+  void *dead_last;
+  size_t dead;
+} __attribute__((aligned(64))) FilterResult;
+
+typedef struct
+{
+  const ListSplit *split;
+  list_pred pred;
+  void *ctx;
+  FilterResult *results;
+} FilterJob;
+
+static void filter_task(void *arg, int s)
+{
+  FilterJob *job = arg;
+  FilterResult r = {NULL, NULL, 0, NULL, NULL, 0};
+  sNode *end = segment_end(job->split, s);
+
+  for (sNode *temp = job->split->starts[s]; temp != end;)
+  {
+    sNode *next = temp->link;
+    if (job->pred(temp->data, job->ctx))
+    {
+      // Links inside the segment only, the boundaries are stitched later
+      if (r.kept_last != NULL)
+        r.kept_last->link = temp;
+      else
+        r.kept_first = temp;
+      r.kept_last = temp;
+      r.kept++;
+    }
+    else
+    {
+      if (r.dead_last != NULL)
+        *(void **)r.dead_last = temp;
+      else
+        r.dead_first = temp;
+      r.dead_last = temp;
+      r.dead++;
+    }
+    temp = next;
+  }
+  job->results[s] = r;
+}
+
+int list_par_filter(LinkList *list, ThreadPool *pool, list_pred pred, void *ctx,
+                    size_t *removed)
+{
+  ListSplit *split = list->split;
+  if (split == NULL)
+  {
+    return 0;
+  }
+  rebalance(list, pool);
+
+  FilterJob job = {split, pred, ctx, split->results};
+  tpool_run(pool, split->used, filter_task, &job);
+
+  // Stitch the kept runs together and hand the dropped runs to the pool
+  sNode *prev = &list->head;
+  *removed = 0;
+
+  for (int s = 0; s < split->used; s++)
+  {
+    FilterResult *r = &job.results[s];
+    if (r->kept > 0)
+    {
+      prev->link = r->kept_first;
+      prev = r->kept_last;
+    }
+    if (r->dead > 0)
+    {
+      pool_free_chain(&list->pool, r->dead_first, r->dead_last, r->dead);
+    }
+    *removed += r->dead;
+    split->spare_starts[s] = r->kept_first;
+    split->spare_counts[s] = r->kept;
+  }
+  prev->link = NULL;
+  list->tail = prev;
+  list->length -= *removed;
+
+  // The kept runs are the new segments, the emptied ones drop out
+  split_assign(split, split->spare_starts, split->spare_counts, split->used);
+
+  // Predecessors changed all over the list, rebuild the index once (in
+  // place: the list only got shorter)
+  if (*removed > 0)
+  {
+    list_index_rebuild(list);
+  }
+  return 1;
+}
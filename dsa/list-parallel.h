@@ -0,0 +1,44 @@
+#ifndef LIST_PARALLEL_H
+#define LIST_PARALLEL_H
+
+#include <stddef.h>
+
+#include "link-list.h"
+#include "thread-pool.h"
+
+// Parallel reductions and in-place updates over a LinkList.
+//
+// Every operation runs one task per segment of the list's split (see
+// list_split_attach() and list-split.h) on a thread pool. The split is
+// kept up to date by the list's own insert and remove hooks, so there is
+// no serial walk before a parallel one. Each walk also recounts its
+// segment, and when edits have left the segments uneven the next
+// operation first moves the starts back to even spacing in one more
+// parallel pass.
+//
+// Every operation returns 1 on success and 0 when the list has no split
+// attached; nothing is computed or changed then. None of them allocate.
+
+typedef int (*list_pred)(int value, void *ctx);
+typedef int (*list_map_fn)(int value, void *ctx);
+
+int list_par_sum(const LinkList *list, ThreadPool *pool, long long *sum);
+
+// INT_MAX / INT_MIN for an empty list
+int list_par_min(const LinkList *list, ThreadPool *pool, int *min);
+int list_par_max(const LinkList *list, ThreadPool *pool, int *max);
+
+// Nodes for which pred returns non-zero
+int list_par_count_if(const LinkList *list, ThreadPool *pool, list_pred pred, void *ctx,
+                      size_t *count);
+
+// Replace every value with fn(value). An attached key index is rebuilt
+// afterwards.
+int list_par_map(LinkList *list, ThreadPool *pool, list_map_fn fn, void *ctx);
+
+// Keep only the nodes for which pred returns non-zero, in order. Removed
+// nodes go back to the list's pool; *removed is how many.
+int list_par_filter(LinkList *list, ThreadPool *pool, list_pred pred, void *ctx,
+                    size_t *removed);
+
+#endif
@@ -0,0 +1,319 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "link-list.h"
+#include "list-split.h"
+
+#define RESULT_BYTES 64 // Per segment in split->results, one cache line
+
+// Fibonacci hashing of a node address onto the lookup table
+static size_t hash_node(const ListSplit *split, const sNode *node)
+{
+  return (size_t)(((uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ULL) >> 32) &
+         split->lookup_mask;
+}
+
+static void lookup_add(ListSplit *split, int s)
+{
+  size_t i = hash_node(split, split->starts[s]);
+  while (split->lookup[i] >= 0)
+  {
+    i = (i + 1) & split->lookup_mask;
+  }
+  split->lookup[i] = s;
+}
+
+// Rebuild the lookup, O(segments). Only needed when segments shift or a
+// start other than the first moves, both rare next to inserts and removes.
+static void reindex(ListSplit *split)
+{
+  for (size_t i = 0; i <= split->lookup_mask; i++)
+  {
+    split->lookup[i] = -1;
+  }
+  for (int s = 1; s < split->used; s++)
+  {
+    lookup_add(split, s);
+  }
+}
+
+// Segment that starts at node, -1 if none does
+static int find_segment(const ListSplit *split, const sNode *node)
+{
+  if (split->used > 0 && split->starts[0] == node)
+  {
+    return 0;
+  }
+  for (size_t i = hash_node(split, node); split->lookup[i] >= 0;
+       i = (i + 1) & split->lookup_mask)
+  {
+    if (split->starts[split->lookup[i]] == node)
+    {
+      return split->lookup[i];
+    }
+  }
+  return -1;
+}
+
+int split_init(ListSplit *split, int segments)
+{
+  memset(split, 0, sizeof(ListSplit));
+  if (segments < 1)
+  {
+    return 0;
+  }
+
+  size_t lookup_size = 4;
+  while (lookup_size < 2 * (size_t)segments)
+  {
+    lookup_size *= 2;
+  }
+  split->starts = malloc(segments * sizeof(sNode *));
+  split->counts = malloc(segments * sizeof(size_t));
+  split->lookup = malloc(lookup_size * sizeof(int));
+  split->spare_starts = malloc(segments * sizeof(sNode *));
+  split->spare_counts = malloc(segments * sizeof(size_t));
+  split->results = aligned_alloc(RESULT_BYTES, segments * RESULT_BYTES);
+  if (split->starts == NULL || split->counts == NULL || split->lookup == NULL ||
+      split->spare_starts == NULL || split->spare_counts == NULL || split->results == NULL)
+  {
+    split_free(split);
+    return 0;
+  }
+
+  split->segments = segments;
+  split->lookup_mask = lookup_size - 1;
+  split->exact = 1;
+  split->grain = SPLIT_MIN_GRAIN;
+  reindex(split);
+  return 1;
+}
+
+void split_free(ListSplit *split)
+{
+  free(split->starts);
+  free(split->counts);
+  free(split->lookup);
+  free(split->spare_starts);
+  free(split->spare_counts);
+  free(split->results);
+  memset(split, 0, sizeof(ListSplit));
+}
+
+// Even share of length per segment, never below SPLIT_MIN_GRAIN
+static size_t even_grain(const ListSplit *split, size_t length)
+{
+  size_t grain = length / split->segments + (length % split->segments != 0);
+  return grain > SPLIT_MIN_GRAIN ? grain : SPLIT_MIN_GRAIN;
+}
+
+void split_build(ListSplit *split, sNode *front, size_t length)
+{
+  size_t i = 0;
+
+  split->grain = even_grain(split, length);
+  split->used = 0;
+  for (sNode *temp = front; temp != NULL; temp = temp->link, i++)
+  {
+    if (i % split->grain == 0)
+    {
+      split->starts[split->used] = temp;
+      split->counts[split->used] = 0;
+      split->used++;
+    }
+    split->counts[split->used - 1]++;
+  }
+  split->exact = 1;
+  reindex(split);
+}
+
+// Open a new last segment at node, first merging neighbours pairwise (and
+// doubling the grain) when every segment is in use
+static void open_segment(ListSplit *split, sNode *node)
+{
+  if (split->used == split->segments)
+  {
+    int merged = 0;
+    for (int s = 0; s < split->used; s += 2)
+    {
+      split->starts[merged] = split->starts[s];
+      split->counts[merged] = split->counts[s] + (s + 1 < split->used ? split->counts[s + 1] : 0);
+      merged++;
+    }
+    split->used = merged;
+    split->grain *= 2;
+    reindex(split);
+  }
+  split->starts[split->used] = node;
+  split->counts[split->used] = 0;
+  lookup_add(split, split->used);
+  split->used++;
+}
+
+// Whether the next append should open a segment rather than grow the last
+static inline int last_full(const ListSplit *split)
+{
+  return split->segments > 1 && split->counts[split->used - 1] >= split->grain;
+}
+
+void split_insert(ListSplit *split, sNode *node, int where)
+{
+  if (split->used == 0)
+  {
+    split->starts[0] = node;
+    split->counts[0] = 1;
+    split->used = 1;
+    return;
+  }
+
+  switch (where)
+  {
+  case SPLIT_FRONT:
+    split->starts[0] = node;
+    split->counts[0]++;
+    break;
+  case SPLIT_BACK:
+    if (last_full(split))
+    {
+      open_segment(split, node);
+    }
+    split->counts[split->used - 1]++;
+    break;
+  default:
+    // Some segment grew, finding out which would take a walk
+    split->exact = 0;
+    break;
+  }
+}
+
+void split_remove(ListSplit *split, sNode *node)
+{
+  sNode *next = node->link;
+  int s = find_segment(split, node);
+
+  if (s < 0)
+  {
+    if (next == NULL && split->counts[split->used - 1] > 0)
+    {
+      split->counts[split->used - 1]--;
+    }
+    else
+    {
+      split->exact = 0;
+    }
+    return;
+  }
+
+  if (next == NULL || (s + 1 < split->used && next == split->starts[s + 1]))
+  {
+    // node was all there was of segment s
+    memmove(&split->starts[s], &split->starts[s + 1], (split->used - s - 1) * sizeof(sNode *));
+    memmove(&split->counts[s], &split->counts[s + 1], (split->used - s - 1) * sizeof(size_t));
+    split->used--;
+    reindex(split);
+    return;
+  }
+
+  split->starts[s] = next;
+  if (split->counts[s] > 0)
+  {
+    split->counts[s]--;
+  }
+  if (s > 0)
+  {
+    reindex(split);
+  }
+}
+
+void split_append_run(ListSplit *split, sNode *run, size_t count)
+{
+  size_t done = 0;
+
+  if (split->used == 0 && count > 0)
+  {
+    split->starts[0] = run;
+    split->counts[0] = 0;
+    split->used = 1;
+  }
+
+  // One step per segment filled, not per node
+  while (done < count)
+  {
+    if (last_full(split))
+    {
+      open_segment(split, &run[done]);
+    }
+    size_t *last = &split->counts[split->used - 1];
+    size_t take = count - done;
+    if (split->segments > 1 && take > split->grain - *last)
+    {
+      take = split->grain - *last;
+    }
+    *last += take;
+    done += take;
+  }
+}
+
+void split_relinked(ListSplit *split, sNode *front, size_t length)
+{
+  if (front == NULL)
+  {
+    split->used = 0;
+    split->exact = 1;
+    reindex(split);
+  }
+  else if (split->used == 0)
+  {
+    split->starts[0] = front;
+    split->counts[0] = length;
+    split->used = 1;
+    split->exact = 1;
+  }
+  else
+  {
+    // Every start is still in the list and in order; anything linked in
+    // ahead of the first one joins the first segment
+    split->starts[0] = front;
+    split->exact = 0;
+  }
+}
+
+void split_assign(ListSplit *split, sNode **starts, const size_t *counts, int n)
+{
+  size_t length = 0;
+  int used = 0;
+
+  for (int s = 0; s < n; s++)
+  {
+    if (counts[s] > 0)
+    {
+      split->starts[used] = starts[s];
+      split->counts[used] = counts[s];
+      length += counts[s];
+      used++;
+    }
+  }
+  split->used = used;
+  split->exact = 1;
+  split->grain = even_grain(split, length);
+  reindex(split);
+}
+
+int split_skewed(const ListSplit *split, size_t length)
+{
+  if (!split->exact)
+  {
+    return 0;
+  }
+
+  size_t limit = 2 * even_grain(split, length);
+  for (int s = 0; s < split->used; s++)
+  {
+    if (split->counts[s] > limit)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
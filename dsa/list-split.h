@@ -0,0 +1,74 @@
+#ifndef LIST_SPLIT_H
+#define LIST_SPLIT_H
+
+#include <stddef.h>
+
+// Segment starts of a linked list, for the parallel walks of
+// list-parallel.h.
+//
+// Segment s runs from starts[s] up to starts[s + 1] (the last one to the
+// end of the list), and no segment is empty. link-list.c calls the hooks
+// below around every insert and remove, so the starts stay valid without
+// ever walking the list again. Appends open a new segment every grain
+// nodes and merge neighbours pairwise once every segment is in use, which
+// keeps a list built by appends balanced within a factor of two. Edits in
+// the middle keep the starts valid but leave the counts approximate; the
+// parallel walks count every segment as they go and even the starts out
+// again when the counts show they have drifted.
+
+struct sNode;
+
+#define SPLIT_MIN_GRAIN 256 // Fewest nodes worth a segment (and a task) of their own
+
+// Where split_insert() found the new node
+#define SPLIT_FRONT 0
+#define SPLIT_BACK 1
+#define SPLIT_MIDDLE 2
+
+typedef struct ListSplit
+{
+  int segments;          // Capacity
+  int used;              // Segments in the list, 0 when it is empty
+  struct sNode **starts; // First node of each segment, in list order
+  size_t *counts;        // Nodes in each segment
+  int exact;             // counts are exact (no edit of unknown segment since)
+  size_t grain;          // Appends open a new segment every grain nodes
+
+  // Segment of each start but the first (it moves on every front insert)
+  int *lookup;           // Open addressing, -1 marks an empty slot
+  size_t lookup_mask;
+
+  // Scratch for the parallel walks, so they never allocate
+  struct sNode **spare_starts;
+  size_t *spare_counts;
+  void *results;         // 64 bytes per segment, cache line aligned
+} ListSplit;
+
+// Returns 0 if out of memory or segments < 1
+int split_init(ListSplit *split, int segments);
+void split_free(ListSplit *split);
+
+// Start over from a list of length nodes beginning at front, in one walk
+void split_build(ListSplit *split, struct sNode *front, size_t length);
+
+// After node was linked in at where (SPLIT_FRONT, SPLIT_BACK, SPLIT_MIDDLE)
+void split_insert(ListSplit *split, struct sNode *node, int where);
+
+// Before node is unlinked (node->link still its successor)
+void split_remove(ListSplit *split, struct sNode *node);
+
+// After count nodes stored contiguously in list order were appended
+void split_append_run(ListSplit *split, struct sNode *run, size_t count);
+
+// After nodes were linked in anywhere without the hooks and none removed;
+// front and length are the list's now
+void split_relinked(ListSplit *split, struct sNode *front, size_t length);
+
+// Replace every segment; empty ones (count 0) are dropped. starts and
+// counts may be the spare arrays, n must not exceed the capacity.
+void split_assign(ListSplit *split, struct sNode **starts, const size_t *counts, int n);
+
+// Whether exact counts show a segment over twice the even share of length
+int split_skewed(const ListSplit *split, size_t length);
+
+#endif
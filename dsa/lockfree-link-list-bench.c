@@ -0,0 +1,289 @@
+// Build: gcc -O2 lockfree-link-list-bench.c lockfree-link-list.c -o lockfree-link-list-bench -pthread
+// Usage: ./lockfree-link-list-bench [max-threads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bench-timer.h"
+#include "lockfree-link-list.h"
+
+#define STRESS_THREADS 8
+#define STRESS_OPS 200000
+#define STRESS_KEYS 1024
+
+#define BENCH_KEYS 4096
+#define BENCH_SECONDS 0.5
+
+// Small per-thread generator, rand() is not thread-safe
+unsigned next_random(unsigned *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+// ---------- Stress test ----------
+
+LockFreeList stress_list;
+
+typedef struct
+{
+  int id;
+  int net[STRESS_KEYS]; // Successful inserts minus successful deletes
+} StressWorker;
+
+void *stress_worker(void *arg)
+{
+  StressWorker *w = arg;
+  unsigned state = 0x1234567u * (w->id + 1);
+
+  for (int i = 0; i < STRESS_OPS; i++)
+  {
+    unsigned r = next_random(&state);
+    int key = r % STRESS_KEYS;
+    switch ((r >> 16) % 3)
+    {
+    case 0:
+      w->net[key] += lf_insert(&stress_list, key);
+      break;
+    case 1:
+      w->net[key] -= lf_delete(&stress_list, key);
+      break;
+    default:
+      lf_contains(&stress_list, key);
+    }
+  }
+  lf_thread_exit();
+  return NULL;
+}
+
+int run_stress_test()
+{
+  pthread_t threads[STRESS_THREADS];
+  StressWorker *workers = calloc(STRESS_THREADS, sizeof(StressWorker));
+  int errors = 0;
+
+  printf("--- Stress test: %d threads x %d mixed ops on %d keys ---\n",
+         STRESS_THREADS, STRESS_OPS, STRESS_KEYS);
+
+  lf_init(&stress_list);
+  for (int t = 0; t < STRESS_THREADS; t++)
+  {
+    workers[t].id = t;
+    pthread_create(&threads[t], NULL, stress_worker, &workers[t]);
+  }
+  for (int t = 0; t < STRESS_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+  }
+
+  // Every key is present exactly when its inserts outnumber its deletes
+  int expected_size = 0;
+  for (int key = 0; key < STRESS_KEYS; key++)
+  {
+    int net = 0;
+    for (int t = 0; t < STRESS_THREADS; t++)
+      net += workers[t].net[key];
+    if (net != 0 && net != 1)
+      errors++;
+    if (net != lf_contains(&stress_list, key))
+      errors++;
+    expected_size += net;
+  }
+
+  // Strictly ascending, no leftover marked nodes after a final delete pass
+  int size = 0, last = -1;
+  for (lfNode *n = (lfNode *)atomic_load(&stress_list.head.next); n != NULL;
+       n = (lfNode *)(atomic_load(&n->next) & ~(uintptr_t)1))
+  {
+    if (n->key <= last)
+      errors++;
+    last = n->key;
+    size++;
+  }
+  if (size != expected_size)
+    errors++;
+
+  lf_destroy(&stress_list);
+  long leaked = lf_live_nodes();
+
+  printf("Final size %d (expected %d), %d errors, %ld nodes leaked -> %s\n\n",
+         size, expected_size, errors, leaked,
+         errors == 0 && leaked == 0 ? "PASS" : "FAIL");
+  free(workers);
+  return errors == 0 && leaked == 0;
+}
+
+// ---------- Throughput ----------
+
+// Baseline: the plain sorted list behind one mutex
+typedef struct sNode
+{
+  int data;
+  struct sNode *link;
+} sNode;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  sNode *front;
+} LockedList;
+
+LockedList locked_list;
+
+int locked_op(LockedList *list, int op, int key)
+{
+  pthread_mutex_lock(&list->lock);
+  sNode **link = &list->front;
+  while (*link != NULL && (*link)->data < key)
+  {
+    link = &(*link)->link;
+  }
+  int found = *link != NULL && (*link)->data == key;
+  int result = found;
+
+  if (op == 0 && !found)
+  {
+    sNode *newNode = malloc(sizeof(sNode));
+    newNode->data = key;
+    newNode->link = *link;
+    *link = newNode;
+    result = 1;
+  }
+  else if (op == 1 && found)
+  {
+    sNode *temp = *link;
+    *link = temp->link;
+    free(temp);
+  }
+  pthread_mutex_unlock(&list->lock);
+  return result;
+}
+
+LockFreeList bench_list;
+atomic_int bench_running;
+
+typedef struct
+{
+  int id;
+  int read_percent;
+  int use_lock;
+  long ops;
+} BenchWorker;
+
+void *bench_worker(void *arg)
+{
+  BenchWorker *w = arg;
+  unsigned state = 0x9E3779B9u * (w->id + 1);
+  long ops = 0;
+
+  while (atomic_load_explicit(&bench_running, memory_order_relaxed))
+  {
+    unsigned r = next_random(&state);
+    int key = r % BENCH_KEYS;
+    // Writes are half inserts, half deletes, keeping the size steady
+    int op = (int)((r >> 12) % 100) < w->read_percent ? 2 : (int)((r >> 24) & 1);
+
+    if (w->use_lock)
+      locked_op(&locked_list, op, key);
+    else if (op == 0)
+      lf_insert(&bench_list, key);
+    else if (op == 1)
+      lf_delete(&bench_list, key);
+    else
+      lf_contains(&bench_list, key);
+    ops++;
+  }
+  w->ops = ops;
+  lf_thread_exit();
+  return NULL;
+}
+
+double run_throughput(int threads, int read_percent, int use_lock)
+{
+  pthread_t ids[LF_MAX_THREADS];
+  BenchWorker workers[LF_MAX_THREADS];
+
+  lf_init(&bench_list);
+  pthread_mutex_init(&locked_list.lock, NULL);
+  locked_list.front = NULL;
+  for (int key = 0; key < BENCH_KEYS; key += 2)
+  {
+    if (use_lock)
+      locked_op(&locked_list, 0, key);
+    else
+      lf_insert(&bench_list, key);
+  }
+
+  atomic_store(&bench_running, 1);
+  for (int t = 0; t < threads; t++)
+  {
+    workers[t].id = t;
+    workers[t].read_percent = read_percent;
+    workers[t].use_lock = use_lock;
+    pthread_create(&ids[t], NULL, bench_worker, &workers[t]);
+  }
+
+  double start = now_seconds();
+  while (now_seconds() - start < BENCH_SECONDS)
+  {
+    struct timespec pause = {0, 10000000};
+    nanosleep(&pause, NULL);
+  }
+  atomic_store(&bench_running, 0);
+
+  long total = 0;
+  for (int t = 0; t < threads; t++)
+  {
+    pthread_join(ids[t], NULL);
+    total += workers[t].ops;
+  }
+  double elapsed = now_seconds() - start;
+
+  lf_destroy(&bench_list);
+  while (locked_list.front != NULL)
+  {
+    sNode *next = locked_list.front->link;
+    free(locked_list.front);
+    locked_list.front = next;
+  }
+  pthread_mutex_destroy(&locked_list.lock);
+
+  return total / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  int read_mix[] = {100, 90, 50, 0};
+
+  if (max_threads > LF_MAX_THREADS)
+    max_threads = LF_MAX_THREADS;
+
+  printf("=== Lock-Free Sorted Linked List ===\n\n");
+  int passed = run_stress_test();
+
+  printf("--- Throughput (Mops/s), %d keys, half present ---\n", BENCH_KEYS);
+  printf("%-8s %-10s", "threads", "list");
+  for (int r = 0; r < 4; r++)
+    printf("  %3d%% read", read_mix[r]);
+  printf("\n");
+
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    for (int use_lock = 0; use_lock <= 1; use_lock++)
+    {
+      printf("%-8d %-10s", threads, use_lock ? "mutex" : "lock-free");
+      for (int r = 0; r < 4; r++)
+        printf("  %9.2f", run_throughput(threads, read_mix[r], use_lock));
+      printf("\n");
+    }
+  }
+
+  return passed ? 0 : 1;
+}
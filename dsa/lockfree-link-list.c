@@ -0,0 +1,349 @@
+#include <stdlib.h>
+#include <limits.h>
+
+#include "lockfree-link-list.h"
+
+#define MARK 1u
+#define RETIRE_THRESHOLD 64 // Try to advance the epoch every this many retires
+
+#define is_marked(p) ((p)&MARK)
+#define unmarked(p) ((lfNode *)((p) & ~(uintptr_t)MARK))
+
+// Retired node waiting for its grace period
+typedef struct Retired
+{
+  lfNode *node;
+  struct Retired *next;
+} Retired;
+
+// Per-thread epoch record
+typedef struct
+{
+  atomic_int in_use;          // Record owned by a live thread
+  atomic_ulong local_epoch;   // Epoch seen on entry, valid while active
+  atomic_int active;          // Inside a list operation
+  unsigned long seen_epoch;   // Last epoch whose limbo bucket was emptied
+  Retired *limbo[3];          // Retired nodes, by epoch % 3
+  int retired_since_advance;
+} EpochRecord;
+
+static atomic_ulong global_epoch = 0;
+static EpochRecord records[LF_MAX_THREADS];
+static _Thread_local EpochRecord *self = NULL;
+
+// Limbo lists left by threads that exited, freed by lf_destroy()
+static _Atomic(Retired *) orphans = NULL;
+
+static atomic_long live_nodes = 0;
+
+static lfNode *new_node(int key)
+{
+  lfNode *node = malloc(sizeof(lfNode));
+  if (node != NULL)
+  {
+    node->key = key;
+    atomic_init(&node->next, 0);
+    atomic_fetch_add_explicit(&live_nodes, 1, memory_order_relaxed);
+  }
+  return node;
+}
+
+static void free_node(lfNode *node)
+{
+  free(node);
+  atomic_fetch_sub_explicit(&live_nodes, 1, memory_order_relaxed);
+}
+
+static void free_retired(Retired *r)
+{
+  while (r != NULL)
+  {
+    Retired *next = r->next;
+    free_node(r->node);
+    free(r);
+    r = next;
+  }
+}
+
+static EpochRecord *thread_record()
+{
+  if (self != NULL)
+  {
+    return self;
+  }
+  for (int i = 0; i < LF_MAX_THREADS; i++)
+  {
+    int expected = 0;
+    if (atomic_compare_exchange_strong(&records[i].in_use, &expected, 1))
+    {
+      self = &records[i];
+      self->seen_epoch = atomic_load(&global_epoch);
+      for (int b = 0; b < 3; b++)
+        self->limbo[b] = NULL;
+      self->retired_since_advance = 0;
+      return self;
+    }
+  }
+  abort(); // More than LF_MAX_THREADS threads at once
+}
+
+// Advance the epoch if every active thread has caught up with it
+static void try_advance()
+{
+  unsigned long epoch = atomic_load(&global_epoch);
+
+  for (int i = 0; i < LF_MAX_THREADS; i++)
+  {
+    if (atomic_load(&records[i].in_use) && atomic_load(&records[i].active) &&
+        atomic_load(&records[i].local_epoch) != epoch)
+    {
+      return;
+    }
+  }
+  atomic_compare_exchange_strong(&global_epoch, &epoch, epoch + 1);
+}
+
+static void enter(EpochRecord *rec)
+{
+  unsigned long epoch = atomic_load(&global_epoch);
+  atomic_store(&rec->local_epoch, epoch);
+  atomic_store(&rec->active, 1);
+
+  // Re-read: if the epoch moved while announcing, announce the newer one
+  unsigned long again = atomic_load(&global_epoch);
+  if (again != epoch)
+  {
+    atomic_store(&rec->local_epoch, again);
+    epoch = again;
+  }
+
+  // Nodes retired two or more epochs ago can no longer be referenced
+  if (epoch != rec->seen_epoch)
+  {
+    unsigned long steps = epoch - rec->seen_epoch;
+    for (unsigned long s = 1; s <= steps && s <= 3; s++)
+    {
+      int bucket = (rec->seen_epoch + s) % 3;
+      free_retired(rec->limbo[bucket]);
+      rec->limbo[bucket] = NULL;
+    }
+    rec->seen_epoch = epoch;
+  }
+}
+
+static void leave(EpochRecord *rec)
+{
+  atomic_store_explicit(&rec->active, 0, memory_order_release);
+}
+
+static void retire(EpochRecord *rec, lfNode *node)
+{
+  Retired *r = malloc(sizeof(Retired));
+  if (r == NULL)
+  {
+    return; // Leak rather than free too early
+  }
+
+  // Bucket of the current epoch is emptied when this thread sees epoch + 3
+  int bucket = rec->seen_epoch % 3;
+  r->node = node;
+  r->next = rec->limbo[bucket];
+  rec->limbo[bucket] = r;
+
+  if (++rec->retired_since_advance >= RETIRE_THRESHOLD)
+  {
+    rec->retired_since_advance = 0;
+    try_advance();
+  }
+}
+
+void lf_init(LockFreeList *list)
+{
+  list->head.key = INT_MIN;
+  atomic_init(&list->head.next, 0);
+}
+
+// Find prev/curr with prev->key < key <= curr->key, unlinking marked nodes
+static void search(EpochRecord *rec, LockFreeList *list, int key,
+                   lfNode **prev_out, lfNode **curr_out)
+{
+retry:;
+  lfNode *prev = &list->head;
+  lfNode *curr = unmarked(atomic_load(&prev->next));
+
+  while (curr != NULL)
+  {
+    uintptr_t next = atomic_load(&curr->next);
+
+    if (is_marked(next))
+    {
+      // Help finish a delete: swing prev past the marked node
+      uintptr_t expected = (uintptr_t)curr;
+      if (!atomic_compare_exchange_strong(&prev->next, &expected,
+                                          (uintptr_t)unmarked(next)))
+      {
+        goto retry;
+      }
+      retire(rec, curr);
+      curr = unmarked(next);
+      continue;
+    }
+
+    if (curr->key >= key)
+    {
+      break;
+    }
+    prev = curr;
+    curr = unmarked(next);
+  }
+
+  *prev_out = prev;
+  *curr_out = curr;
+}
+
+int lf_insert(LockFreeList *list, int key)
+{
+  EpochRecord *rec = thread_record();
+  lfNode *node = new_node(key);
+  lfNode *prev, *curr;
+  int inserted = 0;
+
+  if (node == NULL)
+  {
+    return 0;
+  }
+
+  enter(rec);
+  while (1)
+  {
+    search(rec, list, key, &prev, &curr);
+    if (curr != NULL && curr->key == key)
+    {
+      break;
+    }
+
+    atomic_store_explicit(&node->next, (uintptr_t)curr, memory_order_relaxed);
+    uintptr_t expected = (uintptr_t)curr;
+    if (atomic_compare_exchange_strong(&prev->next, &expected, (uintptr_t)node))
+    {
+      inserted = 1;
+      break;
+    }
+  }
+  leave(rec);
+
+  if (!inserted)
+  {
+    free_node(node); // Never published
+  }
+  return inserted;
+}
+
+int lf_delete(LockFreeList *list, int key)
+{
+  EpochRecord *rec = thread_record();
+  lfNode *prev, *curr;
+  int deleted = 0;
+
+  enter(rec);
+  while (1)
+  {
+    search(rec, list, key, &prev, &curr);
+    if (curr == NULL || curr->key != key)
+    {
+      break;
+    }
+
+    // Logical delete: mark curr's next pointer
+    uintptr_t next = atomic_load(&curr->next);
+    if (is_marked(next))
+    {
+      continue; // Another thread is deleting it, search again
+    }
+    if (!atomic_compare_exchange_strong(&curr->next, &next, next | MARK))
+    {
+      continue;
+    }
+    deleted = 1;
+
+    // Physical delete, or leave it to the next search that passes by
+    uintptr_t expected = (uintptr_t)curr;
+    if (atomic_compare_exchange_strong(&prev->next, &expected, next))
+    {
+      retire(rec, curr);
+    }
+    else
+    {
+      search(rec, list, key, &prev, &curr);
+    }
+    break;
+  }
+  leave(rec);
+  return deleted;
+}
+
+int lf_contains(LockFreeList *list, int key)
+{
+  EpochRecord *rec = thread_record();
+
+  // Read-only walk: never writes, skips over marked nodes
+  enter(rec);
+  lfNode *curr = unmarked(atomic_load(&list->head.next));
+  while (curr != NULL && curr->key < key)
+  {
+    curr = unmarked(atomic_load(&curr->next));
+  }
+  int found = curr != NULL && curr->key == key && !is_marked(atomic_load(&curr->next));
+  leave(rec);
+  return found;
+}
+
+void lf_thread_exit(void)
+{
+  if (self == NULL)
+  {
+    return;
+  }
+
+  // Park whatever is still waiting on a grace period for lf_destroy()
+  for (int b = 0; b < 3; b++)
+  {
+    Retired *r = self->limbo[b];
+    while (r != NULL)
+    {
+      Retired *next = r->next;
+      r->next = atomic_load(&orphans);
+      while (!atomic_compare_exchange_weak(&orphans, &r->next, r))
+      {
+      }
+      r = next;
+    }
+    self->limbo[b] = NULL;
+  }
+
+  atomic_store(&self->active, 0);
+  atomic_store(&self->in_use, 0);
+  self = NULL;
+}
+
+void lf_destroy(LockFreeList *list)
+{
+  // Nodes still linked (marked or not)
+  lfNode *curr = unmarked(atomic_load(&list->head.next));
+  while (curr != NULL)
+  {
+    lfNode *next = unmarked(atomic_load(&curr->next));
+    free_node(curr);
+    curr = next;
+  }
+  atomic_store(&list->head.next, 0);
+
+  // Retired nodes of this thread and of threads that already exited
+  lf_thread_exit();
+  free_retired(atomic_exchange(&orphans, NULL));
+}
+
+long lf_live_nodes(void)
+{
+  return atomic_load(&live_nodes);
+}
@@ -0,0 +1,49 @@
+#ifndef LOCKFREE_LINK_LIST_H
+#define LOCKFREE_LINK_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Concurrent sorted set of ints (Harris-Michael lock-free list).
+//
+// A node is deleted in two steps: first its next pointer is marked (low bit
+// set), then it is unlinked with a CAS on the predecessor. Traversals help
+// unlink marked nodes they pass. Unlinked nodes are not freed immediately
+// but retired to epoch-based reclamation: a node is freed only after every
+// thread that could still hold a pointer to it has left its critical
+// section, so readers never touch freed memory.
+//
+// Any number of threads may call insert/delete/contains at once. Each
+// thread should call lf_thread_exit() before it terminates.
+
+#define LF_MAX_THREADS 128
+
+typedef struct lfNode
+{
+  int key;
+  _Atomic(uintptr_t) next; // Successor, low bit set when this node is deleted
+} lfNode;
+
+typedef struct
+{
+  lfNode head; // Sentinel before every key
+} LockFreeList;
+
+void lf_init(LockFreeList *list);
+
+// Free every node, only when no other thread uses the list any more
+void lf_destroy(LockFreeList *list);
+
+// Return 1 if the key was added / removed / found
+int lf_insert(LockFreeList *list, int key);
+int lf_delete(LockFreeList *list, int key);
+int lf_contains(LockFreeList *list, int key);
+
+// Hand this thread's pending frees over before the thread ends
+void lf_thread_exit(void);
+
+// Nodes allocated and not yet freed (for leak checks)
+long lf_live_nodes(void);
+
+#endif
@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "node-pool.h"
+
+#define ROUND_UP(n, align) (((n) + (align)-1) & ~((align)-1))
+
+// Every pool between pool_init() and pool_destroy()
+static NodePool *registry = NULL;
+
+static double monotonic_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Forget every chunk, keeping the object layout and the counters
+static void reset_chunks(NodePool *pool)
+{
+  pool->next_chunk = POOL_FIRST_CHUNK;
+  pool->chunks = NULL;
+  pool->bump = NULL;
+  pool->bump_end = NULL;
+  pool->free_list = NULL;
+  pool->live = 0;
+  pool->reserved = 0;
+}
+
+void pool_init(NodePool *pool, size_t object_size)
+{
+  pool_init_aligned(pool, object_size, sizeof(void *));
+}
+
+void pool_init_aligned(NodePool *pool, size_t object_size, size_t align)
+{
+  if (align < sizeof(void *))
+  {
+    align = sizeof(void *);
+  }
+
+  // Freed objects store the free-list link in place, so they need room for it
+  if (object_size < sizeof(void *))
+  {
+    object_size = sizeof(void *);
+  }
+  pool->object_size = ROUND_UP(object_size, align);
+  pool->align = align;
+  pool->header_size = ROUND_UP(sizeof(PoolChunk), align);
+  reset_chunks(pool);
+  pool->peak = 0;
+  pool->allocs = 0;
+  pool->frees = 0;
+  pool->created = monotonic_seconds();
+
+  pool->prev_pool = NULL;
+  pool->next_pool = registry;
+  if (registry != NULL)
+  {
+    registry->prev_pool = pool;
+  }
+  registry = pool;
+}
+
+// Allocate a chunk for objects objects, returns its first object
+static char *pool_add_chunk(NodePool *pool, size_t objects)
+{
+  size_t bytes = pool->header_size + objects * pool->object_size;
+  PoolChunk *chunk = pool->align > _Alignof(max_align_t)
+                         ? aligned_alloc(pool->align, ROUND_UP(bytes, pool->align))
+                         : malloc(bytes);
+
+  if (chunk == NULL)
+  {
+    return NULL;
+  }
+
+  chunk->objects = objects;
+  chunk->next = pool->chunks;
+  pool->chunks = chunk;
+  pool->reserved += bytes;
+  return (char *)chunk + pool->header_size;
+}
+
+// Allocate a new chunk and make it the bump region
+static int pool_grow(NodePool *pool)
+{
+  size_t objects = pool->next_chunk;
+  char *first = pool_add_chunk(pool, objects);
+
+  if (first == NULL)
+  {
+    return 0;
+  }
+  pool->bump = first;
+  pool->bump_end = first + objects * pool->object_size;
+
+  if (pool->next_chunk < POOL_MAX_CHUNK)
+  {
+    pool->next_chunk *= 2;
+  }
+  return 1;
+}
+
+// Count n objects handed out
+static inline void count_allocs(NodePool *pool, size_t n)
+{
+  pool->live += n;
+  pool->allocs += n;
+  if (pool->live > pool->peak)
+  {
+    pool->peak = pool->live;
+  }
+}
+
+// Put a chain on the free list without touching the counters
+static void splice_free(NodePool *pool, void *first, void *last)
+{
+  *(void **)last = pool->free_list;
+  pool->free_list = first;
+}
+
+void *pool_alloc(NodePool *pool)
+{
+  // Reuse a freed object first
+  if (pool->free_list != NULL)
+  {
+    void *object = pool->free_list;
+    pool->free_list = *(void **)object;
+    count_allocs(pool, 1);
+    return object;
+  }
+
+  if (pool->bump == pool->bump_end && !pool_grow(pool))
+  {
+    return NULL;
+  }
+
+  void *object = pool->bump;
+  pool->bump += pool->object_size;
+  count_allocs(pool, 1);
+  return object;
+}
+
+void pool_free(NodePool *pool, void *object)
+{
+  splice_free(pool, object, object);
+  pool->live--;
+  pool->frees++;
+}
+
+void pool_free_chain(NodePool *pool, void *first, void *last, size_t count)
+{
+  splice_free(pool, first, last);
+  pool->live -= count;
+  pool->frees += count;
+}
+
+void *pool_alloc_bulk(NodePool *pool, size_t count)
+{
+  if (count == 0 || count > ((size_t)-1 - pool->header_size) / pool->object_size)
+  {
+    return NULL;
+  }
+
+  // Small requests fit in the bump region without a chunk of their own
+  void *first;
+  if ((size_t)(pool->bump_end - pool->bump) >= count * pool->object_size)
+  {
+    first = pool->bump;
+    pool->bump += count * pool->object_size;
+  }
+  else if ((first = pool_add_chunk(pool, count)) == NULL)
+  {
+    return NULL;
+  }
+  count_allocs(pool, count);
+  return first;
+}
+
+void pool_absorb(NodePool *pool, NodePool *other)
+{
+  if (other->chunks != NULL)
+  {
+    PoolChunk *last = other->chunks;
+    while (last->next != NULL)
+    {
+      last = last->next;
+    }
+    last->next = pool->chunks;
+    pool->chunks = other->chunks;
+  }
+
+  if (other->free_list != NULL)
+  {
+    void *last = other->free_list;
+    while (*(void **)last != NULL)
+    {
+      last = *(void **)last;
+    }
+    splice_free(pool, other->free_list, last);
+  }
+
+  // The objects and their history move over with the chunks
+  pool->live += other->live;
+  pool->reserved += other->reserved;
+  pool->allocs += other->allocs;
+  pool->frees += other->frees;
+  if (pool->live > pool->peak)
+  {
+    pool->peak = pool->live;
+  }
+  other->allocs = 0;
+  other->frees = 0;
+
+  // The rest of other's bump region stays unused until pool_free_all()
+  reset_chunks(other);
+}
+
+void pool_free_all(NodePool *pool)
+{
+  PoolChunk *chunk = pool->chunks;
+
+  while (chunk != NULL)
+  {
+    PoolChunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  pool->frees += pool->live;
+  reset_chunks(pool);
+}
+
+void pool_destroy(NodePool *pool)
+{
+  pool_free_all(pool);
+
+  if (pool->prev_pool != NULL)
+    pool->prev_pool->next_pool = pool->next_pool;
+  else if (registry == pool)
+    registry = pool->next_pool;
+  if (pool->next_pool != NULL)
+    pool->next_pool->prev_pool = pool->prev_pool;
+  pool->prev_pool = NULL;
+  pool->next_pool = NULL;
+}
+
+size_t pool_destroy_all()
+{
+  size_t destroyed = 0;
+
+  while (registry != NULL)
+  {
+    pool_destroy(registry);
+    destroyed++;
+  }
+  return destroyed;
+}
+
+// Add one pool's counters to stats
+static void add_stats(const NodePool *pool, PoolStats *stats, double now)
+{
+  double seconds = now - pool->created;
+
+  stats->pools++;
+  stats->live_objects += pool->live;
+  stats->peak_objects += pool->peak;
+  stats->live_bytes += pool->live * pool->object_size;
+  stats->peak_bytes += pool->peak * pool->object_size;
+  stats->reserved_bytes += pool->reserved;
+  stats->allocs += pool->allocs;
+  stats->frees += pool->frees;
+  stats->alloc_rate += seconds > 0 ? pool->allocs / seconds : 0;
+}
+
+void pool_stats(const NodePool *pool, PoolStats *stats)
+{
+  *stats = (PoolStats){0};
+  add_stats(pool, stats, monotonic_seconds());
+}
+
+void pool_total_stats(PoolStats *stats)
+{
+  double now = monotonic_seconds();
+
+  *stats = (PoolStats){0};
+  for (const NodePool *pool = registry; pool != NULL; pool = pool->next_pool)
+  {
+    add_stats(pool, stats, now);
+  }
+}
+
+// Bytes with a binary unit, e.g. "16 KB"
+static void format_bytes(char *out, size_t size, size_t bytes)
+{
+  const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+  double value = bytes;
+  int u = 0;
+
+  while (value >= 1024 && u < 4)
+  {
+    value /= 1024;
+    u++;
+  }
+  snprintf(out, size, u == 0 ? "%.0f %s" : "%.1f %s", value, units[u]);
+}
+
+void pool_print_stats(const PoolStats *stats, const char *label)
+{
+  char live[32], peak[32], reserved[32];
+
+  format_bytes(live, sizeof(live), stats->live_bytes);
+  format_bytes(peak, sizeof(peak), stats->peak_bytes);
+  format_bytes(reserved, sizeof(reserved), stats->reserved_bytes);
+  printf("%s: %zu nodes live (%s), peak %zu (%s), %s reserved, "
+         "%llu allocs / %llu frees, %.1f M allocs/s\n",
+         label, stats->live_objects, live, stats->peak_objects, peak, reserved,
+         stats->allocs, stats->frees, stats->alloc_rate / 1e6);
+}
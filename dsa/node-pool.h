@@ -0,0 +1,109 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <stddef.h>
+
+// Fixed-size object pool for list nodes.
+//
+// Objects are carved out of large contiguous chunks, freed objects go on an
+// intrusive free list for O(1) reuse, and the whole pool is released in one
+// pass over its chunks instead of one free() per node.
+//
+// Every pool counts what it hands out (live and peak objects and bytes,
+// allocations per second) and sits in a process-wide registry between
+// pool_init() and pool_destroy(), so memory can be totalled across all
+// lists and anything still live at exit shows up as a leak. The registry
+// is not locked: create and destroy pools from one thread.
+
+#define POOL_FIRST_CHUNK 1024     // Objects in the first chunk
+#define POOL_MAX_CHUNK (1 << 20) // Chunks double in size up to this many objects
+
+typedef struct PoolChunk
+{
+  struct PoolChunk *next;
+  size_t objects;
+} PoolChunk;
+
+typedef struct NodePool
+{
+  size_t object_size;  // Rounded up to a multiple of align
+  size_t align;        // Object alignment
+  size_t header_size;  // Chunk header, padded to keep objects aligned
+  size_t next_chunk;   // Objects in the next chunk to allocate
+  PoolChunk *chunks;   // Every chunk, newest first
+  char *bump;          // Unused tail of the newest chunk
+  char *bump_end;
+  void *free_list;     // Objects returned with pool_free()
+
+  // Accounting
+  size_t live;                 // Objects handed out and not yet returned
+  size_t peak;                 // Highest value of live
+  size_t reserved;             // Bytes held in chunks, headers included
+  unsigned long long allocs;   // Objects handed out since pool_init()
+  unsigned long long frees;    // Objects returned since pool_init()
+  double created;              // Monotonic time of pool_init(), in seconds
+
+  // Registry links
+  struct NodePool *prev_pool;
+  struct NodePool *next_pool;
+} NodePool;
+
+typedef struct
+{
+  size_t pools;             // Pools counted
+  size_t live_objects;
+  size_t peak_objects;
+  size_t live_bytes;        // live_objects * object size
+  size_t peak_bytes;
+  size_t reserved_bytes;    // Memory actually held, including free space
+  unsigned long long allocs;
+  unsigned long long frees;
+  double alloc_rate;        // Allocations per second since pool_init()
+} PoolStats;
+
+void pool_init(NodePool *pool, size_t object_size);
+
+// Same, with objects aligned to align bytes (a power of two, e.g. 64 to put
+// each object on its own cache line)
+void pool_init_aligned(NodePool *pool, size_t object_size, size_t align);
+
+// Returns NULL only when the system is out of memory
+void *pool_alloc(NodePool *pool);
+void pool_free(NodePool *pool, void *object);
+
+// Return a chain of count objects in O(1). The chain is already linked the
+// way the free list is: each object's first pointer-sized word points to
+// the next one. The link in last is overwritten.
+void pool_free_chain(NodePool *pool, void *first, void *last, size_t count);
+
+// Allocate count contiguous objects, for bulk builds. They come from the
+// current chunk's unused space when it has room and from a new chunk of
+// their own otherwise. Each object can later be returned with pool_free()
+// like any other. Returns NULL only when the system is out of memory.
+void *pool_alloc_bulk(NodePool *pool, size_t count);
+
+// Move every chunk and free object of other into pool, leaving other empty.
+// Both pools must have the same object size and alignment. Objects already
+// handed out from other now belong to pool.
+void pool_absorb(NodePool *pool, NodePool *other);
+
+// Release every object and chunk at once, the pool stays usable
+void pool_free_all(NodePool *pool);
+
+// Release everything and take the pool out of the registry
+void pool_destroy(NodePool *pool);
+
+// Destroy every registered pool (exit paths, cleanup after a leak report).
+// Whatever used those pools must be re-initialized before it is touched.
+// Returns the number of pools destroyed.
+size_t pool_destroy_all();
+
+// Counters for one pool, or summed over every registered pool (peaks are
+// then the sum of per-pool peaks, an upper bound on the true peak)
+void pool_stats(const NodePool *pool, PoolStats *stats);
+void pool_total_stats(PoolStats *stats);
+
+// Print as "label: 3 nodes live (48 B), peak 3 (48 B), 16 KB reserved, ..."
+void pool_print_stats(const PoolStats *stats, const char *label);
+
+#endif
@@ -0,0 +1,130 @@
+// Build: gcc -O2 skip-list-bench.c skip-list.c link-list.c list-index.c list-split.c node-pool.c -o skip-list-bench
+// Usage: ./skip-list-bench [elements]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "link-list.h"
+#include "skip-list.h"
+
+#define CHECK_SIZE 20000   // Cross-check against the plain list at this size
+#define PLAIN_SIZES 3
+
+// n inserts, each at a random position of the list built so far
+double plain_random_inserts(LinkList *list, int n)
+{
+  double start = now_seconds();
+  for (int i = 0; i < n; i++)
+  {
+    list_insert_at(list, i, 1 + rand() % (i + 1));
+  }
+  return now_seconds() - start;
+}
+
+double skip_random_inserts(SkipList *list, int n)
+{
+  double start = now_seconds();
+  for (int i = 0; i < n; i++)
+  {
+    skip_insert_at(list, i, 1 + rand() % (i + 1));
+  }
+  return now_seconds() - start;
+}
+
+// Same random sequence into both lists must give the same order
+int cross_check()
+{
+  LinkList list;
+  SkipList skip;
+  list_init(&list);
+  skip_init(&skip);
+
+  srand(3);
+  plain_random_inserts(&list, CHECK_SIZE);
+  srand(3);
+  skip_random_inserts(&skip, CHECK_SIZE);
+
+  // Then delete a few thousand by position and by key
+  for (int i = 0; i < CHECK_SIZE / 4; i++)
+  {
+    int key = rand() % CHECK_SIZE;
+    list_delete_key(&list, key);
+    skip_delete_key(&skip, key);
+  }
+
+  int same = list.length == skip.length;
+  size_t position = 1;
+  for (sNode *temp = list_front(&list); same && temp != NULL; temp = temp->link)
+  {
+    same = skip_get(&skip, position++)->data == temp->data;
+  }
+
+  list_destroy(&list);
+  skip_destroy(&skip);
+  return same;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 2000000;
+  int plain_sizes[PLAIN_SIZES] = {10000, 25000, 50000};
+
+  printf("=== Random-Position Inserts: Plain List vs Indexable Skip List ===\n");
+  printf("Cross-check on %d elements: %s\n\n", CHECK_SIZE,
+         cross_check() ? "same order as the plain list" : "ORDER DIFFERS");
+
+  // The plain list is O(n^2) overall, so only small sizes are practical
+  for (int i = 0; i < PLAIN_SIZES; i++)
+  {
+    LinkList list;
+    list_init(&list);
+    srand(1);
+    double t = plain_random_inserts(&list, plain_sizes[i]);
+    printf("plain list  %8d inserts  %8.3fs  (%8.1f ns/insert)\n",
+           plain_sizes[i], t, t * 1e9 / plain_sizes[i]);
+    list_destroy(&list);
+  }
+
+  for (int size = n / 4; size <= n; size *= 2)
+  {
+    SkipList skip;
+    skip_init(&skip);
+    srand(1);
+    double t = skip_random_inserts(&skip, size);
+
+    // Random lookups and deletes by position on the finished list
+    double start = now_seconds();
+    long long sum = 0;
+    for (int i = 0; i < size / 2; i++)
+    {
+      sum += skip_get(&skip, 1 + rand() % skip.length)->data;
+    }
+    double lookup = now_seconds() - start;
+
+    // A quarter by position, then a quarter by key (keys are 0..size-1,
+    // so about two thirds of the random ones are still there)
+    start = now_seconds();
+    for (int i = 0; i < size / 4; i++)
+    {
+      skip_delete_at(&skip, 1 + rand() % skip.length);
+    }
+    double deletes = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < size / 4; i++)
+    {
+      skip_delete_key(&skip, rand() % size);
+    }
+    double key_deletes = now_seconds() - start;
+
+    printf("skip list   %8d inserts  %8.3fs  (%8.1f ns/insert, %6.1f ns/get, "
+           "%6.1f ns/delete, %6.1f ns/delete by key)\n",
+           size, t, t * 1e9 / size, lookup * 1e9 / (size / 2),
+           deletes * 1e9 / (size / 4), key_deletes * 1e9 / (size / 4));
+    skip_destroy(&skip);
+    (void)sum;
+  }
+
+  return 0;
+}
@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "skip-list.h"
+
+#define KEY_MIN_BITS 4
+#define KEY_MAX_LOAD_PERCENT 70
+
+static size_t node_size(int height)
+{
+  return sizeof(SkipNode) + height * sizeof(SkipLevel);
+}
+
+// ---------- Key hash ----------
+
+// Fibonacci hashing onto the table's bits
+static size_t hash_key(const SkipList *list, int key)
+{
+  return (size_t)(((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL) >> (64 - list->key_bits));
+}
+
+// Insert without checking the load factor
+static void key_place(SkipList *list, SkipNode *node)
+{
+  size_t i = hash_key(list, node->data);
+  while (list->keys[i] != NULL)
+  {
+    i = (i + 1) & list->key_mask;
+  }
+  list->keys[i] = node;
+  list->key_count++;
+}
+
+static int key_alloc(SkipList *list, int bits)
+{
+  SkipNode **keys = calloc((size_t)1 << bits, sizeof(SkipNode *));
+  if (keys == NULL)
+  {
+    return 0;
+  }
+  SkipNode **old = list->keys;
+  size_t old_size = old != NULL ? list->key_mask + 1 : 0;
+
+  list->keys = keys;
+  list->key_bits = bits;
+  list->key_mask = ((size_t)1 << bits) - 1;
+  list->key_count = 0;
+  for (size_t i = 0; i < old_size; i++)
+  {
+    if (old[i] != NULL)
+    {
+      key_place(list, old[i]);
+    }
+  }
+  free(old);
+  return 1;
+}
+
+// Make room for one more node, returns 0 if out of memory
+static int key_reserve(SkipList *list)
+{
+  if ((list->key_count + 1) * 100 <= (list->key_mask + 1) * KEY_MAX_LOAD_PERCENT)
+  {
+    return 1;
+  }
+  return key_alloc(list, list->key_bits + 1);
+}
+
+static void key_erase(SkipList *list, const SkipNode *node)
+{
+  size_t hole = hash_key(list, node->data);
+  while (list->keys[hole] != node)
+  {
+    hole = (hole + 1) & list->key_mask;
+  }
+
+  // Backward shift: pull later entries of the cluster into the hole
+  size_t i = hole;
+  while (1)
+  {
+    i = (i + 1) & list->key_mask;
+    SkipNode *entry = list->keys[i];
+    if (entry == NULL)
+    {
+      break;
+    }
+    size_t home = hash_key(list, entry->data);
+    // Move it if its home is not cyclically within (hole, i]
+    if (((i - home) & list->key_mask) >= ((i - hole) & list->key_mask))
+    {
+      list->keys[hole] = entry;
+      hole = i;
+    }
+  }
+  list->keys[hole] = NULL;
+  list->key_count--;
+}
+
+// ---------- List ----------
+
+int skip_init(SkipList *list)
+{
+  for (int h = 1; h <= SKIP_MAX_LEVEL; h++)
+  {
+    pool_init(&list->pools[h - 1], node_size(h));
+  }
+
+  list->keys = NULL;
+  list->head = pool_alloc(&list->pools[SKIP_MAX_LEVEL - 1]);
+  if (list->head == NULL || !key_alloc(list, KEY_MIN_BITS))
+  {
+    skip_destroy(list);
+    return 0;
+  }
+  list->head->data = 0;
+  list->head->height = SKIP_MAX_LEVEL;
+  for (int l = 0; l < SKIP_MAX_LEVEL; l++)
+  {
+    list->head->level[l].next = NULL;
+    list->head->level[l].width = 1;
+  }
+
+  list->levels = 1;
+  list->length = 0;
+  list->random = 0x9E3779B97F4A7C15ULL;
+  return 1;
+}
+
+void skip_destroy(SkipList *list)
+{
+  for (int h = 1; h <= SKIP_MAX_LEVEL; h++)
+  {
+    pool_destroy(&list->pools[h - 1]);
+  }
+  free(list->keys);
+  list->keys = NULL;
+  list->key_count = 0;
+  list->head = NULL;
+  list->length = 0;
+}
+
+// Height with P(h) = (3/4) * (1/4)^(h-1)
+static int random_height(SkipList *list)
+{
+  uint64_t x = list->random;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  list->random = x;
+
+  int height = 1 + __builtin_ctzll(x | (1ULL << 62)) / 2;
+  return height < SKIP_MAX_LEVEL ? height : SKIP_MAX_LEVEL;
+}
+
+// Find the last node before target (a position) on every level.
+// Widths of links that run off the end count up to position length + 1.
+static void find_predecessors(const SkipList *list, size_t target,
+                              SkipNode **update, size_t *rank)
+{
+  SkipNode *x = list->head;
+  size_t pos = 0;
+
+  update[0] = x;
+  rank[0] = 0;
+  for (int l = list->levels - 1; l >= 0; l--)
+  {
+    while (x->level[l].next != NULL && pos + x->level[l].width < target)
+    {
+      pos += x->level[l].width;
+      x = x->level[l].next;
+    }
+    update[l] = x;
+    rank[l] = pos;
+  }
+}
+
+int skip_insert_at(SkipList *list, int data, size_t position)
+{
+  SkipNode *update[SKIP_MAX_LEVEL];
+  size_t rank[SKIP_MAX_LEVEL];
+
+  if (position < 1 || position > list->length + 1 || !key_reserve(list))
+  {
+    return 0;
+  }
+
+  int height = random_height(list);
+  SkipNode *node = pool_alloc(&list->pools[height - 1]);
+  if (node == NULL)
+  {
+    return 0;
+  }
+  node->data = data;
+  node->height = height;
+  key_place(list, node);
+
+  find_predecessors(list, position, update, rank);
+
+  // New top levels start at the head and span the whole list
+  for (int l = list->levels; l < height; l++)
+  {
+    update[l] = list->head;
+    rank[l] = 0;
+    list->head->level[l].next = NULL;
+    list->head->level[l].width = list->length + 1;
+  }
+  if (height > list->levels)
+  {
+    list->levels = height;
+  }
+
+  // Splice in, splitting each predecessor's width around the new node
+  size_t before = position - 1;
+  for (int l = 0; l < height; l++)
+  {
+    SkipLevel *prev = &update[l]->level[l];
+    size_t gap = before - rank[l];
+
+    node->level[l].next = prev->next;
+    node->level[l].width = prev->width - gap;
+    prev->next = node;
+    prev->width = gap + 1;
+  }
+
+  // Links above the new node now skip one more element
+  for (int l = height; l < list->levels; l++)
+  {
+    update[l]->level[l].width++;
+  }
+
+  list->length++;
+  return 1;
+}
+
+SkipNode *skip_get(const SkipList *list, size_t position)
+{
+  if (position < 1 || position > list->length)
+  {
+    return NULL;
+  }
+
+  SkipNode *x = list->head;
+  size_t pos = 0;
+  for (int l = list->levels - 1; l >= 0; l--)
+  {
+    while (x->level[l].next != NULL && pos + x->level[l].width <= position)
+    {
+      pos += x->level[l].width;
+      x = x->level[l].next;
+    }
+    if (pos == position)
+    {
+      return x;
+    }
+  }
+  return NULL;
+}
+
+int skip_delete_at(SkipList *list, size_t position)
+{
+  SkipNode *update[SKIP_MAX_LEVEL];
+  size_t rank[SKIP_MAX_LEVEL];
+
+  if (position < 1 || position > list->length)
+  {
+    return 0;
+  }
+
+  find_predecessors(list, position, update, rank);
+  SkipNode *node = update[0]->level[0].next;
+
+  for (int l = 0; l < list->levels; l++)
+  {
+    SkipLevel *prev = &update[l]->level[l];
+    if (prev->next == node)
+    {
+      prev->width += node->level[l].width - 1;
+      prev->next = node->level[l].next;
+    }
+    else
+    {
+      prev->width--;
+    }
+  }
+
+  // Drop levels that became empty
+  while (list->levels > 1 && list->head->level[list->levels - 1].next == NULL)
+  {
+    list->levels--;
+  }
+
+  list->length--;
+  key_erase(list, node);
+  pool_free(&list->pools[node->height - 1], node);
+  return 1;
+}
+
+size_t skip_rank(const SkipList *list, const SkipNode *node)
+{
+  // Links that run off the end count up to position length + 1, so the
+  // widths from node to the end add up to length + 1 - position
+  size_t to_end = 0;
+  for (const SkipNode *x = node; x != NULL; x = x->level[x->height - 1].next)
+  {
+    to_end += x->level[x->height - 1].width;
+  }
+  return list->length + 1 - to_end;
+}
+
+int skip_delete_key(SkipList *list, int key)
+{
+  // Every element equal to key is in the probe run from its hash; the
+  // first in list order is the one with the lowest position
+  size_t first = 0;
+  for (size_t i = hash_key(list, key); list->keys[i] != NULL; i = (i + 1) & list->key_mask)
+  {
+    if (list->keys[i]->data == key)
+    {
+      size_t position = skip_rank(list, list->keys[i]);
+      if (first == 0 || position < first)
+      {
+        first = position;
+      }
+    }
+  }
+  return first != 0 && skip_delete_at(list, first);
+}
+
+void skip_print(const SkipList *list, const char *label)
+{
+  printf("%s: ", label);
+  for (SkipNode *x = list->head->level[0].next; x != NULL; x = x->level[0].next)
+  {
+    printf("%d -> ", x->data);
+  }
+  printf("NULL\n");
+}
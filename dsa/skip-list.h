@@ -0,0 +1,77 @@
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "node-pool.h"
+
+// Indexable skip list: a positional list (like insert-link-list.c) where
+// every link also stores how many elements it skips. Finding position k
+// descends the levels in O(log n), so insert, lookup and delete by
+// position are all O(log n) instead of a walk of k nodes.
+//
+// A hash of every node by key finds the elements equal to a key in O(1);
+// a node's position is then the list length minus the widths walked from
+// it to the end, always along its highest link, which is the search path
+// backwards and O(log n) as well.
+//
+// Nodes of each height come from their own NodePool.
+
+#define SKIP_MAX_LEVEL 16 // Enough for 4^16 elements with p = 1/4
+
+typedef struct SkipLevel
+{
+  struct SkipNode *next;
+  size_t width; // Positions advanced by following next
+} SkipLevel;
+
+typedef struct SkipNode
+{
+  int data;
+  int height;
+  SkipLevel level[]; // height entries
+} SkipNode;
+
+typedef struct
+{
+  SkipNode *head;   // Sentinel with SKIP_MAX_LEVEL levels, at position 0
+  int levels;       // Levels currently in use
+  size_t length;
+  uint64_t random;  // xorshift state for node heights
+
+  // Every node by key: open addressing, linear probing, NULL marks an
+  // empty slot
+  SkipNode **keys;
+  size_t key_mask;  // capacity - 1, capacity is a power of two
+  int key_bits;     // log2(capacity)
+  size_t key_count;
+
+  NodePool pools[SKIP_MAX_LEVEL]; // pools[h - 1] holds nodes of height h
+} SkipList;
+
+// Returns 0 if out of memory
+int skip_init(SkipList *list);
+void skip_destroy(SkipList *list);
+
+// Insert data so it becomes element number position (1 = front), returns 1
+// on success and 0 if the position is out of range
+int skip_insert_at(SkipList *list, int data, size_t position);
+
+// Element at position, NULL if out of range
+SkipNode *skip_get(const SkipList *list, size_t position);
+
+// Delete the element at position, returns 1 on success
+int skip_delete_at(SkipList *list, size_t position);
+
+// Position of node in the list (1 = front), O(log n)
+size_t skip_rank(const SkipList *list, const SkipNode *node);
+
+// Delete the first element equal to key, returns 1 if one was removed.
+// O(log n) for each element equal to key.
+int skip_delete_key(SkipList *list, int key);
+
+// Print as "label: 2 -> 20 -> 100 -> NULL"
+void skip_print(const SkipList *list, const char *label);
+
+#endif
@@ -0,0 +1,100 @@
+// Build: gcc -O2 sorted-list-bench.c sorted-list.c link-list.c list-index.c list-split.c node-pool.c -o sorted-list-bench
+// Usage: ./sorted-list-bench [list-size] [batch-size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench-timer.h"
+#include "sorted-list.h"
+
+// Sorted list of 0, step, 2*step, ...
+void build_sorted(LinkList *list, int n, int step, int offset)
+{
+  list_init(list);
+  for (int i = 0; i < n; i++)
+    list_append(list, offset + i * step);
+}
+
+int same_contents(const LinkList *a, const LinkList *b)
+{
+  const sNode *x = list_front(a);
+  const sNode *y = list_front(b);
+  while (x != NULL && y != NULL && x->data == y->data)
+  {
+    x = x->link;
+    y = y->link;
+  }
+  return x == NULL && y == NULL && a->length == b->length;
+}
+
+void bench_batch(int n, int batch, const char *name, int clustered)
+{
+  int *keys = malloc(batch * sizeof(int));
+  int *copy = malloc(batch * sizeof(int));
+  srand(5);
+  for (int i = 0; i < batch; i++)
+  {
+    // Clustered batches land in a few narrow ranges, giving long runs
+    keys[i] = clustered ? (rand() % 8) * (n / 4) + rand() % 1000 : rand() % (2 * n);
+  }
+  memcpy(copy, keys, batch * sizeof(int));
+
+  LinkList one, batched;
+  build_sorted(&one, n, 2, 0);
+  build_sorted(&batched, n, 2, 0);
+
+  double start = now_seconds();
+  for (int i = 0; i < batch; i++)
+    list_insert_sorted(&one, keys[i]);
+  double t_one = now_seconds() - start;
+
+  start = now_seconds();
+  list_insert_batch(&batched, copy, batch);
+  double t_batch = now_seconds() - start;
+
+  printf("%-22s one-by-one %8.3fs  batch %8.4fs  %7.0fx  %s\n", name, t_one, t_batch,
+         t_one / t_batch,
+         same_contents(&one, &batched) && list_is_sorted(&batched) ? "same" : "DIFFERENT");
+
+  list_destroy(&one);
+  list_destroy(&batched);
+  free(keys);
+  free(copy);
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  int batch = argc > 2 ? atoi(argv[2]) : 20000;
+
+  printf("=== Sorted List Batch Insert / Merge / Dedup ===\n");
+  printf("List: %d nodes, batch: %d keys\n\n", n, batch);
+
+  bench_batch(n, batch, "Uniform batch", 0);
+  bench_batch(n, batch, "Clustered batch", 1);
+
+  // Merge two interleaved lists of 5M, then remove the overlap
+  int m = 5000000;
+  LinkList a, b;
+  build_sorted(&a, m, 2, 0);
+  build_sorted(&b, m, 3, 0);
+
+  double start = now_seconds();
+  list_merge(&a, &b);
+  double t_merge = now_seconds() - start;
+
+  start = now_seconds();
+  size_t removed = list_dedup(&a);
+  double t_dedup = now_seconds() - start;
+
+  // Multiples of 6 up to 2 * (m - 1) appear in both lists
+  size_t expected = 2 * (size_t)m - (2 * (size_t)(m - 1) / 6 + 1);
+  printf("\nMerge %d + %d nodes: %.3fs (src left with %zu)\n", m, m, t_merge, b.length);
+  printf("Dedup: %.3fs, removed %zu, %zu left, %s\n", t_dedup, removed, a.length,
+         a.length == expected && list_is_sorted(&a) ? "ok" : "WRONG");
+  list_destroy(&a);
+  list_destroy(&b);
+
+  return 0;
+}
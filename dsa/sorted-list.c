@@ -0,0 +1,196 @@
+#include <stdlib.h>
+
+#include "sorted-list.h"
+
+int list_insert_sorted(LinkList *list, int key)
+{
+  sNode *prev = &list->head;
+
+  if (list->tail != &list->head && list->tail->data <= key)
+  {
+    prev = list->tail;
+  }
+  while (prev->link != NULL && prev->link->data <= key)
+  {
+    prev = prev->link;
+  }
+  return list_insert_after(list, prev, key) != NULL;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// First index in (from, count) whose key is >= bound, given keys[from] < bound
+static size_t gallop(const int *keys, size_t from, size_t count, int bound)
+{
+  size_t lo = from; // keys[lo] < bound
+  size_t step = 1;
+  size_t hi = from + 1;
+
+  while (hi < count && keys[hi] < bound)
+  {
+    lo = hi;
+    step *= 2;
+    hi = from + step;
+  }
+  if (hi > count)
+  {
+    hi = count;
+  }
+
+  // Now keys[lo] < bound and (hi == count or keys[hi] >= bound)
+  while (hi - lo > 1)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (keys[mid] < bound)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return hi;
+}
+
+size_t list_insert_batch(LinkList *list, int *keys, size_t count)
+{
+  if (!list_index_reserve(list, list->length + count))
+  {
+    return 0;
+  }
+  qsort(keys, count, sizeof(int), compare_ints);
+
+  sNode *prev = &list->head;
+  size_t i = 0;
+
+  while (i < count)
+  {
+    // Everything from here on goes after the tail: no walk needed
+    if (list->tail != &list->head && list->tail->data <= keys[i])
+    {
+      prev = list->tail;
+    }
+    while (prev->link != NULL && prev->link->data <= keys[i])
+    {
+      prev = prev->link;
+    }
+
+    // keys[i..end) all fall between prev and its successor
+    sNode *next = prev->link;
+    size_t end = next == NULL ? count : gallop(keys, i, count, next->data);
+
+    for (; i < end; i++)
+    {
+      sNode *newNode = pool_alloc(&list->pool);
+      if (newNode == NULL)
+      {
+        prev->link = next;
+        if (next == NULL)
+          list->tail = prev;
+        list_index_rebuild(list);
+        list_split_relinked(list);
+        return i;
+      }
+      newNode->data = keys[i];
+      prev->link = newNode;
+      prev = newNode;
+      list->length++;
+    }
+    prev->link = next;
+    if (next == NULL)
+    {
+      list->tail = prev;
+    }
+  }
+
+  list_index_rebuild(list);
+  list_split_relinked(list);
+  return count;
+}
+
+int list_merge(LinkList *dst, LinkList *src)
+{
+  if (!list_index_reserve(dst, dst->length + src->length))
+  {
+    return 0;
+  }
+
+  sNode *prev = &dst->head;
+  sNode *s = src->head.link;
+
+  while (s != NULL)
+  {
+    while (prev->link != NULL && prev->link->data <= s->data)
+    {
+      prev = prev->link;
+    }
+
+    // The rest of src goes after the end of dst
+    if (prev->link == NULL)
+    {
+      prev->link = s;
+      dst->tail = src->tail;
+      break;
+    }
+
+    // Splice the run of src nodes that sort before prev's successor
+    sNode *next = prev->link;
+    sNode *run_end = s;
+    while (run_end->link != NULL && run_end->link->data < next->data)
+    {
+      run_end = run_end->link;
+    }
+    sNode *after = run_end->link;
+    prev->link = s;
+    run_end->link = next;
+    prev = run_end;
+    s = after;
+  }
+
+  dst->length += src->length;
+  pool_absorb(&dst->pool, &src->pool);
+
+  list_index_detach(src);
+  src->head.link = NULL;
+  src->tail = &src->head;
+  src->length = 0;
+  list_split_relinked(src);
+  list_index_rebuild(dst);
+  list_split_relinked(dst);
+  return 1;
+}
+
+size_t list_dedup(LinkList *list)
+{
+  size_t removed = 0;
+  sNode *temp = list_front(list);
+
+  while (temp != NULL && temp->link != NULL)
+  {
+    if (temp->link->data == temp->data)
+    {
+      list_remove_after(list, temp);
+      removed++;
+    }
+    else
+    {
+      temp = temp->link;
+    }
+  }
+  return removed;
+}
+
+int list_is_sorted(const LinkList *list)
+{
+  for (const sNode *temp = list_front(list); temp != NULL && temp->link != NULL;
+       temp = temp->link)
+  {
+    if (temp->link->data < temp->data)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
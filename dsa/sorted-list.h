@@ -0,0 +1,35 @@
+#ifndef SORTED_LIST_H
+#define SORTED_LIST_H
+
+#include <stddef.h>
+
+#include "link-list.h"
+
+// Sorted-list mode for LinkList: keys kept in non-decreasing order.
+//
+// list_insert_batch() sorts a batch once and merges it in a single pass
+// over the list, instead of one O(n) walk per key. Runs of batch keys that
+// fall between the same two list nodes are found by galloping (exponential
+// then binary search) and spliced in together, and keys at or beyond the
+// tail skip the walk altogether. Merging two lists and dedup are linear and
+// relink existing nodes without allocating.
+
+// Insert key after any equal keys, returns 0 if out of memory
+int list_insert_sorted(LinkList *list, int key);
+
+// Sort keys in place and merge them in, returns how many were inserted
+// (less than count only when out of memory)
+size_t list_insert_batch(LinkList *list, int *keys, size_t count);
+
+// Move every node of src into dst in order, leaving src empty. The nodes
+// change pools along with their chunks, so no node is copied. Returns 0
+// if dst's index cannot grow, with both lists unchanged.
+int list_merge(LinkList *dst, LinkList *src);
+
+// Remove adjacent duplicates, returns how many nodes were removed
+size_t list_dedup(LinkList *list);
+
+// Returns 1 if the list is in non-decreasing order
+int list_is_sorted(const LinkList *list);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thread-pool.h"
+
+// Take tasks until there are none left
+static void drain_tasks(ThreadPool *pool)
+{
+  int task;
+  while ((task = atomic_fetch_add(&pool->next_task, 1)) < pool->num_tasks)
+  {
+    pool->fn(pool->arg, task);
+  }
+}
+
+static void *worker_main(void *arg)
+{
+  ThreadPool *pool = arg;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  while (1)
+  {
+    while (pool->generation == seen && !pool->stop)
+    {
+      pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    if (pool->stop)
+    {
+      break;
+    }
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    drain_tasks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->active == 0)
+    {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+int tpool_init(ThreadPool *pool, int threads)
+{
+  if (threads <= 0)
+  {
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (threads < 1)
+  {
+    threads = 1;
+  }
+
+  pool->num_threads = 0;
+  pool->threads = malloc(threads * sizeof(pthread_t));
+  if (pool->threads == NULL)
+  {
+    return 0;
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->fn = NULL;
+  pool->arg = NULL;
+  pool->num_tasks = 0;
+  atomic_init(&pool->next_task, 0);
+  pool->active = 0;
+  pool->generation = 0;
+  pool->stop = 0;
+
+  for (int t = 0; t < threads - 1; t++)
+  {
+    if (pthread_create(&pool->threads[t], NULL, worker_main, pool) != 0)
+    {
+      tpool_destroy(pool);
+      return 0;
+    }
+    pool->num_threads++;
+  }
+  return 1;
+}
+
+void tpool_destroy(ThreadPool *pool)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (int t = 0; t < pool->num_threads; t++)
+  {
+    pthread_join(pool->threads[t], NULL);
+  }
+  free(pool->threads);
+  pool->threads = NULL;
+  pool->num_threads = 0;
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work);
+  pthread_cond_destroy(&pool->done);
+}
+
+void tpool_run(ThreadPool *pool, int num_tasks, tpool_task fn, void *arg)
+{
+  pthread_mutex_lock(&pool->lock);
+  pool->fn = fn;
+  pool->arg = arg;
+  pool->num_tasks = num_tasks;
+  atomic_store(&pool->next_task, 0);
+  pool->active = pool->num_threads;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  // The caller works too instead of just waiting
+  drain_tasks(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->active > 0)
+  {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+int tpool_size(const ThreadPool *pool)
+{
+  return pool->num_threads + 1;
+}
@@ -0,0 +1,45 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Persistent worker threads for fork-join jobs.
+//
+// tpool_run() hands out task numbers 0..num_tasks-1 to the workers and the
+// calling thread, and returns once every task has finished. The threads
+// stay parked on a condition variable between jobs, so running a job costs
+// one broadcast rather than a pthread_create() per thread.
+
+typedef void (*tpool_task)(void *arg, int task);
+
+typedef struct
+{
+  pthread_t *threads;
+  int num_threads; // Workers, not counting the caller
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+
+  // Current job
+  tpool_task fn;
+  void *arg;
+  int num_tasks;
+  atomic_int next_task;
+  int active;                // Workers still on the current job
+  unsigned long generation;  // Bumped for every job
+  int stop;
+} ThreadPool;
+
+// threads is the total parallelism including the caller, 0 means one per
+// online CPU. Returns 0 if the threads could not be started.
+int tpool_init(ThreadPool *pool, int threads);
+void tpool_destroy(ThreadPool *pool);
+
+// Run fn(arg, task) for every task and wait for all of them
+void tpool_run(ThreadPool *pool, int num_tasks, tpool_task fn, void *arg);
+
+// Total parallelism including the caller
+int tpool_size(const ThreadPool *pool);
+
+#endif
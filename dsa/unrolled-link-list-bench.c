@@ -0,0 +1,174 @@
+// Build: gcc -O2 unrolled-link-list-bench.c unrolled-link-list.c link-list.c list-index.c list-split.c node-pool.c -o unrolled-link-list-bench
+// Usage: ./unrolled-link-list-bench [nodes]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench-timer.h"
+#include "link-list.h"
+#include "unrolled-link-list.h"
+
+#define SCANS 5
+#define EDIT_LIST 100000
+#define EDITS 20000
+
+// Same key search as delete-link-list.c
+int plain_contains(const sNode *temp, int key)
+{
+  while (temp != NULL && temp->data != key)
+  {
+    temp = temp->link;
+  }
+  return temp != NULL;
+}
+
+// Plain list whose nodes are scattered across the heap, as they end up
+// after a long run of inserts and deletes
+sNode *build_scattered(int n)
+{
+  sNode **nodes = malloc(n * sizeof(sNode *));
+  for (int i = 0; i < n; i++)
+  {
+    nodes[i] = (sNode *)malloc(sizeof(sNode));
+  }
+  for (int i = n - 1; i > 0; i--)
+  {
+    int j = rand() % (i + 1);
+    sNode *swap = nodes[i];
+    nodes[i] = nodes[j];
+    nodes[j] = swap;
+  }
+  for (int i = 0; i < n; i++)
+  {
+    nodes[i]->data = i;
+    nodes[i]->link = i + 1 < n ? nodes[i + 1] : NULL;
+  }
+  sNode *front = nodes[0];
+  free(nodes);
+  return front;
+}
+
+void bench_scans(int n)
+{
+  printf("\n--- Full scans (key search for a missing key, %d nodes x %d) ---\n",
+         n, SCANS);
+
+  sNode *scattered = build_scattered(n);
+  double start = now_seconds();
+  int found = 0;
+  for (int s = 0; s < SCANS; s++)
+    found += plain_contains(scattered, -1);
+  double scattered_time = now_seconds() - start;
+
+  LinkList list;
+  list_init(&list);
+  for (int i = 0; i < n; i++)
+    list_append(&list, i);
+  start = now_seconds();
+  for (int s = 0; s < SCANS; s++)
+    found += plain_contains(list_front(&list), -1);
+  double pooled_time = now_seconds() - start;
+
+  UnrolledList ulist;
+  ulist_init(&ulist);
+  for (int i = 0; i < n; i++)
+    ulist_append(&ulist, i);
+  start = now_seconds();
+  for (int s = 0; s < SCANS; s++)
+    found += ulist_contains(&ulist, -1);
+  double unrolled_time = now_seconds() - start;
+
+  printf("plain list, scattered nodes  %7.3fs  (%5.2f ns/element)\n",
+         scattered_time, scattered_time * 1e9 / ((double)n * SCANS));
+  printf("plain list, pooled nodes     %7.3fs  (%5.2f ns/element)\n",
+         pooled_time, pooled_time * 1e9 / ((double)n * SCANS));
+  printf("unrolled list                %7.3fs  (%5.2f ns/element)  %.1fx / %.1fx faster\n",
+         unrolled_time, unrolled_time * 1e9 / ((double)n * SCANS),
+         scattered_time / unrolled_time, pooled_time / unrolled_time);
+  if (found != 0)
+    printf("unexpected match!\n");
+
+  while (scattered != NULL)
+  {
+    sNode *next = scattered->link;
+    free(scattered);
+    scattered = next;
+  }
+  list_destroy(&list);
+  ulist_destroy(&ulist);
+}
+
+void bench_edits()
+{
+  printf("\n--- Positional inserts and keyed deletes (%d nodes, %d edits) ---\n",
+         EDIT_LIST, EDITS);
+
+  LinkList list;
+  UnrolledList ulist;
+  list_init(&list);
+  ulist_init(&ulist);
+  for (int i = 0; i < EDIT_LIST; i++)
+  {
+    list_append(&list, i);
+    ulist_append(&ulist, i);
+  }
+
+  int *positions = malloc(EDITS * sizeof(int));
+  int *keys = malloc(EDITS * sizeof(int));
+  srand(7);
+  for (int i = 0; i < EDITS; i++)
+  {
+    positions[i] = 1 + rand() % EDIT_LIST;
+    keys[i] = rand() % EDIT_LIST;
+  }
+
+  double start = now_seconds();
+  for (int i = 0; i < EDITS; i++)
+  {
+    list_insert_at(&list, -i, positions[i]);
+    list_delete_key(&list, keys[i]);
+  }
+  double plain_time = now_seconds() - start;
+
+  start = now_seconds();
+  for (int i = 0; i < EDITS; i++)
+  {
+    ulist_insert_at(&ulist, -i, positions[i]);
+    ulist_delete_key(&ulist, keys[i]);
+  }
+  double unrolled_time = now_seconds() - start;
+
+  // Both lists must hold the same sequence
+  int same = list.length == ulist.length;
+  sNode *temp = list_front(&list);
+  for (uNode *block = ulist.front; same && block != NULL; block = block->link)
+  {
+    for (int i = 0; i < block->count && same; i++, temp = temp->link)
+    {
+      same = temp->data == block->data[i];
+    }
+  }
+
+  printf("plain list     %7.3fs\n", plain_time);
+  printf("unrolled list  %7.3fs  %.1fx faster  (%s)\n", unrolled_time,
+         plain_time / unrolled_time, same ? "same contents" : "CONTENTS DIFFER");
+
+  free(positions);
+  free(keys);
+  list_destroy(&list);
+  ulist_destroy(&ulist);
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  printf("=== Unrolled vs Plain Linked List ===\n");
+  printf("Block size: %d bytes, %d ints per block\n", (int)sizeof(uNode),
+         (int)UNROLLED_CAPACITY);
+
+  bench_scans(n);
+  bench_edits();
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "unrolled-link-list.h"
+
+_Static_assert(sizeof(uNode) == CACHE_LINE, "uNode must fill one cache line");
+
+void ulist_init(UnrolledList *list)
+{
+  list->front = NULL;
+  list->tail = NULL;
+  list->length = 0;
+  pool_init_aligned(&list->pool, sizeof(uNode), CACHE_LINE);
+}
+
+void ulist_destroy(UnrolledList *list)
+{
+  pool_destroy(&list->pool);
+  list->front = NULL;
+  list->tail = NULL;
+  list->length = 0;
+}
+
+// New empty block linked after prev (or at the front when prev is NULL)
+static uNode *new_block(UnrolledList *list, uNode *prev)
+{
+  uNode *block = pool_alloc(&list->pool);
+  if (block == NULL)
+  {
+    return NULL;
+  }
+
+  block->count = 0;
+  if (prev == NULL)
+  {
+    block->link = list->front;
+    list->front = block;
+  }
+  else
+  {
+    block->link = prev->link;
+    prev->link = block;
+  }
+  if (block->link == NULL)
+  {
+    list->tail = block;
+  }
+  return block;
+}
+
+int ulist_append(UnrolledList *list, int data)
+{
+  uNode *block = list->tail;
+
+  if (block == NULL || block->count == (int)UNROLLED_CAPACITY)
+  {
+    block = new_block(list, block);
+    if (block == NULL)
+    {
+      return 0;
+    }
+  }
+  block->data[block->count++] = data;
+  list->length++;
+  return 1;
+}
+
+int ulist_insert_at(UnrolledList *list, int data, int position)
+{
+  if (position < 1 || (size_t)position > list->length + 1)
+  {
+    return 0;
+  }
+  if ((size_t)position == list->length + 1)
+  {
+    return ulist_append(list, data);
+  }
+
+  // Skip whole blocks until the one holding the position
+  int index = position - 1;
+  uNode *block = list->front;
+  while (index >= block->count)
+  {
+    index -= block->count;
+    block = block->link;
+  }
+
+  // Full block: move its upper half into a new block first
+  if (block->count == (int)UNROLLED_CAPACITY)
+  {
+    uNode *half = new_block(list, block);
+    if (half == NULL)
+    {
+      return 0;
+    }
+    int keep = UNROLLED_CAPACITY / 2;
+    half->count = UNROLLED_CAPACITY - keep;
+    memcpy(half->data, block->data + keep, half->count * sizeof(int));
+    block->count = keep;
+
+    if (index > keep)
+    {
+      index -= keep;
+      block = half;
+    }
+  }
+
+  memmove(block->data + index + 1, block->data + index,
+          (block->count - index) * sizeof(int));
+  block->data[index] = data;
+  block->count++;
+  list->length++;
+  return 1;
+}
+
+int ulist_delete_key(UnrolledList *list, int key)
+{
+  uNode *prev = NULL;
+
+  for (uNode *block = list->front; block != NULL; prev = block, block = block->link)
+  {
+    int index = 0;
+    while (index < block->count && block->data[index] != key)
+    {
+      index++;
+    }
+    if (index == block->count)
+    {
+      continue;
+    }
+
+    memmove(block->data + index, block->data + index + 1,
+            (block->count - index - 1) * sizeof(int));
+    block->count--;
+    list->length--;
+
+    uNode *next = block->link;
+    if (block->count == 0)
+    {
+      // Empty block: unlink it
+      if (prev == NULL)
+        list->front = next;
+      else
+        prev->link = next;
+      if (list->tail == block)
+        list->tail = prev;
+      pool_free(&list->pool, block);
+    }
+    else if (block->count < (int)UNROLLED_CAPACITY / 2 && next != NULL &&
+             block->count + next->count <= (int)UNROLLED_CAPACITY)
+    {
+      // Underfull block: merge the next one into it when both fit
+      memcpy(block->data + block->count, next->data, next->count * sizeof(int));
+      block->count += next->count;
+      block->link = next->link;
+      if (list->tail == next)
+        list->tail = block;
+      pool_free(&list->pool, next);
+    }
+    return 1;
+  }
+  return 0;
+}
+
+int ulist_contains(const UnrolledList *list, int key)
+{
+  for (const uNode *block = list->front; block != NULL; block = block->link)
+  {
+    // Contiguous keys, so a scan touches one cache line per few keys
+    // instead of one per node
+    for (int i = 0; i < block->count; i++)
+    {
+      if (block->data[i] == key)
+      {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+void ulist_print(const UnrolledList *list, const char *label)
+{
+  printf("%s: ", label);
+  for (const uNode *block = list->front; block != NULL; block = block->link)
+  {
+    for (int i = 0; i < block->count; i++)
+    {
+      printf("%d -> ", block->data[i]);
+    }
+  }
+  printf("NULL\n");
+}
@@ -0,0 +1,49 @@
+#ifndef UNROLLED_LINK_LIST_H
+#define UNROLLED_LINK_LIST_H
+
+#include <stddef.h>
+
+#include "node-pool.h"
+
+// Unrolled linked list: each node is one 64-byte cache line holding up to
+// UNROLLED_CAPACITY ints, so a scan takes one cache miss per block instead
+// of one per element. Blocks come from a cache-line aligned NodePool.
+
+#define CACHE_LINE 64
+#define UNROLLED_CAPACITY ((CACHE_LINE - sizeof(void *) - sizeof(int)) / sizeof(int))
+
+typedef struct uNode
+{
+  struct uNode *link;
+  int count;                    // Used slots in data[]
+  int data[UNROLLED_CAPACITY];  // Elements in list order
+} uNode;
+
+typedef struct
+{
+  uNode *front;
+  uNode *tail;
+  size_t length;
+  NodePool pool;
+} UnrolledList;
+
+void ulist_init(UnrolledList *list);
+void ulist_destroy(UnrolledList *list);
+
+// Append at the back, returns 0 if out of memory
+int ulist_append(UnrolledList *list, int data);
+
+// Insert data so it becomes element number position (1 = front), returns 1
+// on success and 0 if the position is out of range
+int ulist_insert_at(UnrolledList *list, int data, int position);
+
+// Delete the first element equal to key, returns 1 if one was removed
+int ulist_delete_key(UnrolledList *list, int key);
+
+// Returns 1 if key is in the list
+int ulist_contains(const UnrolledList *list, int key);
+
+// Print as "label: 2 -> 20 -> 100 -> NULL"
+void ulist_print(const UnrolledList *list, const char *label);
+
+#endif
@@ -0,0 +1,289 @@
+#include <math.h>
+
+#include "aqm.h"
+
+// RED parameters: thresholds as a fraction of the queue limit
+#define RED_WEIGHT 0.002 // EWMA weight of the instantaneous length
+#define RED_MAX_P 0.1    // Drop probability at max_th
+#define RED_MIN_FRACTION 20 // min_th = limit / 20 (at least 5 packets)
+
+// PIE controller gains (per second of delay error, RFC 8033)
+#define PIE_ALPHA 0.125
+#define PIE_BETA 1.25
+
+// Uniform double in [0, 1) (xorshift64*)
+static double next_random(Aqm *aqm)
+{
+  aqm->random ^= aqm->random >> 12;
+  aqm->random ^= aqm->random << 25;
+  aqm->random ^= aqm->random >> 27;
+  return (double)((aqm->random * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;
+}
+
+void aqm_init(Aqm *aqm, int policy, int limit, int64_t time_scale, int64_t now)
+{
+  if (time_scale < 1)
+  {
+    time_scale = 1;
+  }
+
+  aqm->policy = policy;
+  aqm->limit = limit;
+  aqm->time_scale = time_scale;
+  aqm->random = 0x9E3779B97F4A7C15ULL;
+
+  aqm->avg = 0;
+  aqm->since_drop = 0;
+
+  aqm->first_above = 0;
+  aqm->drop_next = 0;
+  aqm->count = 0;
+  aqm->last_count = 0;
+  aqm->dropping = 0;
+
+  aqm->prob = 0;
+  aqm->qdelay = 0;
+  aqm->qdelay_old = 0;
+  aqm->burst_allowance = AQM_PIE_BURST_US * time_scale;
+
+  if (policy == AQM_PIE)
+  {
+    aqm->target = AQM_PIE_TARGET_US * time_scale;
+    aqm->interval = AQM_PIE_UPDATE_US * time_scale;
+  }
+  else
+  {
+    aqm->target = AQM_CODEL_TARGET_US * time_scale;
+    aqm->interval = AQM_CODEL_INTERVAL_US * time_scale;
+  }
+  aqm->next_update = now + aqm->interval;
+
+  aqm->enqueue_drops = 0;
+  aqm->dequeue_drops = 0;
+}
+
+// ---------- RED ----------
+
+static int red_drop(Aqm *aqm, int queue_len)
+{
+  double min_th = aqm->limit / RED_MIN_FRACTION;
+  if (min_th < 5)
+  {
+    min_th = 5;
+  }
+  double max_th = 3 * min_th;
+
+  aqm->avg += RED_WEIGHT * (queue_len - aqm->avg);
+
+  // Gentle RED: probability climbs to max_p at max_th, then to 1 at 2*max_th
+  double p;
+  if (aqm->avg < min_th)
+  {
+    aqm->since_drop = 0;
+    return 0;
+  }
+  else if (aqm->avg < max_th)
+    p = RED_MAX_P * (aqm->avg - min_th) / (max_th - min_th);
+  else if (aqm->avg < 2 * max_th)
+    p = RED_MAX_P + (1 - RED_MAX_P) * (aqm->avg - max_th) / max_th;
+  else
+    p = 1;
+
+  // Spread drops out evenly instead of in clusters
+  double pa = aqm->since_drop * p < 1 ? p / (1 - aqm->since_drop * p) : 1;
+  if (next_random(aqm) < pa)
+  {
+    aqm->since_drop = 0;
+    return 1;
+  }
+  aqm->since_drop++;
+  return 0;
+}
+
+// ---------- PIE ----------
+
+// Periodic drop probability update, run lazily from the enqueue/dequeue path
+static void pie_update(Aqm *aqm, int64_t now)
+{
+  // After a long idle gap one update stands in for all the missed ones
+  if (now - aqm->next_update > 100 * aqm->interval)
+  {
+    aqm->next_update = now - aqm->interval;
+  }
+
+  while (now >= aqm->next_update)
+  {
+    // Delay error in (scaled) seconds
+    double seconds = 1e-6 / aqm->time_scale;
+    double error = (aqm->qdelay - aqm->target) * seconds;
+    double trend = (aqm->qdelay - aqm->qdelay_old) * seconds;
+    double delta = PIE_ALPHA * error + PIE_BETA * trend;
+
+    // Small probabilities move in small steps (RFC 8033 section 4.2)
+    if (aqm->prob < 0.000001)
+      delta /= 2048;
+    else if (aqm->prob < 0.00001)
+      delta /= 512;
+    else if (aqm->prob < 0.0001)
+      delta /= 128;
+    else if (aqm->prob < 0.001)
+      delta /= 32;
+    else if (aqm->prob < 0.01)
+      delta /= 8;
+    else if (aqm->prob < 0.1)
+      delta /= 2;
+
+    aqm->prob += delta;
+
+    // Decay when the queue has been empty for two updates
+    if (aqm->qdelay == 0 && aqm->qdelay_old == 0)
+    {
+      aqm->prob *= 0.98;
+    }
+    if (aqm->prob < 0)
+      aqm->prob = 0;
+    if (aqm->prob > 1)
+      aqm->prob = 1;
+
+    if (aqm->burst_allowance > 0)
+    {
+      aqm->burst_allowance -= aqm->interval;
+    }
+    else if (aqm->prob == 0 && aqm->qdelay < aqm->target / 2 &&
+             aqm->qdelay_old < aqm->target / 2)
+    {
+      aqm->burst_allowance = AQM_PIE_BURST_US * aqm->time_scale;
+    }
+
+    aqm->qdelay_old = aqm->qdelay;
+    aqm->next_update += aqm->interval;
+  }
+}
+
+static int pie_drop(Aqm *aqm, int queue_len, int64_t now)
+{
+  if (queue_len == 0)
+  {
+    aqm->qdelay = 0;
+  }
+  pie_update(aqm, now);
+
+  if (aqm->burst_allowance > 0)
+    return 0;
+
+  // Leave short or calm queues alone
+  if ((aqm->qdelay_old < aqm->target / 2 && aqm->prob < 0.2) || queue_len <= 2)
+    return 0;
+
+  return next_random(aqm) < aqm->prob;
+}
+
+// ---------- CoDel ----------
+
+// Next drop time: the interval shrinks with the square root of the count
+static int64_t codel_control_law(const Aqm *aqm, int64_t t)
+{
+  return t + (int64_t)(aqm->interval / sqrt(aqm->count));
+}
+
+// True once sojourn has stayed above target for a whole interval
+static int codel_ok_to_drop(Aqm *aqm, int64_t sojourn, int queue_len, int64_t now)
+{
+  if (sojourn < aqm->target || queue_len == 0)
+  {
+    aqm->first_above = 0;
+    return 0;
+  }
+  if (aqm->first_above == 0)
+  {
+    aqm->first_above = now + aqm->interval;
+    return 0;
+  }
+  return now >= aqm->first_above;
+}
+
+static int codel_drop(Aqm *aqm, int64_t sojourn, int queue_len, int64_t now)
+{
+  int ok_to_drop = codel_ok_to_drop(aqm, sojourn, queue_len, now);
+
+  if (aqm->dropping)
+  {
+    if (!ok_to_drop)
+    {
+      aqm->dropping = 0;
+      return 0;
+    }
+    if (now >= aqm->drop_next)
+    {
+      aqm->count++;
+      aqm->drop_next = codel_control_law(aqm, aqm->drop_next);
+      return 1;
+    }
+    return 0;
+  }
+
+  if (ok_to_drop)
+  {
+    aqm->dropping = 1;
+
+    // Resume close to the old drop rate if we only just left dropping state
+    int delta = aqm->count - aqm->last_count;
+    aqm->count = delta > 1 && now - aqm->drop_next < 16 * aqm->interval ? delta : 1;
+    aqm->drop_next = codel_control_law(aqm, now);
+    aqm->last_count = aqm->count;
+    return 1;
+  }
+  return 0;
+}
+
+// ---------- Entry points ----------
+
+int aqm_drop_on_enqueue(Aqm *aqm, int queue_len, int64_t now)
+{
+  int drop;
+
+  if (queue_len >= aqm->limit)
+    drop = 1;
+  else if (aqm->policy == AQM_RED)
+    drop = red_drop(aqm, queue_len);
+  else if (aqm->policy == AQM_PIE)
+    drop = pie_drop(aqm, queue_len, now);
+  else
+    drop = 0;
+
+  aqm->enqueue_drops += drop;
+  return drop;
+}
+
+int aqm_drop_on_dequeue(Aqm *aqm, int64_t sojourn, int queue_len, int64_t now)
+{
+  int drop = 0;
+
+  if (aqm->policy == AQM_PIE)
+  {
+    aqm->qdelay = sojourn;
+    pie_update(aqm, now);
+  }
+  else if (aqm->policy == AQM_CODEL)
+  {
+    drop = codel_drop(aqm, sojourn, queue_len, now);
+  }
+
+  aqm->dequeue_drops += drop;
+  return drop;
+}
+
+const char *aqm_name(int policy)
+{
+  switch (policy)
+  {
+  case AQM_RED:
+    return "RED";
+  case AQM_CODEL:
+    return "CoDel";
+  case AQM_PIE:
+    return "PIE";
+  default:
+    return "tail-drop";
+  }
+}
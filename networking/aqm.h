@@ -0,0 +1,83 @@
+#ifndef AQM_H
+#define AQM_H
+
+// Active queue management for the queue shaper in simple-leaky-bucket.c.
+//
+// Tail drop only drops once the queue is full, so under sustained overload
+// the queue sits full and every packet waits the whole queue's worth of
+// time. The other policies drop early to keep that standing queue short:
+//
+//   RED   - drop on enqueue with a probability that grows with the
+//           average queue length (Floyd & Jacobson, "gentle" variant)
+//   CoDel - drop on dequeue once packets have waited longer than target
+//           for a whole interval, then faster and faster (RFC 8289)
+//   PIE   - drop on enqueue with a probability steered by a controller
+//           on the queueing delay (RFC 8033)
+//
+// Every packet carries its enqueue time; times are microseconds on any
+// monotonic clock (virtual time in the benchmark). The full queue is still
+// a hard limit for every policy.
+
+#include <stdint.h>
+
+#define AQM_TAIL_DROP 0
+#define AQM_RED 1
+#define AQM_CODEL 2
+#define AQM_PIE 3
+#define AQM_POLICIES 4
+
+#define AQM_CODEL_TARGET_US 5000     // Acceptable standing delay
+#define AQM_CODEL_INTERVAL_US 100000 // About one round trip
+#define AQM_PIE_TARGET_US 15000
+#define AQM_PIE_UPDATE_US 15000      // Drop probability update period
+#define AQM_PIE_BURST_US 150000      // Bursts this long are let through
+
+typedef struct
+{
+  int policy;
+  int limit;          // Queue capacity in packets
+  int64_t target;     // Delay target (CoDel, PIE)
+  int64_t interval;   // CoDel interval / PIE update period
+  int64_t time_scale; // From aqm_init()
+  uint64_t random;    // Generator state for RED and PIE
+
+  // RED
+  double avg;         // Average queue length
+  int since_drop;     // Packets accepted since the last drop
+
+  // CoDel
+  int64_t first_above; // When sojourn first stayed above target, 0 if not
+  int64_t drop_next;   // Next drop time while dropping
+  int count;           // Drops in the current dropping state
+  int last_count;
+  int dropping;
+
+  // PIE
+  double prob;           // Drop probability
+  int64_t qdelay;        // Latest queueing delay estimate
+  int64_t qdelay_old;
+  int64_t next_update;
+  int64_t burst_allowance;
+
+  // Counters
+  unsigned long enqueue_drops;
+  unsigned long dequeue_drops;
+} Aqm;
+
+// Set up a policy for a queue of limit packets. The CoDel and PIE targets
+// are scaled by time_scale (1 for real networks, larger for slow simulated
+// ticks such as the 2 second tick of simple-leaky-bucket.c).
+void aqm_init(Aqm *aqm, int policy, int limit, int64_t time_scale, int64_t now);
+
+// Before queueing a packet when queue_len packets are waiting.
+// Returns 1 if it should be dropped instead.
+int aqm_drop_on_enqueue(Aqm *aqm, int queue_len, int64_t now);
+
+// After taking the head packet off, with queue_len packets left behind it
+// and sojourn = now - its enqueue time. Returns 1 if it should be dropped
+// instead of sent (only CoDel drops here).
+int aqm_drop_on_dequeue(Aqm *aqm, int64_t sojourn, int queue_len, int64_t now);
+
+const char *aqm_name(int policy);
+
+#endif
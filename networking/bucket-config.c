@@ -0,0 +1,534 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/inotify.h>
+
+#include "bucket-config.h"
+
+// Default values used for keys missing from the file
+#define DEFAULT_CAPACITY 20
+#define DEFAULT_LEAK_RATE 3
+#define DEFAULT_LEAK_MODE 1
+#define DEFAULT_BUCKET_SIZE 10
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define DEFAULT_AQM 0 // Tail drop
+#define MAX_FLOWS 1000000
+#define MAX_WINDOWS 1024
+
+// Currently published snapshot
+static _Atomic(BucketConfig *) current_config = NULL;
+static atomic_ulong config_generation = 0;
+
+// Writers serialize among themselves, readers never touch this
+static pthread_mutex_t publish_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define READER_FREE 0
+#define READER_ONLINE 1
+#define READER_OFFLINE 2 // Registered, but holds no snapshot (blocked on input)
+
+// Grace period tracking: each reader records the epoch it last saw
+static atomic_ulong grace_epoch = 1;
+static atomic_ulong reader_epoch[CONFIG_MAX_READERS];
+static atomic_int reader_used[CONFIG_MAX_READERS]; // READER_* state
+
+// Watcher thread state
+static pthread_t watch_thread;
+static atomic_int watch_running = 0;
+static char watch_path[512];
+
+// Parse an already trimmed integer value, returns 1 on success. Trailing
+// characters and values outside int are errors.
+static int parse_int(const char *text, int *value)
+{
+  char *end;
+  errno = 0;
+  long v = strtol(text, &end, 10);
+
+  if (end == text || *end != '\0' || errno == ERANGE || v < INT_MIN || v > INT_MAX)
+  {
+    return 0;
+  }
+  *value = (int)v;
+  return 1;
+}
+
+// Strip comments and surrounding whitespace in place
+static char *trim_line(char *line)
+{
+  char *hash = strchr(line, '#');
+  if (hash != NULL)
+  {
+    *hash = '\0';
+  }
+
+  while (*line == ' ' || *line == '\t')
+  {
+    line++;
+  }
+
+  char *end = line + strlen(line);
+  while (end > line && (end[-1] == ' ' || end[-1] == '\t' ||
+                        end[-1] == '\n' || end[-1] == '\r'))
+  {
+    *--end = '\0';
+  }
+  return line;
+}
+
+// Time zone names as found under /usr/share/zoneinfo, or POSIX TZ strings
+static int valid_timezone(const char *name)
+{
+  if (strlen(name) >= sizeof(((WeekSchedule *)0)->timezone))
+  {
+    return 0;
+  }
+  return strspn(name, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+                      "0123456789/_+-:,.<>") == strlen(name);
+}
+
+// Append one "window <days> <HH:MM-HH:MM> rate=<n>" line
+static int parse_window_line(char *line, ScheduleWindow **windows, int *num_windows)
+{
+  if (*num_windows >= MAX_WINDOWS)
+  {
+    return 0;
+  }
+  ScheduleWindow *grown = realloc(*windows, (*num_windows + 1) * sizeof(ScheduleWindow));
+  if (grown == NULL)
+  {
+    return 0;
+  }
+  *windows = grown;
+  if (!schedule_parse_window(line + 6, &grown[*num_windows]))
+  {
+    return 0;
+  }
+  (*num_windows)++;
+  return 1;
+}
+
+// Parse one "flow <id> capacity=<n> rate=<n>" line into the override table
+static int parse_flow_line(char *line, FlowParams **overrides, int *num_overrides)
+{
+  int flow_id;
+  char *token = strtok(line + 4, " \t");
+
+  if (token == NULL || !parse_int(token, &flow_id) ||
+      flow_id < 0 || flow_id >= MAX_FLOWS)
+  {
+    return 0;
+  }
+
+  if (flow_id >= *num_overrides)
+  {
+    int new_count = flow_id + 1;
+    FlowParams *grown = realloc(*overrides, new_count * sizeof(FlowParams));
+    if (grown == NULL)
+    {
+      return 0;
+    }
+    for (int i = *num_overrides; i < new_count; i++)
+    {
+      grown[i].capacity = -1; // -1 means "use the default"
+      grown[i].leak_rate = -1;
+    }
+    *overrides = grown;
+    *num_overrides = new_count;
+  }
+
+  while ((token = strtok(NULL, " \t")) != NULL)
+  {
+    if (strncmp(token, "capacity=", 9) == 0)
+    {
+      if (!parse_int(token + 9, &(*overrides)[flow_id].capacity))
+        return 0;
+    }
+    else if (strncmp(token, "rate=", 5) == 0)
+    {
+      if (!parse_int(token + 5, &(*overrides)[flow_id].leak_rate))
+        return 0;
+    }
+    else
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+BucketConfig *config_parse_file(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL)
+  {
+    printf("CONFIG: cannot open %s\n", path);
+    return NULL;
+  }
+
+  int capacity = DEFAULT_CAPACITY;
+  int leak_rate = DEFAULT_LEAK_RATE;
+  int base_leak_rate = -1;
+  int leak_mode = DEFAULT_LEAK_MODE;
+  int bucket_size = DEFAULT_BUCKET_SIZE;
+  int max_queue_size = DEFAULT_MAX_QUEUE_SIZE;
+  int aqm = DEFAULT_AQM;
+  int num_flows = 0;
+  FlowParams *overrides = NULL;
+  int num_overrides = 0;
+  ScheduleWindow *windows = NULL;
+  int num_windows = 0;
+  char timezone[64] = "";
+  char recorder_path[256] = "";
+  int line_no = 0;
+  int ok = 1;
+  char buffer[512];
+
+  while (ok && fgets(buffer, sizeof(buffer), fp) != NULL)
+  {
+    line_no++;
+    char *line = trim_line(buffer);
+    if (*line == '\0')
+    {
+      continue;
+    }
+
+    if (strncmp(line, "flow", 4) == 0 && (line[4] == ' ' || line[4] == '\t'))
+    {
+      ok = parse_flow_line(line, &overrides, &num_overrides);
+    }
+    else if (strncmp(line, "window", 6) == 0 && (line[6] == ' ' || line[6] == '\t'))
+    {
+      ok = parse_window_line(line, &windows, &num_windows);
+    }
+    else
+    {
+      char *eq = strchr(line, '=');
+      if (eq == NULL)
+      {
+        ok = 0;
+        break;
+      }
+      *eq = '\0';
+      char *key = trim_line(line);
+      char *value = trim_line(eq + 1);
+      int v;
+
+      if (strcmp(key, "timezone") == 0)
+      {
+        ok = valid_timezone(value);
+        if (ok)
+          strcpy(timezone, value);
+      }
+      else if (strcmp(key, "recorder") == 0)
+      {
+        ok = strlen(value) < sizeof(recorder_path);
+        if (ok)
+          strcpy(recorder_path, value);
+      }
+      else if (!parse_int(value, &v))
+        ok = 0;
+      // Range checks here, so an error names the line it is on
+      else if (strcmp(key, "capacity") == 0)
+        ok = (capacity = v) > 0;
+      else if (strcmp(key, "leak_rate") == 0)
+        ok = (leak_rate = v) >= 0;
+      else if (strcmp(key, "base_leak_rate") == 0)
+        base_leak_rate = v;
+      else if (strcmp(key, "leak_mode") == 0)
+        ok = (leak_mode = v) >= 1 && v <= 4;
+      else if (strcmp(key, "bucket_size") == 0)
+        ok = (bucket_size = v) > 0;
+      else if (strcmp(key, "max_queue_size") == 0)
+        ok = (max_queue_size = v) > 0;
+      else if (strcmp(key, "aqm") == 0)
+        ok = (aqm = v) >= 0 && v <= 3;
+      else if (strcmp(key, "flows") == 0)
+        ok = (num_flows = v) >= 0 && v <= MAX_FLOWS;
+      else
+        ok = 0;
+    }
+  }
+  fclose(fp);
+
+  if (!ok)
+  {
+    printf("CONFIG: %s: invalid entry at line %d, keeping old config\n",
+           path, line_no);
+    free(overrides);
+    free(windows);
+    return NULL;
+  }
+
+  if (num_overrides > num_flows)
+  {
+    num_flows = num_overrides;
+  }
+
+  BucketConfig *cfg = malloc(sizeof(BucketConfig) + num_flows * sizeof(FlowParams));
+  if (cfg == NULL)
+  {
+    free(overrides);
+    free(windows);
+    return NULL;
+  }
+
+  cfg->generation = 0;
+  cfg->capacity = capacity;
+  cfg->leak_rate = leak_rate;
+  cfg->base_leak_rate = base_leak_rate >= 0 ? base_leak_rate : leak_rate;
+  cfg->leak_mode = leak_mode;
+  cfg->bucket_size = bucket_size;
+  cfg->max_queue_size = max_queue_size;
+  cfg->aqm = aqm;
+  cfg->num_flows = num_flows;
+
+  // Gaps between windows leak at the base rate
+  cfg->num_windows = num_windows;
+  if (!schedule_compile(&cfg->schedule, windows, num_windows, cfg->base_leak_rate))
+  {
+    printf("CONFIG: %s: schedule has too many transitions, keeping old config\n", path);
+    free(overrides);
+    free(windows);
+    free(cfg);
+    return NULL;
+  }
+  strcpy(cfg->schedule.timezone, timezone);
+  strcpy(cfg->recorder_path, recorder_path);
+
+  for (int i = 0; i < num_flows; i++)
+  {
+    int has_override = i < num_overrides;
+    cfg->flows[i].capacity = has_override && overrides[i].capacity > 0
+                                 ? overrides[i].capacity
+                                 : capacity;
+    cfg->flows[i].leak_rate = has_override && overrides[i].leak_rate >= 0
+                                  ? overrides[i].leak_rate
+                                  : leak_rate;
+  }
+
+  free(overrides);
+  free(windows);
+  return cfg;
+}
+
+// Wait until every online reader has passed a quiescent point. Offline
+// readers hold no snapshot, so they are not waited for.
+static void synchronize_readers()
+{
+  unsigned long target = atomic_fetch_add(&grace_epoch, 1) + 1;
+
+  for (int i = 0; i < CONFIG_MAX_READERS; i++)
+  {
+    if (atomic_load(&reader_used[i]) != READER_ONLINE)
+    {
+      continue;
+    }
+    while (atomic_load(&reader_used[i]) == READER_ONLINE &&
+           atomic_load_explicit(&reader_epoch[i], memory_order_acquire) < target)
+    {
+      usleep(1000);
+    }
+  }
+}
+
+unsigned long config_publish(BucketConfig *cfg)
+{
+  pthread_mutex_lock(&publish_lock);
+
+  unsigned long generation = atomic_fetch_add(&config_generation, 1) + 1;
+  cfg->generation = generation;
+  BucketConfig *old = atomic_exchange_explicit(&current_config, cfg,
+                                               memory_order_acq_rel);
+
+  // Readers may still hold the old snapshot until their next quiescent point
+  if (old != NULL)
+  {
+    synchronize_readers();
+    free(old);
+  }
+
+  pthread_mutex_unlock(&publish_lock);
+  return generation;
+}
+
+int config_load(const char *path)
+{
+  BucketConfig *cfg = config_parse_file(path);
+  if (cfg == NULL)
+  {
+    return 0;
+  }
+  unsigned long generation = config_publish(cfg);
+  printf("CONFIG: loaded %s (generation %lu)\n", path, generation);
+  return 1;
+}
+
+const BucketConfig *config_current(void)
+{
+  return atomic_load_explicit(&current_config, memory_order_acquire);
+}
+
+FlowParams config_flow_params(const BucketConfig *cfg, int flow_id)
+{
+  if (flow_id >= 0 && flow_id < cfg->num_flows)
+  {
+    return cfg->flows[flow_id];
+  }
+
+  FlowParams params;
+  params.capacity = cfg->capacity;
+  params.leak_rate = cfg->leak_rate;
+  return params;
+}
+
+int config_reader_register(void)
+{
+  for (int i = 0; i < CONFIG_MAX_READERS; i++)
+  {
+    int expected = READER_FREE;
+    if (atomic_compare_exchange_strong(&reader_used[i], &expected, READER_ONLINE))
+    {
+      atomic_store(&reader_epoch[i], atomic_load(&grace_epoch));
+      return i;
+    }
+  }
+  return -1;
+}
+
+void config_reader_quiescent(int slot)
+{
+  if (slot >= 0)
+  {
+    atomic_store_explicit(&reader_epoch[slot], atomic_load(&grace_epoch),
+                          memory_order_release);
+  }
+}
+
+void config_reader_offline(int slot)
+{
+  if (slot >= 0)
+  {
+    atomic_store(&reader_used[slot], READER_OFFLINE);
+  }
+}
+
+void config_reader_online(int slot)
+{
+  if (slot >= 0)
+  {
+    // Online before the epoch catches up: a writer that sees the old epoch
+    // just waits for the next quiescent point, it never skips this reader
+    // while it can see an old snapshot
+    atomic_store(&reader_used[slot], READER_ONLINE);
+    atomic_store(&reader_epoch[slot], atomic_load(&grace_epoch));
+  }
+}
+
+void config_reader_unregister(int slot)
+{
+  if (slot >= 0)
+  {
+    atomic_store(&reader_used[slot], READER_FREE);
+  }
+}
+
+// Watcher thread: reload whenever the file is rewritten or replaced
+static void *watch_loop(void *arg)
+{
+  (void)arg;
+  char dir[512];
+  const char *name;
+  const char *slash = strrchr(watch_path, '/');
+
+  if (slash != NULL)
+  {
+    snprintf(dir, sizeof(dir), "%.*s", (int)(slash - watch_path), watch_path);
+    name = slash + 1;
+  }
+  else
+  {
+    strcpy(dir, ".");
+    name = watch_path;
+  }
+
+  int fd = inotify_init1(IN_NONBLOCK);
+  if (fd < 0)
+  {
+    printf("CONFIG: inotify unavailable, hot reload disabled\n");
+    return NULL;
+  }
+
+  // Watch the directory so editors that save via rename are seen too
+  if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+  {
+    printf("CONFIG: cannot watch %s, hot reload disabled\n", dir);
+    close(fd);
+    return NULL;
+  }
+
+  char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct pollfd pfd = {fd, POLLIN, 0};
+
+  while (atomic_load(&watch_running))
+  {
+    if (poll(&pfd, 1, 200) <= 0)
+    {
+      continue;
+    }
+
+    int changed = 0;
+    ssize_t len;
+    while ((len = read(fd, events, sizeof(events))) > 0)
+    {
+      for (char *p = events; p < events + len;)
+      {
+        struct inotify_event *ev = (struct inotify_event *)p;
+        if (ev->len > 0 && strcmp(ev->name, name) == 0)
+        {
+          changed = 1;
+        }
+        p += sizeof(struct inotify_event) + ev->len;
+      }
+    }
+
+    if (changed)
+    {
+      config_load(watch_path);
+    }
+  }
+
+  close(fd);
+  return NULL;
+}
+
+int config_watch_start(const char *path)
+{
+  if (atomic_load(&watch_running))
+  {
+    return 0;
+  }
+
+  snprintf(watch_path, sizeof(watch_path), "%s", path);
+  atomic_store(&watch_running, 1);
+
+  if (pthread_create(&watch_thread, NULL, watch_loop, NULL) != 0)
+  {
+    atomic_store(&watch_running, 0);
+    return 0;
+  }
+  return 1;
+}
+
+void config_watch_stop(void)
+{
+  if (atomic_exchange(&watch_running, 0))
+  {
+    pthread_join(watch_thread, NULL);
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef BUCKET_CONFIG_H
+#define BUCKET_CONFIG_H
+
+// Bucket parameters loaded from a config file and hot-reloaded at runtime.
+//
+// A loaded configuration is an immutable snapshot. Reloads build a new
+// snapshot and publish it with a single atomic pointer swap, so the
+// admission path only ever does one atomic load and never takes a lock.
+// Old snapshots are freed once every registered reader has passed a
+// quiescent point (RCU-style grace period).
+
+#include "rate-schedule.h"
+
+#define CONFIG_MAX_READERS 64
+
+// Per-flow override of the default bucket parameters
+typedef struct
+{
+  int capacity;
+  int leak_rate;
+} FlowParams;
+
+// One immutable configuration snapshot
+typedef struct
+{
+  unsigned long generation; // Bumped on every publish
+  int capacity;             // Bucket capacity (packets)
+  int leak_rate;            // Leak rate (packets/second)
+  int base_leak_rate;       // Base rate for the variable bucket
+  int leak_mode;            // 1=adaptive, 2=scheduled, 3=load-based, 4=priority
+  int bucket_size;          // Counter reset value n for the queue shaper
+  int max_queue_size;       // Queue limit for the queue shaper
+  int aqm;                  // Queue shaper drop policy, AQM_* in aqm.h
+  int num_windows;          // Schedule window lines in the file (0 = none)
+  WeekSchedule schedule;    // Compiled windows for the scheduled mode
+  char recorder_path[256];  // Flight recorder file, empty = not recording
+  int num_flows;            // Number of entries in flows[]
+  FlowParams flows[];       // Per-flow parameters, indexed by flow id
+} BucketConfig;
+
+// Parse a config file into a new (unpublished) snapshot, NULL on error
+BucketConfig *config_parse_file(const char *path);
+
+// Publish a snapshot and free the one it replaces after a grace period,
+// returns the generation assigned to it
+unsigned long config_publish(BucketConfig *cfg);
+
+// Load a file and publish it, returns 1 on success
+int config_load(const char *path);
+
+// Current snapshot (NULL if none has been published). Never blocks.
+const BucketConfig *config_current(void);
+
+// Parameters for one flow, falling back to the defaults
+FlowParams config_flow_params(const BucketConfig *cfg, int flow_id);
+
+// Reader registration for the grace period
+int config_reader_register(void);
+void config_reader_quiescent(int slot);
+void config_reader_unregister(int slot);
+
+// Around a wait of unbounded length (scanf, poll): an offline reader must
+// not touch a snapshot, and writers do not wait for it
+void config_reader_offline(int slot);
+void config_reader_online(int slot);
+
+// Watch the config file with inotify and reload it on change
+int config_watch_start(const char *path);
+void config_watch_stop(void);
+
+#endif
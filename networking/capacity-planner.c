@@ -0,0 +1,577 @@
+// Build: gcc -O2 capacity-planner.c aqm.c ../dsa/thread-pool.c -o capacity-planner -pthread -lm
+// Usage: ./capacity-planner [packets|trace.csv] [steps] [threads]
+//
+// Parameter sweep for sizing a bucket. Replays one packet trace through a
+// grid of (capacity, base rate, leak mode, AQM policy) settings, one
+// virtual-time simulation per point, run in parallel on a thread pool.
+// The trace is loaded once and shared read-only by every simulation.
+//
+// The trace is a CSV file of "time_us,size,priority" lines (size in the
+// bucket's units, priority 1-4 as in variable-leaky-bucket.c), or a number
+// of packets to generate: bursty on/off Poisson traffic averaging about
+// 10000 units per second. steps is the number of capacities and of base
+// rates tried (geometric spacing, default 25: 25 x 25 x 4 modes x 4 AQM =
+// 10000 points); threads 0 means one per CPU.
+//
+// The bucket is simulated as a shaper: accepted packets wait in it and
+// leave at the leak rate, in order. For every point it measures the drop
+// rate, the p50/p99/p99.9 time a packet spent in the bucket and the
+// utilization (units sent over units the leak could have sent). All
+// points go to capacity-planner.csv; the Pareto frontier (no other point
+// has fewer drops, lower p99 and higher utilization) is printed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "aqm.h"
+#include "../dsa/thread-pool.h"
+
+#define MODE_FIXED 0
+#define MODE_ADAPTIVE 1
+#define MODE_LOAD 2
+#define MODE_PRIORITY 3
+#define MODES 4
+
+#define HIST_SUB_BITS 5 // 32 bins per power of two, ~3% resolution
+#define HIST_BINS (64 << HIST_SUB_BITS)
+#define RESULTS_FILE "capacity-planner.csv"
+#define FRONTIER_ROWS 40
+
+static const char *mode_names[MODES] = {"fixed", "adaptive", "load-based", "priority"};
+
+typedef struct
+{
+  int64_t time_us;
+  int32_t size;
+  int32_t priority;
+} TracePacket;
+
+typedef struct
+{
+  int capacity;
+  int base_rate; // Units per second
+  int mode;
+  int policy;
+} GridPoint;
+
+typedef struct
+{
+  double drop_rate;
+  double p50_ms, p99_ms, p999_ms;
+  double utilization;
+  double mean_rate; // Time-averaged leak rate
+  int pareto;
+} PointResult;
+
+typedef struct
+{
+  const TracePacket *trace; // Read-only, shared by all simulations
+  long num_packets;
+  int min_size;             // Smallest packet, in units
+  const GridPoint *grid;
+  PointResult *results;
+} Sweep;
+
+// ---------- Trace ----------
+
+static uint64_t next_random(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static double uniform(uint64_t *state)
+{
+  return (next_random(state) >> 11) / 9007199254740992.0;
+}
+
+// On/off source: bursts at 1.65x the mean rate, quiet spells at 0.35x, each
+// lasting an exponential 0.5 s on average. Sizes 1..8, priorities mostly 3.
+static TracePacket *generate_trace(long n)
+{
+  TracePacket *trace = malloc(n * sizeof(TracePacket));
+  uint64_t rng = 88172645463325252ULL;
+  double mean_pps = 10000 / 4.5;
+  double t = 0, phase_end = 0;
+  int burst = 0;
+
+  for (long i = 0; i < n; i++)
+  {
+    if (t >= phase_end)
+    {
+      burst = !burst;
+      phase_end = t - 0.5 * log(1 - uniform(&rng));
+    }
+    double pps = mean_pps * (burst ? 1.65 : 0.35);
+    t -= log(1 - uniform(&rng)) / pps;
+
+    int p = (int)(uniform(&rng) * 100);
+    trace[i].time_us = (int64_t)(t * 1e6);
+    trace[i].size = 1 + (int)(uniform(&rng) * 8);
+    trace[i].priority = p < 5 ? 1 : p < 20 ? 2 : p < 85 ? 3 : 4;
+  }
+  return trace;
+}
+
+static TracePacket *load_trace(const char *path, long *n)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+  {
+    perror(path);
+    return NULL;
+  }
+
+  long capacity = 1 << 16, count = 0, line_no = 0;
+  TracePacket *trace = malloc(capacity * sizeof(TracePacket));
+  char line[256];
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    line_no++;
+    long long time_us;
+    int size, priority = 3;
+    // Header and comment lines do not start with a number
+    if (sscanf(line, "%lld,%d,%d", &time_us, &size, &priority) < 2 || size <= 0)
+    {
+      continue;
+    }
+    if (count == capacity)
+    {
+      capacity *= 2;
+      trace = realloc(trace, capacity * sizeof(TracePacket));
+    }
+    if (count > 0 && time_us < trace[count - 1].time_us)
+    {
+      fprintf(stderr, "%s: packets out of time order at line %ld\n", path, line_no);
+      free(trace);
+      fclose(f);
+      return NULL;
+    }
+    trace[count].time_us = time_us;
+    trace[count].size = size;
+    trace[count].priority = priority;
+    count++;
+  }
+  fclose(f);
+  *n = count;
+  return trace;
+}
+
+// ---------- One simulation ----------
+
+typedef struct
+{
+  int64_t enqueue_us;
+  int size;
+} Queued;
+
+typedef struct
+{
+  GridPoint point;
+  Aqm aqm;
+  Queued *queue; // Ring of at most capacity packets (sizes are >= 1)
+  int front, count;
+  int level;     // Units in the bucket, the one being sent included
+
+  int rate;
+  int64_t rate_since;
+  double rate_integral; // Units the leak could have sent so far
+  int system_load;      // Load-based mode, as in load_based_leak_rate()
+  uint64_t rng;
+
+  int busy;             // A packet is being sent
+  Queued sending;
+  int64_t done_us;      // When it has left
+
+  unsigned long offered, dropped, sent;
+  long long sent_units;
+  unsigned hist[HIST_BINS];
+} Sim;
+
+// Log-linear histogram bin of a time in microseconds
+static inline int hist_bin(uint64_t us)
+{
+  if (us < (1 << HIST_SUB_BITS))
+    return (int)us;
+  int shift = 63 - __builtin_clzll(us) - HIST_SUB_BITS;
+  return ((shift + 1) << HIST_SUB_BITS) + (int)((us >> shift) & ((1 << HIST_SUB_BITS) - 1));
+}
+
+// Lower edge of a bin in microseconds
+static double hist_value(int bin)
+{
+  if (bin < (1 << HIST_SUB_BITS))
+    return bin;
+  int shift = (bin >> HIST_SUB_BITS) - 1;
+  return (double)(((uint64_t)1 << HIST_SUB_BITS) + (bin & ((1 << HIST_SUB_BITS) - 1))) *
+         ((uint64_t)1 << shift);
+}
+
+static double percentile_ms(const Sim *s, double pct)
+{
+  unsigned long rank = (unsigned long)(s->sent * pct / 100.0);
+  unsigned long seen = 0;
+
+  for (int b = 0; b < HIST_BINS; b++)
+  {
+    seen += s->hist[b];
+    if (seen > rank)
+      return hist_value(b) / 1000.0;
+  }
+  return 0;
+}
+
+static void set_rate(Sim *s, int rate, int64_t now)
+{
+  if (rate < 1)
+    rate = 1;
+  if (rate != s->rate)
+  {
+    s->rate_integral += (double)s->rate * (now - s->rate_since) / 1e6;
+    s->rate = rate;
+    s->rate_since = now;
+  }
+}
+
+// Same thresholds as adaptive_leak_rate()
+static void adaptive_rate(Sim *s, int64_t now)
+{
+  int base = s->point.base_rate;
+  float fill = (float)s->level / s->point.capacity;
+
+  if (fill > 0.8)
+    set_rate(s, base * 3, now);
+  else if (fill > 0.6)
+    set_rate(s, base * 2, now);
+  else if (fill > 0.4)
+    set_rate(s, (int)(base * 1.5), now);
+  else if (fill < 0.2)
+    set_rate(s, (int)(base * 0.7), now);
+  else
+    set_rate(s, base, now);
+}
+
+// Rate picked on every arrival, as update_leak_rate() does
+static void arrival_rate(Sim *s, int priority, int64_t now)
+{
+  int base = s->point.base_rate;
+
+  switch (s->point.mode)
+  {
+  case MODE_ADAPTIVE:
+    adaptive_rate(s, now);
+    break;
+
+  case MODE_LOAD:
+    // Same random walk and thresholds as load_based_leak_rate()
+    s->system_load += (int)(next_random(&s->rng) % 21) - 10;
+    s->system_load = s->system_load < 0 ? 0 : s->system_load > 100 ? 100 : s->system_load;
+    if (s->system_load > 80)
+      set_rate(s, 1, now);
+    else if (s->system_load > 60)
+      set_rate(s, (int)(base * 0.7), now);
+    else if (s->system_load > 40)
+      set_rate(s, base, now);
+    else if (s->system_load > 20)
+      set_rate(s, (int)(base * 1.5), now);
+    else
+      set_rate(s, base * 2, now);
+    break;
+
+  case MODE_PRIORITY:
+    // Same factors as priority_leak_rate()
+    set_rate(s, priority == 1 ? base * 3 : priority == 2 ? base * 2
+                : priority == 4 ? (int)(base * 0.5) : base, now);
+    break;
+  }
+}
+
+// The link is free at now: start sending the next packet the AQM keeps
+static void start_next(Sim *s, int64_t now)
+{
+  s->busy = 0;
+  while (s->count > 0)
+  {
+    Queued head = s->queue[s->front];
+    s->front = s->front + 1 == s->point.capacity ? 0 : s->front + 1;
+    s->count--;
+
+    if (s->point.mode == MODE_ADAPTIVE)
+      adaptive_rate(s, now);
+
+    if (aqm_drop_on_dequeue(&s->aqm, now - head.enqueue_us, s->count, now))
+    {
+      s->level -= head.size;
+      s->dropped++;
+      continue;
+    }
+
+    s->busy = 1;
+    s->sending = head;
+    s->done_us = now + ((int64_t)head.size * 1000000 + s->rate - 1) / s->rate;
+    return;
+  }
+}
+
+// Send everything that finishes by now
+static void run_until(Sim *s, int64_t now)
+{
+  while (s->busy && s->done_us <= now)
+  {
+    int64_t done = s->done_us;
+    s->level -= s->sending.size;
+    s->sent++;
+    s->sent_units += s->sending.size;
+    s->hist[hist_bin(done - s->sending.enqueue_us)]++;
+    start_next(s, done);
+  }
+}
+
+static void arrive(Sim *s, const TracePacket *p)
+{
+  int64_t now = p->time_us;
+
+  run_until(s, now);
+  arrival_rate(s, p->priority, now);
+  s->offered++;
+
+  if (s->level + p->size > s->point.capacity ||
+      aqm_drop_on_enqueue(&s->aqm, s->count + s->busy, now))
+  {
+    s->dropped++;
+    return;
+  }
+
+  int slot = s->front + s->count;
+  s->queue[slot >= s->point.capacity ? slot - s->point.capacity : slot] =
+      (Queued){now, p->size};
+  s->count++;
+  s->level += p->size;
+  if (!s->busy)
+    start_next(s, now);
+}
+
+static void simulate(void *arg, int task)
+{
+  Sweep *sweep = arg;
+  Sim *s = calloc(1, sizeof(Sim));
+  int64_t start = sweep->trace[0].time_us;
+  int64_t end = sweep->trace[sweep->num_packets - 1].time_us;
+
+  s->point = sweep->grid[task];
+  s->queue = malloc(s->point.capacity * sizeof(Queued));
+  s->rate = s->point.mode == MODE_ADAPTIVE ? (int)(s->point.base_rate * 0.7)
+                                           : s->point.base_rate;
+  if (s->rate < 1)
+    s->rate = 1;
+  s->rate_since = start;
+  s->system_load = 50;
+  s->rng = 0x9E3779B97F4A7C15ULL; // Same load walk for every point
+  // The AQM counts packets, and at most capacity / min_size of them fit in
+  // the bucket
+  int limit = s->point.capacity / sweep->min_size;
+  aqm_init(&s->aqm, s->point.policy, limit > 0 ? limit : 1, 1, start);
+
+  for (long i = 0; i < sweep->num_packets; i++)
+  {
+    arrive(s, &sweep->trace[i]);
+  }
+  // Utilization covers the trace's duration only; the backlog still drains
+  // afterwards so every accepted packet has a latency
+  double leak_units = s->rate_integral + (double)s->rate * (end - s->rate_since) / 1e6;
+  long long sent_units = s->sent_units;
+  run_until(s, INT64_MAX);
+
+  PointResult *r = &sweep->results[task];
+  r->drop_rate = s->offered ? (double)s->dropped / s->offered : 0;
+  r->p50_ms = percentile_ms(s, 50);
+  r->p99_ms = percentile_ms(s, 99);
+  r->p999_ms = percentile_ms(s, 99.9);
+  r->utilization = leak_units > 0 ? sent_units / leak_units : 0;
+  r->mean_rate = end > start ? leak_units * 1e6 / (end - start) : s->rate;
+  r->pareto = 0;
+
+  free(s->queue);
+  free(s);
+}
+
+// ---------- Sweep ----------
+
+static int dominates(const PointResult *a, const PointResult *b)
+{
+  return a->drop_rate <= b->drop_rate && a->p99_ms <= b->p99_ms &&
+         a->utilization >= b->utilization &&
+         (a->drop_rate < b->drop_rate || a->p99_ms < b->p99_ms ||
+          a->utilization > b->utilization);
+}
+
+static int same_result(const PointResult *a, const PointResult *b)
+{
+  return a->drop_rate == b->drop_rate && a->p99_ms == b->p99_ms &&
+         a->utilization == b->utilization;
+}
+
+static const PointResult *sort_results;
+
+static int compare_drop(const void *a, const void *b)
+{
+  const PointResult *x = &sort_results[*(const int *)a];
+  const PointResult *y = &sort_results[*(const int *)b];
+  if (x->drop_rate != y->drop_rate)
+    return x->drop_rate < y->drop_rate ? -1 : 1;
+  return (x->p99_ms > y->p99_ms) - (x->p99_ms < y->p99_ms);
+}
+
+// Geometric steps from lo to hi
+static void fill_steps(int *values, int steps, double lo, double hi)
+{
+  for (int i = 0; i < steps; i++)
+  {
+    values[i] = (int)(steps > 1 ? lo * pow(hi / lo, (double)i / (steps - 1)) : lo);
+  }
+}
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *source = argc > 1 ? argv[1] : "1000000";
+  int steps = argc > 2 ? atoi(argv[2]) : 25;
+  int threads = argc > 3 ? atoi(argv[3]) : 0;
+  char *end;
+  long num_packets = strtol(source, &end, 10);
+  TracePacket *trace;
+
+  if (*end == '\0')
+    trace = generate_trace(num_packets);
+  else
+    trace = load_trace(source, &num_packets);
+  if (trace == NULL || num_packets < 2 || steps < 1)
+  {
+    fprintf(stderr, "Usage: %s [packets|trace.csv] [steps] [threads]\n", argv[0]);
+    return 1;
+  }
+
+  // Offered load of the trace sets the range of rates worth trying
+  long long units = 0;
+  int min_size = trace[0].size;
+  for (long i = 0; i < num_packets; i++)
+  {
+    units += trace[i].size;
+    if (trace[i].size < min_size)
+      min_size = trace[i].size;
+  }
+  double seconds = (trace[num_packets - 1].time_us - trace[0].time_us) / 1e6;
+  double offered = seconds > 0 ? units / seconds : units;
+
+  // Capacities from a few packets to several seconds of traffic; rates
+  // from half to four times the mean offered load
+  int *capacities = malloc(steps * sizeof(int));
+  int *rates = malloc(steps * sizeof(int));
+  fill_steps(capacities, steps, 16, fmax(64, offered * 4));
+  fill_steps(rates, steps, fmax(1, offered / 2), fmax(4, offered * 4));
+
+  int num_points = steps * steps * MODES * AQM_POLICIES;
+  GridPoint *grid = malloc(num_points * sizeof(GridPoint));
+  int n = 0;
+  for (int c = 0; c < steps; c++)
+    for (int r = 0; r < steps; r++)
+      for (int m = 0; m < MODES; m++)
+        for (int p = 0; p < AQM_POLICIES; p++)
+          grid[n++] = (GridPoint){capacities[c], rates[r], m, p};
+
+  ThreadPool pool;
+  if (!tpool_init(&pool, threads))
+  {
+    fprintf(stderr, "Could not start the thread pool\n");
+    return 1;
+  }
+
+  printf("=== Capacity planner ===\n");
+  printf("Trace: %ld packets over %.1f s, %.0f units/s offered\n", num_packets, seconds,
+         offered);
+  printf("Grid:  %d capacities (%d-%d) x %d rates (%d-%d/s) x %d modes x %d AQM = %d points\n",
+         steps, capacities[0], capacities[steps - 1], steps, rates[0], rates[steps - 1], MODES,
+         AQM_POLICIES, num_points);
+  printf("Running on %d threads...\n", tpool_size(&pool));
+  fflush(stdout);
+
+  Sweep sweep = {trace, num_packets, min_size, grid, calloc(num_points, sizeof(PointResult))};
+  double t0 = now_seconds();
+  tpool_run(&pool, num_points, simulate, &sweep);
+  double elapsed = now_seconds() - t0;
+  tpool_destroy(&pool);
+
+  printf("Done in %.1f s: %.0f simulations/s, %.1f M packets/s\n", elapsed,
+         num_points / elapsed, (double)num_points * num_packets / elapsed / 1e6);
+
+  // Pareto frontier: fewer drops, lower p99, higher utilization. Of points
+  // with equal results (AQM makes no difference while the bucket never
+  // fills) only the first is kept, which has the smallest capacity.
+  PointResult *results = sweep.results;
+  int *frontier = malloc(num_points * sizeof(int));
+  int num_frontier = 0;
+  for (int i = 0; i < num_points; i++)
+  {
+    int dominated = 0;
+    for (int j = 0; j < num_points && !dominated; j++)
+      dominated = dominates(&results[j], &results[i]) ||
+                  (j < i && same_result(&results[j], &results[i]));
+    if (!dominated)
+    {
+      results[i].pareto = 1;
+      frontier[num_frontier++] = i;
+    }
+  }
+  sort_results = results;
+  qsort(frontier, num_frontier, sizeof(int), compare_drop);
+
+  FILE *csv = fopen(RESULTS_FILE, "w");
+  if (csv != NULL)
+  {
+    fprintf(csv, "capacity,base_rate,mode,aqm,drop_rate,p50_ms,p99_ms,p999_ms,"
+                 "utilization,mean_rate,pareto\n");
+    for (int i = 0; i < num_points; i++)
+    {
+      const GridPoint *g = &grid[i];
+      const PointResult *r = &results[i];
+      fprintf(csv, "%d,%d,%s,%s,%.6f,%.3f,%.3f,%.3f,%.4f,%.1f,%d\n", g->capacity,
+              g->base_rate, mode_names[g->mode], aqm_name(g->policy), r->drop_rate,
+              r->p50_ms, r->p99_ms, r->p999_ms, r->utilization, r->mean_rate, r->pareto);
+    }
+    fclose(csv);
+  }
+
+  printf("\nPareto frontier: %d of %d points (all in %s)\n", num_frontier, num_points,
+         RESULTS_FILE);
+  printf("  capacity    rate  mode        aqm         drops   p50 ms   p99 ms  p99.9 ms   util\n");
+  // Spread the printed rows over the whole frontier
+  int rows = num_frontier < FRONTIER_ROWS ? num_frontier : FRONTIER_ROWS;
+  for (int k = 0; k < rows; k++)
+  {
+    int i = frontier[rows > 1 ? (long)k * (num_frontier - 1) / (rows - 1) : 0];
+    const GridPoint *g = &grid[i];
+    const PointResult *r = &results[i];
+    printf("  %8d  %6d  %-10s  %-9s  %6.2f%%  %7.1f  %7.1f  %8.1f  %5.1f%%\n", g->capacity,
+           g->base_rate, mode_names[g->mode], aqm_name(g->policy), 100 * r->drop_rate,
+           r->p50_ms, r->p99_ms, r->p999_ms, 100 * r->utilization);
+  }
+
+  free(frontier);
+  free(results);
+  free(grid);
+  free(capacities);
+  free(rates);
+  free(trace);
+  return 0;
+}
@@ -0,0 +1,286 @@
+// Build: gcc -O2 cluster-limiter.c credit-lease.c -o cluster-limiter -pthread
+// Usage: ./cluster-limiter coordinator [port] [rate] [burst] [bind-address]
+//        ./cluster-limiter node [port] [node-id] [chunk] [seconds] [threads] [coordinator]
+//        ./cluster-limiter test [nodes] [seconds] [rate] [error]
+//
+// One global rate shared by several limiter processes. The coordinator
+// holds the quota and leases it out in chunks over UDP; every node admits
+// locally against its leased credit (see credit-lease.h).
+//
+// "test" runs a coordinator and several saturating node processes on
+// loopback and checks that the packets admitted across all of them stay
+// within the given relative error of rate * seconds + burst.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+
+#include "credit-lease.h"
+
+#define DEFAULT_PORT 9411
+#define DEFAULT_RATE 100000 // Packets per second for the whole cluster
+#define MAX_THREADS 16
+
+typedef struct
+{
+  LeaseNode *node;
+  double seconds;
+  atomic_llong admitted;
+} Load;
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Offer packets as fast as possible for a fixed time
+static void *load_worker(void *arg)
+{
+  Load *load = arg;
+  struct timespec pause = {0, 50000};
+  double end = now_seconds() + load->seconds;
+  long long admitted = 0;
+  unsigned long tries = 0;
+
+  while ((++tries & 255) || now_seconds() < end)
+  {
+    if (lease_admit(load->node, 1))
+    {
+      admitted++;
+    }
+    else
+    {
+      nanosleep(&pause, NULL); // Out of credit until the next lease
+    }
+  }
+  atomic_fetch_add(&load->admitted, admitted);
+  return NULL;
+}
+
+// Saturate one node from several threads, returns packets admitted
+static long long run_load(LeaseNode *node, double seconds, int threads)
+{
+  pthread_t workers[MAX_THREADS];
+  Load load;
+
+  load.node = node;
+  load.seconds = seconds;
+  atomic_init(&load.admitted, 0);
+  for (int i = 0; i < threads; i++)
+  {
+    pthread_create(&workers[i], NULL, load_worker, &load);
+  }
+  for (int i = 0; i < threads; i++)
+  {
+    pthread_join(workers[i], NULL);
+  }
+  return atomic_load(&load.admitted);
+}
+
+int run_coordinator(const char *addr, int port, double rate, double burst)
+{
+  LeaseCoordinator co;
+
+  if (!lease_coordinator_init(&co, addr, port, rate, burst))
+  {
+    return 1;
+  }
+  printf("Coordinator on %s UDP port %d: %.0f/s, burst %.0f\n",
+         addr != NULL ? addr : LEASE_DEFAULT_ADDR, co.port, rate, burst);
+  lease_coordinator_run(&co);
+  printf("Granted %lld in %lu leases, %lld returned\n", co.granted, co.requests, co.returned);
+  lease_coordinator_close(&co);
+  return 0;
+}
+
+int run_node(const char *host, int port, int node_id, long long chunk, double seconds,
+             int threads)
+{
+  LeaseNode node;
+
+  if (!lease_node_start(&node, host, port, node_id, chunk))
+  {
+    return 1;
+  }
+  printf("Node %d: chunk %lld, %d threads, %.0f s\n", node_id, chunk, threads, seconds);
+  for (int s = 0; s < seconds; s++)
+  {
+    long long admitted = run_load(&node, 1, threads);
+    printf("  %2d s: %lld admitted, %lld credit held\n", s + 1, admitted,
+           (long long)atomic_load(&node.credit));
+  }
+  lease_node_stop(&node);
+  printf("Leased %lld in %llu leases, returned %lld\n", (long long)atomic_load(&node.granted),
+         (unsigned long long)atomic_load(&node.leases), (long long)atomic_load(&node.returned));
+  return 0;
+}
+
+int run_test(int nodes, double seconds, double rate, double error)
+{
+  if (nodes < 1 || nodes > LEASE_MAX_NODES)
+  {
+    fprintf(stderr, "nodes must be 1..%d\n", LEASE_MAX_NODES);
+    return 1;
+  }
+
+  // Chunks of about 10 ms of a node's fair share keep leasing cheap; the
+  // worst case overshoot is burst + nodes * chunk
+  long long chunk = (long long)(rate / nodes / 100);
+  if (chunk < 1)
+  {
+    chunk = 1;
+  }
+
+  // The bucket has to hold what flows in while a lease is on its way. At
+  // low rates a chunk is a token or two; a burst that small fills between
+  // two requests and the rest of the refill is lost.
+  double burst = rate * LEASE_RETRY_MS / 1000;
+  if (burst < chunk)
+  {
+    burst = chunk;
+  }
+  double expected = rate * seconds + burst;
+  int to_parent[2], from_coordinator[2];
+  LeaseCoordinator co;
+
+  printf("=== Cluster Rate Limit Test ===\n");
+  printf("%d node processes, %.0f/s global, %.1f s, chunk %lld, burst %.0f\n", nodes, rate,
+         seconds, chunk, burst);
+  printf("Allowed error %.2f%%, worst-case lease overshoot %.2f%%\n\n", 100 * error,
+         100 * (burst + nodes * chunk) / expected);
+
+  // Bind before forking so the nodes never race the coordinator's socket
+  if (!lease_coordinator_init(&co, NULL, 0, rate, burst) || pipe(to_parent) < 0 ||
+      pipe(from_coordinator) < 0)
+  {
+    return 1;
+  }
+
+  fflush(stdout);
+  pid_t coordinator = fork();
+  if (coordinator == 0)
+  {
+    close(to_parent[0]);
+    close(to_parent[1]);
+    close(from_coordinator[0]);
+    lease_coordinator_run(&co);
+    long long totals[2] = {co.granted, co.returned};
+    int sent = write(from_coordinator[1], totals, sizeof(totals)) == sizeof(totals);
+    _exit(sent ? 0 : 1);
+  }
+  lease_coordinator_close(&co);
+  close(from_coordinator[1]);
+
+  pid_t children[LEASE_MAX_NODES];
+  for (int i = 0; i < nodes; i++)
+  {
+    children[i] = fork();
+    if (children[i] == 0)
+    {
+      LeaseNode node;
+      long long result[2] = {i, -1};
+
+      close(to_parent[0]);
+      close(from_coordinator[0]);
+
+      if (lease_node_start(&node, "127.0.0.1", co.port, i, chunk))
+      {
+        result[1] = run_load(&node, seconds, 2);
+        lease_node_stop(&node);
+      }
+      int sent = write(to_parent[1], result, sizeof(result)) == sizeof(result);
+      _exit(sent ? 0 : 1);
+    }
+  }
+  // Only the children write now, so a crashed one shows up as a short read
+  close(to_parent[1]);
+
+  long long admitted = 0;
+  int failed = 0;
+  for (int i = 0; i < nodes; i++)
+  {
+    long long result[2];
+    if (read(to_parent[0], result, sizeof(result)) != sizeof(result) || result[1] < 0)
+    {
+      failed = 1;
+      continue;
+    }
+    printf("  node %2lld: %9lld admitted (%.0f/s)\n", result[0], result[1], result[1] / seconds);
+    admitted += result[1];
+  }
+  for (int i = 0; i < nodes; i++)
+  {
+    waitpid(children[i], NULL, 0);
+  }
+
+  long long totals[2] = {0, 0};
+  lease_send_shutdown("127.0.0.1", co.port);
+  if (read(from_coordinator[0], totals, sizeof(totals)) != sizeof(totals))
+  {
+    printf("Coordinator did not report its totals\n");
+    failed = 1;
+  }
+  waitpid(coordinator, NULL, 0);
+  close(to_parent[0]);
+  close(from_coordinator[0]);
+
+  double measured = (admitted - expected) / expected;
+  printf("\nCoordinator: %lld granted, %lld returned, %lld net\n", totals[0], totals[1],
+         totals[0] - totals[1]);
+  printf("Admitted %lld, expected %.0f (%.0f/s), error %+.3f%%\n", admitted, expected,
+         admitted / seconds, 100 * measured);
+
+  if (failed || measured > error || measured < -error)
+  {
+    printf("FAIL: global rate outside %.2f%%\n", 100 * error);
+    return 1;
+  }
+  printf("PASS: global rate held within %.2f%%\n", 100 * error);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *mode = argc > 1 ? argv[1] : "test";
+
+  if (strcmp(mode, "coordinator") == 0)
+  {
+    int port = argc > 2 ? atoi(argv[2]) : DEFAULT_PORT;
+    double rate = argc > 3 ? atof(argv[3]) : DEFAULT_RATE;
+    double burst = argc > 4 ? atof(argv[4]) : rate / 100;
+    const char *addr = argc > 5 ? argv[5] : NULL;
+    return run_coordinator(addr, port, rate, burst);
+  }
+  if (strcmp(mode, "node") == 0)
+  {
+    int port = argc > 2 ? atoi(argv[2]) : DEFAULT_PORT;
+    int node_id = argc > 3 ? atoi(argv[3]) : 0;
+    long long chunk = argc > 4 ? atoll(argv[4]) : 250;
+    double seconds = argc > 5 ? atof(argv[5]) : 5;
+    int threads = argc > 6 ? atoi(argv[6]) : 1;
+    const char *host = argc > 7 ? argv[7] : LEASE_DEFAULT_ADDR;
+    if (threads < 1 || threads > MAX_THREADS)
+    {
+      threads = 1;
+    }
+    return run_node(host, port, node_id, chunk, seconds, threads);
+  }
+  if (strcmp(mode, "test") == 0)
+  {
+    int nodes = argc > 2 ? atoi(argv[2]) : 4;
+    double seconds = argc > 3 ? atof(argv[3]) : 3;
+    double rate = argc > 4 ? atof(argv[4]) : DEFAULT_RATE;
+    double error = argc > 5 ? atof(argv[5]) : 0.02;
+    return run_test(nodes, seconds, rate, error);
+  }
+
+  fprintf(stderr, "Usage: %s coordinator|node|test [options]\n", argv[0]);
+  return 1;
+}
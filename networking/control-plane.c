@@ -0,0 +1,464 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "control-plane.h"
+
+#define MAX_CLIENTS 8
+#define CLIENT_BUFFER_SIZE 256
+#define REPLY_TIMEOUT_MS 2000
+
+// Command ring: control thread produces, data path consumes
+static ControlCommand command_slots[CONTROL_MAILBOX_SIZE];
+static atomic_uint command_head = 0;
+static atomic_uint command_tail = 0;
+
+// Reply ring: data path produces, control thread consumes
+static ControlReply reply_slots[CONTROL_MAILBOX_SIZE];
+static atomic_uint reply_head = 0;
+static atomic_uint reply_tail = 0;
+
+// Stats block published with a sequence lock
+#define STATS_WORDS (sizeof(ControlStats) / sizeof(int))
+static atomic_uint stats_seq = 0;
+static atomic_int stats_words[STATS_WORDS];
+
+// Socket thread state
+static pthread_t control_thread;
+static atomic_int control_running = 0;
+static int listen_fd = -1;
+static char socket_path[108];
+static int next_command_id = 1;
+
+typedef struct
+{
+  int fd;
+  int used;
+  int pending_id;         // Command awaiting a data path reply, 0 if none
+  long long deadline;     // When the pending command times out (ms)
+  char buffer[CLIENT_BUFFER_SIZE];
+} Client;
+
+static Client clients[MAX_CLIENTS];
+
+// Push a command for the data path, returns 0 if the ring is full
+static int push_command(const ControlCommand *cmd)
+{
+  unsigned tail = atomic_load_explicit(&command_tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&command_head, memory_order_acquire);
+
+  if (tail - head == CONTROL_MAILBOX_SIZE)
+  {
+    return 0;
+  }
+  command_slots[tail & (CONTROL_MAILBOX_SIZE - 1)] = *cmd;
+  atomic_store_explicit(&command_tail, tail + 1, memory_order_release);
+  return 1;
+}
+
+int control_poll_command(ControlCommand *cmd)
+{
+  unsigned head = atomic_load_explicit(&command_head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&command_tail, memory_order_acquire);
+
+  if (head == tail)
+  {
+    return 0;
+  }
+  *cmd = command_slots[head & (CONTROL_MAILBOX_SIZE - 1)];
+  atomic_store_explicit(&command_head, head + 1, memory_order_release);
+  return 1;
+}
+
+void control_reply(int id, const char *format, ...)
+{
+  unsigned tail = atomic_load_explicit(&reply_tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&reply_head, memory_order_acquire);
+
+  // Never wait for the control thread: drop the reply if it fell behind
+  if (tail - head == CONTROL_MAILBOX_SIZE)
+  {
+    return;
+  }
+
+  ControlReply *reply = &reply_slots[tail & (CONTROL_MAILBOX_SIZE - 1)];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(reply->text, sizeof(reply->text), format, args);
+  va_end(args);
+  reply->id = id;
+
+  atomic_store_explicit(&reply_tail, tail + 1, memory_order_release);
+}
+
+static int pop_reply(ControlReply *reply)
+{
+  unsigned head = atomic_load_explicit(&reply_head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(&reply_tail, memory_order_acquire);
+
+  if (head == tail)
+  {
+    return 0;
+  }
+  *reply = reply_slots[head & (CONTROL_MAILBOX_SIZE - 1)];
+  atomic_store_explicit(&reply_head, head + 1, memory_order_release);
+  return 1;
+}
+
+void control_publish_stats(const ControlStats *stats)
+{
+  const int *words = (const int *)stats;
+  unsigned seq = atomic_load_explicit(&stats_seq, memory_order_relaxed);
+
+  // Odd sequence marks an update in progress
+  atomic_store_explicit(&stats_seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  for (unsigned i = 0; i < STATS_WORDS; i++)
+  {
+    atomic_store_explicit(&stats_words[i], words[i], memory_order_relaxed);
+  }
+  atomic_store_explicit(&stats_seq, seq + 2, memory_order_release);
+}
+
+static void read_stats(ControlStats *stats)
+{
+  int *words = (int *)stats;
+  unsigned before, after;
+
+  do
+  {
+    before = atomic_load_explicit(&stats_seq, memory_order_acquire);
+    for (unsigned i = 0; i < STATS_WORDS; i++)
+    {
+      words[i] = atomic_load_explicit(&stats_words[i], memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+    after = atomic_load_explicit(&stats_seq, memory_order_relaxed);
+  } while ((before & 1) || before != after);
+}
+
+static void send_text(int fd, const char *text)
+{
+  size_t len = strlen(text);
+  while (len > 0)
+  {
+    ssize_t n = send(fd, text, len, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      return;
+    }
+    text += n;
+    len -= n;
+  }
+}
+
+static long long now_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Forward a command to the data path. The reply is sent from the control
+// loop when it arrives; the client's next lines wait until then, so
+// replies stay in order, but other clients are served meanwhile.
+static void forward_command(Client *c, int type, int arg1, int arg2)
+{
+  ControlCommand cmd = {type, next_command_id, arg1, arg2};
+
+  // 0 means "nothing pending", skip it when the ids wrap
+  next_command_id = next_command_id == INT_MAX ? 1 : next_command_id + 1;
+  if (!push_command(&cmd))
+  {
+    send_text(c->fd, "ERR busy\n");
+    return;
+  }
+  c->pending_id = cmd.id;
+  c->deadline = now_ms() + REPLY_TIMEOUT_MS;
+}
+
+// Handle one protocol line, returns 0 if the client should be closed
+static int handle_line(Client *c, char *line)
+{
+  int fd = c->fd;
+  char verb[16];
+  int arg1 = 0, arg2 = 3;
+  int fields = sscanf(line, "%15s %d %d", verb, &arg1, &arg2);
+
+  if (fields < 1)
+  {
+    return 1;
+  }
+
+  if (strcmp(verb, "ADD") == 0 && fields >= 2 && arg1 > 0)
+  {
+    forward_command(c, CMD_ADD_PACKET, arg1, arg2);
+  }
+  else if (strcmp(verb, "MODE") == 0 && fields == 2 && arg1 >= 1 && arg1 <= 4)
+  {
+    forward_command(c, CMD_SET_MODE, arg1, 0);
+  }
+  else if (strcmp(verb, "RESET") == 0)
+  {
+    forward_command(c, CMD_RESET, 0, 0);
+  }
+  else if (strcmp(verb, "RUN") == 0 && fields == 2 && arg1 >= 1)
+  {
+    forward_command(c, CMD_RUN, arg1, 0);
+  }
+  else if (strcmp(verb, "EXIT") == 0)
+  {
+    forward_command(c, CMD_EXIT, 0, 0);
+  }
+  else if (strcmp(verb, "STATS") == 0)
+  {
+    // Answered from the published block, the data path is not involved
+    ControlStats s;
+    char text[256];
+    read_stats(&s);
+    snprintf(text, sizeof(text),
+             "STATS level=%d capacity=%d rate=%d base_rate=%d mode=%d "
+             "received=%d accepted=%d dropped=%d rate_changes=%d\n",
+             s.level, s.capacity, s.leak_rate, s.base_leak_rate, s.mode,
+             s.received, s.accepted, s.dropped, s.rate_changes);
+    send_text(fd, text);
+  }
+  else if (strcmp(verb, "QUIT") == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    send_text(fd, "ERR usage: ADD <size> [priority] | MODE <1-4> | RUN <test> | STATS | RESET | "
+                  "EXIT | QUIT\n");
+  }
+  return 1;
+}
+
+static void close_client(Client *c)
+{
+  close(c->fd);
+  c->used = 0;
+  c->pending_id = 0;
+}
+
+// Run every complete buffered line, stopping at one that waits for the
+// data path
+static void run_lines(Client *c)
+{
+  char *newline;
+  while (c->pending_id == 0 && (newline = strchr(c->buffer, '\n')) != NULL)
+  {
+    *newline = '\0';
+    int keep = handle_line(c, c->buffer);
+    memmove(c->buffer, newline + 1, strlen(newline + 1) + 1);
+    if (!keep)
+    {
+      close_client(c);
+      return;
+    }
+  }
+
+  // Overlong line without a newline: reject it
+  if (c->pending_id == 0 && strlen(c->buffer) == CLIENT_BUFFER_SIZE - 1)
+  {
+    send_text(c->fd, "ERR line too long\n");
+    c->buffer[0] = '\0';
+  }
+}
+
+// Read available bytes and run every complete line
+static void service_client(Client *c)
+{
+  size_t used = strlen(c->buffer);
+  ssize_t n = recv(c->fd, c->buffer + used, CLIENT_BUFFER_SIZE - 1 - used, 0);
+
+  if (n <= 0)
+  {
+    close_client(c);
+    return;
+  }
+  c->buffer[used + n] = '\0';
+  run_lines(c);
+}
+
+// Hand data path replies to the clients waiting for them and time out the
+// ones that waited too long
+static void deliver_replies()
+{
+  ControlReply reply;
+  long long now = now_ms();
+
+  while (pop_reply(&reply))
+  {
+    // Replies to commands that already timed out find no client
+    for (int i = 0; i < MAX_CLIENTS; i++)
+    {
+      Client *c = &clients[i];
+      if (c->used && c->pending_id == reply.id)
+      {
+        send_text(c->fd, reply.text);
+        send_text(c->fd, "\n");
+        c->pending_id = 0;
+        run_lines(c);
+        break;
+      }
+    }
+  }
+
+  for (int i = 0; i < MAX_CLIENTS; i++)
+  {
+    Client *c = &clients[i];
+    if (c->used && c->pending_id != 0 && now >= c->deadline)
+    {
+      send_text(c->fd, "ERR timeout\n");
+      c->pending_id = 0;
+      run_lines(c);
+    }
+  }
+}
+
+static void *control_loop(void *arg)
+{
+  (void)arg;
+  struct pollfd fds[MAX_CLIENTS + 1];
+
+  while (atomic_load(&control_running))
+  {
+    int nfds = 0;
+    int owner[MAX_CLIENTS + 1];
+    int waiting = 0;
+
+    deliver_replies();
+
+    fds[nfds].fd = listen_fd;
+    fds[nfds].events = POLLIN;
+    owner[nfds++] = -1;
+    for (int i = 0; i < MAX_CLIENTS; i++)
+    {
+      // A client waiting for a reply is not read until it has one
+      if (clients[i].used && clients[i].pending_id != 0)
+      {
+        waiting = 1;
+      }
+      else if (clients[i].used)
+      {
+        fds[nfds].fd = clients[i].fd;
+        fds[nfds].events = POLLIN;
+        owner[nfds++] = i;
+      }
+    }
+
+    // Replies come through a ring with no file descriptor, so check it
+    // every millisecond while any are due
+    if (poll(fds, nfds, waiting ? 1 : 200) <= 0)
+    {
+      continue;
+    }
+
+    for (int i = 1; i < nfds; i++)
+    {
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+      {
+        service_client(&clients[owner[i]]);
+      }
+    }
+
+    if (fds[0].revents & POLLIN)
+    {
+      int fd = accept(listen_fd, NULL, NULL);
+      if (fd >= 0)
+      {
+        int slot = -1;
+        for (int i = 0; i < MAX_CLIENTS && slot < 0; i++)
+        {
+          if (!clients[i].used)
+            slot = i;
+        }
+        if (slot < 0)
+        {
+          send_text(fd, "ERR too many clients\n");
+          close(fd);
+        }
+        else
+        {
+          clients[slot].fd = fd;
+          clients[slot].used = 1;
+          clients[slot].pending_id = 0;
+          clients[slot].buffer[0] = '\0';
+        }
+      }
+    }
+  }
+
+  // Answers posted just before control_stop(), such as the one to EXIT
+  deliver_replies();
+  for (int i = 0; i < MAX_CLIENTS; i++)
+  {
+    if (clients[i].used)
+      close_client(&clients[i]);
+  }
+  return NULL;
+}
+
+int control_start(const char *path)
+{
+  struct sockaddr_un addr;
+
+  if (atomic_load(&control_running) || strlen(path) >= sizeof(addr.sun_path))
+  {
+    return 0;
+  }
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+  {
+    return 0;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  strcpy(socket_path, path);
+  unlink(path);
+
+  if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(listen_fd, MAX_CLIENTS) < 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+    return 0;
+  }
+  fcntl(listen_fd, F_SETFL, O_NONBLOCK);
+
+  atomic_store(&control_running, 1);
+  if (pthread_create(&control_thread, NULL, control_loop, NULL) != 0)
+  {
+    atomic_store(&control_running, 0);
+    close(listen_fd);
+    unlink(path);
+    return 0;
+  }
+  return 1;
+}
+
+void control_stop(void)
+{
+  if (atomic_exchange(&control_running, 0))
+  {
+    pthread_join(control_thread, NULL);
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(socket_path);
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef CONTROL_PLANE_H
+#define CONTROL_PLANE_H
+
+// Control plane on a Unix domain socket.
+//
+// A background thread accepts clients and speaks a small line protocol:
+//
+//   ADD <size> [priority]   offer a packet to the bucket
+//   MODE <1-4>              set the leak mode (variable bucket only)
+//   RUN <test>              run one of the program's built-in tests
+//   STATS                   report level, rate and counters
+//   RESET                   empty the bucket and clear the counters
+//   EXIT                    stop the program
+//   QUIT                    close this connection
+//
+// The thread talks to the data path only through two single-producer
+// single-consumer rings (commands in, replies out) and a seqlock-published
+// stats block, so the data path never blocks on control traffic. Nor does
+// the thread block on the data path: a client waits for its own reply (or
+// "ERR timeout" after 2 s, though the command may still run later) while
+// other clients are served.
+
+#define CONTROL_SOCKET_PATH "/tmp/leaky-bucket.sock"
+#define CONTROL_MAILBOX_SIZE 256 // Must be a power of two
+
+// Commands forwarded to the data path
+#define CMD_ADD_PACKET 1
+#define CMD_SET_MODE 2
+#define CMD_RESET 3
+#define CMD_EXIT 4
+#define CMD_RUN 5
+
+typedef struct
+{
+  int type;
+  int id;   // Echoed back in the reply
+  int arg1; // Packet size, mode or test
+  int arg2; // Packet priority
+} ControlCommand;
+
+typedef struct
+{
+  int id;
+  char text[120];
+} ControlReply;
+
+// Snapshot of the data path state, published after each command
+typedef struct
+{
+  int level;
+  int capacity;
+  int leak_rate;
+  int base_leak_rate;
+  int mode; // 0 when the bucket has no leak modes
+  int received;
+  int accepted;
+  int dropped;
+  int rate_changes;
+} ControlStats;
+
+// Start/stop the socket thread, start returns 1 on success
+int control_start(const char *socket_path);
+void control_stop(void);
+
+// Data path side, none of these block
+int control_poll_command(ControlCommand *cmd);
+void control_reply(int id, const char *format, ...);
+void control_publish_stats(const ControlStats *stats);
+
+#endif
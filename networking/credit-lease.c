@@ -0,0 +1,392 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "credit-lease.h"
+
+#define LEASE_MAGIC 0x4C454153 // "LEAS"
+#define LEASE_STOP_TIMEOUT_MS 1000
+
+static long long now_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static double now_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Differs between processes (and between restarts of one), never 0
+static uint32_t process_nonce()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  uint64_t x = ((uint64_t)getpid() << 32) ^ (uint64_t)ts.tv_sec * 1000000007ULL ^ ts.tv_nsec;
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  return (uint32_t)x != 0 ? (uint32_t)x : 1;
+}
+
+static void send_msg(int sock, const struct sockaddr_in *to, int type, int node,
+                     uint32_t nonce, uint32_t seq, int64_t amount)
+{
+  LeaseMsg msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.magic = LEASE_MAGIC;
+  msg.type = type;
+  msg.node = node;
+  msg.nonce = nonce;
+  msg.seq = seq;
+  msg.amount = amount;
+  sendto(sock, &msg, sizeof(msg), 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+static int resolve(struct sockaddr_in *addr, const char *host, int port)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(port);
+  return inet_pton(AF_INET, host, &addr->sin_addr) == 1;
+}
+
+// ---------- Coordinator ----------
+
+int lease_coordinator_init(LeaseCoordinator *co, const char *addr_text, int port, double rate,
+                           double burst)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+
+  memset(co, 0, sizeof(*co));
+  co->rate = rate;
+  co->burst = burst;
+
+  if (addr_text == NULL)
+  {
+    addr_text = LEASE_DEFAULT_ADDR;
+  }
+  if (!resolve(&addr, addr_text, port))
+  {
+    fprintf(stderr, "Bad bind address %s\n", addr_text);
+    return 0;
+  }
+  co->sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (co->sock < 0)
+  {
+    perror("socket");
+    return 0;
+  }
+  if (bind(co->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    perror("bind");
+    close(co->sock);
+    return 0;
+  }
+
+  // Port 0 picks a free one, report which
+  getsockname(co->sock, (struct sockaddr *)&addr, &len);
+  co->port = ntohs(addr.sin_port);
+  return 1;
+}
+
+void lease_coordinator_run(LeaseCoordinator *co)
+{
+  double tokens = co->burst;
+  double last_refill = 0; // The bucket starts full when the first node asks
+
+  memset(co->last_nonce, 0, sizeof(co->last_nonce));
+  memset(co->last_seq, 0, sizeof(co->last_seq));
+
+  while (1)
+  {
+    LeaseMsg msg;
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    ssize_t n = recvfrom(co->sock, &msg, sizeof(msg), 0, (struct sockaddr *)&from, &from_len);
+
+    if (n != sizeof(msg) || msg.magic != LEASE_MAGIC || msg.node >= LEASE_MAX_NODES)
+    {
+      continue;
+    }
+    if (msg.type == LEASE_SHUTDOWN)
+    {
+      // Anyone can send a datagram, only a process on this host may stop us
+      if ((ntohl(from.sin_addr.s_addr) >> 24) == 127)
+      {
+        return;
+      }
+      continue;
+    }
+    if (msg.type != LEASE_REQUEST && msg.type != LEASE_RETURN)
+    {
+      continue;
+    }
+
+    LeaseMsg *reply = &co->last_reply[msg.node];
+    if (msg.nonce != co->last_nonce[msg.node] || msg.seq != co->last_seq[msg.node])
+    {
+      double now = now_seconds();
+      if (last_refill == 0)
+      {
+        last_refill = now;
+      }
+      tokens += (now - last_refill) * co->rate;
+      if (tokens > co->burst)
+      {
+        tokens = co->burst;
+      }
+      last_refill = now;
+
+      int64_t amount;
+      if (msg.type == LEASE_REQUEST)
+      {
+        // Grant what is there, possibly less than asked or nothing
+        amount = msg.amount < (int64_t)tokens ? msg.amount : (int64_t)tokens;
+        if (amount < 0)
+        {
+          amount = 0;
+        }
+        tokens -= amount;
+        co->granted += amount;
+        co->requests++;
+      }
+      else
+      {
+        // Returned credit goes back in the bucket (up to burst)
+        amount = msg.amount > 0 ? msg.amount : 0;
+        tokens += amount;
+        if (tokens > co->burst)
+        {
+          tokens = co->burst;
+        }
+        co->returned += amount;
+      }
+
+      co->last_nonce[msg.node] = msg.nonce;
+      co->last_seq[msg.node] = msg.seq;
+      memset(reply, 0, sizeof(*reply));
+      reply->magic = LEASE_MAGIC;
+      reply->type = msg.type == LEASE_REQUEST ? LEASE_GRANT : LEASE_RETURN_ACK;
+      reply->node = msg.node;
+      reply->nonce = msg.nonce;
+      reply->seq = msg.seq;
+      reply->amount = amount;
+    }
+    sendto(co->sock, reply, sizeof(*reply), 0, (struct sockaddr *)&from, from_len);
+  }
+}
+
+void lease_coordinator_close(LeaseCoordinator *co)
+{
+  close(co->sock);
+  co->sock = -1;
+}
+
+// ---------- Node ----------
+
+// Send (or resend) the one message this node has in flight
+static void send_pending(LeaseNode *node, long long now)
+{
+  send_msg(node->sock, &node->coordinator, node->pending_type, node->node_id,
+           node->nonce, node->seq, node->pending_amount);
+  node->pending_sent = now;
+}
+
+static void start_pending(LeaseNode *node, int type, int64_t amount, long long now)
+{
+  node->seq++;
+  node->pending = 1;
+  node->pending_type = type;
+  node->pending_amount = amount;
+  send_pending(node, now);
+}
+
+static void handle_reply(LeaseNode *node, const LeaseMsg *msg, long long now)
+{
+  if (!node->pending || msg->magic != LEASE_MAGIC || msg->nonce != node->nonce ||
+      msg->seq != node->seq)
+  {
+    return; // Stale duplicate
+  }
+
+  if (msg->type == LEASE_GRANT && node->pending_type == LEASE_REQUEST)
+  {
+    atomic_fetch_add_explicit(&node->credit, msg->amount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&node->granted, msg->amount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&node->leases, 1, memory_order_relaxed);
+    if (msg->amount < node->chunk / 2)
+    {
+      // The coordinator is short, let tokens build up before asking again
+      node->retry_at = now + LEASE_BACKOFF_MS;
+    }
+    node->pending = 0;
+  }
+  else if (msg->type == LEASE_RETURN_ACK && node->pending_type == LEASE_RETURN)
+  {
+    atomic_fetch_add_explicit(&node->returned, node->pending_amount, memory_order_relaxed);
+    node->pending = 0;
+  }
+}
+
+// Lease thread: keeps credit topped up while there is demand and gives it
+// back when there is none. Admission never waits for it.
+static void *lease_thread(void *arg)
+{
+  LeaseNode *node = arg;
+  long long idle_check = now_ms() + LEASE_IDLE_MS;
+  long long stop_deadline = 0;
+
+  while (1)
+  {
+    long long now = now_ms();
+    int stopping = !atomic_load(&node->running);
+
+    if (stopping && stop_deadline == 0)
+    {
+      stop_deadline = now + LEASE_STOP_TIMEOUT_MS;
+    }
+    if (stopping && now >= stop_deadline)
+    {
+      fprintf(stderr, "node %d: coordinator did not answer, giving up\n", node->node_id);
+      break;
+    }
+
+    if (node->pending)
+    {
+      if (now - node->pending_sent >= LEASE_RETRY_MS)
+      {
+        send_pending(node, now);
+      }
+    }
+    else
+    {
+      int idle = 0;
+      if (now >= idle_check)
+      {
+        // Admission sets active; nobody asked for credit in a whole period
+        idle = !atomic_exchange(&node->active, 0);
+        idle_check = now + LEASE_IDLE_MS;
+      }
+
+      if (stopping || idle)
+      {
+        int64_t unused = atomic_exchange(&node->credit, 0);
+        if (unused > 0)
+        {
+          start_pending(node, LEASE_RETURN, unused, now);
+        }
+        else if (stopping)
+        {
+          break;
+        }
+      }
+      else if (atomic_load_explicit(&node->active, memory_order_relaxed) &&
+               atomic_load_explicit(&node->credit, memory_order_relaxed) <= node->chunk / 2 &&
+               now >= node->retry_at)
+      {
+        start_pending(node, LEASE_REQUEST, node->chunk, now);
+      }
+    }
+
+    struct pollfd pfd = {node->sock, POLLIN, 0};
+    if (poll(&pfd, 1, 1) > 0)
+    {
+      LeaseMsg msg;
+      while (recv(node->sock, &msg, sizeof(msg), MSG_DONTWAIT) == sizeof(msg))
+      {
+        handle_reply(node, &msg, now_ms());
+      }
+    }
+  }
+  return NULL;
+}
+
+int lease_node_start(LeaseNode *node, const char *host, int port, int node_id,
+                     int64_t chunk)
+{
+  memset(node, 0, sizeof(*node));
+  if (node_id < 0 || node_id >= LEASE_MAX_NODES || chunk < 1)
+  {
+    fprintf(stderr, "node id must be 0..%d and chunk at least 1\n", LEASE_MAX_NODES - 1);
+    return 0;
+  }
+  if (!resolve(&node->coordinator, host, port))
+  {
+    fprintf(stderr, "Bad coordinator address %s\n", host);
+    return 0;
+  }
+
+  node->sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (node->sock < 0)
+  {
+    perror("socket");
+    return 0;
+  }
+  node->node_id = node_id;
+  node->chunk = chunk;
+  node->nonce = process_nonce();
+  atomic_init(&node->credit, 0);
+  atomic_init(&node->active, 1); // Lease right away
+  atomic_init(&node->running, 1);
+
+  if (pthread_create(&node->thread, NULL, lease_thread, node) != 0)
+  {
+    close(node->sock);
+    return 0;
+  }
+  return 1;
+}
+
+int lease_admit(LeaseNode *node, int64_t size)
+{
+  // Mark demand, without writing the shared line on every call
+  if (!atomic_load_explicit(&node->active, memory_order_relaxed))
+  {
+    atomic_store_explicit(&node->active, 1, memory_order_relaxed);
+  }
+
+  int64_t credit = atomic_load_explicit(&node->credit, memory_order_relaxed);
+  while (credit >= size)
+  {
+    if (atomic_compare_exchange_weak_explicit(&node->credit, &credit, credit - size,
+                                              memory_order_relaxed, memory_order_relaxed))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void lease_node_stop(LeaseNode *node)
+{
+  atomic_store(&node->running, 0);
+  pthread_join(node->thread, NULL);
+  close(node->sock);
+}
+
+void lease_send_shutdown(const char *host, int port)
+{
+  struct sockaddr_in addr;
+
+  if (!resolve(&addr, host, port))
+  {
+    return;
+  }
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0)
+  {
+    return;
+  }
+  send_msg(sock, &addr, LEASE_SHUTDOWN, 0, 0, 0, 0);
+  close(sock);
+}
@@ -0,0 +1,124 @@
+#ifndef CREDIT_LEASE_H
+#define CREDIT_LEASE_H
+
+// Cluster-wide rate limiting by leasing credit from a coordinator.
+//
+// The coordinator owns the global quota as one token bucket (rate tokens
+// per second, up to burst). Every node keeps a local credit counter and
+// admits packets against it with a single atomic compare-and-swap; no
+// network round trip and no lock on the admission path. A background
+// thread on each node leases another chunk over UDP when the counter runs
+// low and hands unused credit back after an idle period or on shutdown.
+//
+// At most one chunk per node is outstanding, so the global rate can be
+// overshot by at most burst + nodes * chunk: pick chunk from the error you
+// can accept. Requests and returns carry sequence numbers and are resent
+// until answered, so lost or duplicated datagrams are harmless. Sequence
+// numbers restart with the process, so every node process also picks a
+// random nonce; a restarted node with the same id is never mistaken for a
+// retransmission of its predecessor.
+
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define LEASE_MAX_NODES 256
+#define LEASE_RETRY_MS 20    // Resend an unanswered request after this long
+#define LEASE_IDLE_MS 200    // Return credit nobody has used for this long
+#define LEASE_BACKOFF_MS 1   // Wait after a short grant before asking again
+
+// Message types
+#define LEASE_REQUEST 1
+#define LEASE_GRANT 2
+#define LEASE_RETURN 3
+#define LEASE_RETURN_ACK 4
+#define LEASE_SHUTDOWN 5 // Stop the coordinator, only honored from loopback
+
+#define LEASE_DEFAULT_ADDR "127.0.0.1" // Coordinator bind address
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t type;
+  uint16_t node;
+  uint32_t seq;
+  uint32_t nonce;  // Per node process, never 0
+  int64_t amount; // Requested, granted or returned credit
+} LeaseMsg;
+
+// ---------- Coordinator ----------
+
+typedef struct
+{
+  double rate;   // Tokens per second for the whole cluster
+  double burst;  // Bucket depth
+  int sock;
+  int port;      // Bound port (useful when 0 was asked for)
+
+  // Last message seen from every node and the reply sent to it, so a
+  // retransmitted request is answered again instead of granted twice. The
+  // nonce tells a restarted node process apart from the one before it.
+  uint32_t last_nonce[LEASE_MAX_NODES];
+  uint32_t last_seq[LEASE_MAX_NODES];
+  LeaseMsg last_reply[LEASE_MAX_NODES];
+
+  // Totals, printed when the coordinator stops
+  long long granted;
+  long long returned;
+  unsigned long requests;
+} LeaseCoordinator;
+
+// Bind a UDP socket on addr (NULL = LEASE_DEFAULT_ADDR) and port (0 = any
+// free port), returns 0 on error. Nodes on other hosts need an address
+// they can reach, such as "0.0.0.0".
+int lease_coordinator_init(LeaseCoordinator *co, const char *addr, int port, double rate,
+                           double burst);
+
+// Serve until a LEASE_SHUTDOWN message arrives from a loopback address
+void lease_coordinator_run(LeaseCoordinator *co);
+void lease_coordinator_close(LeaseCoordinator *co);
+
+// ---------- Node ----------
+
+typedef struct
+{
+  _Atomic int64_t credit;   // Local credit, the only thing admission touches
+  atomic_int active;        // Set by admission, cleared by the lease thread
+  int64_t chunk;            // Credit asked for per lease
+  int node_id;
+
+  int sock;
+  struct sockaddr_in coordinator;
+  pthread_t thread;
+  atomic_int running;
+
+  // Lease thread state
+  uint32_t nonce;
+  uint32_t seq;
+  int pending;              // Waiting for a grant or return ack
+  int pending_type;
+  int64_t pending_amount;
+  long long pending_sent;   // When the pending message was last sent
+  long long retry_at;       // Earliest time for the next request
+
+  // Counters
+  atomic_ullong leases;
+  atomic_llong granted;
+  atomic_llong returned;
+} LeaseNode;
+
+// Connect to a coordinator and start the lease thread, returns 0 on error
+int lease_node_start(LeaseNode *node, const char *host, int port, int node_id,
+                     int64_t chunk);
+
+// Admit size units of traffic, returns 1 if there was credit. Lock-free.
+int lease_admit(LeaseNode *node, int64_t size);
+
+// Return all unused credit to the coordinator and stop the thread
+void lease_node_stop(LeaseNode *node);
+
+// Ask a coordinator on this host to shut down (tests and scripts)
+void lease_send_shutdown(const char *host, int port);
+
+#endif
@@ -1,30 +1,132 @@
+// Build: gcc fixed-leaky-bucket.c bucket-config.c rate-schedule.c control-plane.c -o fixed-leaky-bucket -pthread
+// Usage: ./fixed-leaky-bucket [config-file]
+//        then send commands on the control socket (see control-plane.h):
+//        socat - UNIX-CONNECT:/tmp/leaky-bucket.sock
+//
+// To run on the templated C++ core instead of the arithmetic below:
+//   g++ -O2 -std=c++17 -c leaky-bucket-shim.cpp
+//   gcc -DUSE_CXX_CORE fixed-leaky-bucket.c bucket-config.c rate-schedule.c control-plane.c
+//       leaky-bucket-shim.o -o fixed-leaky-bucket -pthread -lstdc++
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "bucket-config.h"
+#include "control-plane.h"
+#include "gcra.h"
+#include "probes.h"
+#ifdef USE_CXX_CORE
+#include "leaky-bucket-shim.h"
+#endif
+
 // Global variables for leaky bucket
 int bucket_capacity = 20; // Maximum bucket capacity
 int current_level = 0;    // Current water level in bucket
 int leak_rate = 3;        // Rate at which bucket leaks (packets per second)
 time_t last_leak_time;    // Last time the bucket leaked
 
-// Initialize the leaky bucket
-void initialize_bucket(int capacity, int rate)
+// GCRA mode: the whole bucket state is one theoretical arrival time
+int use_gcra = 0;
+int64_t tat = 0; // In packet slots, see gcra.h
+
+// Hot-reloaded configuration
+unsigned long applied_generation = 0; // Config generation currently in use
+int config_reader = -1;               // Grace period slot of this thread
+
+#ifdef USE_CXX_CORE
+lb_bucket *core = NULL; // Templated core, the globals above mirror its state
+#endif
+
+// Initialize the leaky bucket, returns 0 if out of memory
+int initialize_bucket(int capacity, int rate)
 {
   bucket_capacity = capacity;
   current_level = 0;
   leak_rate = rate;
   last_leak_time = time(NULL);
 
+#ifdef USE_CXX_CORE
+  lb_destroy(core);
+  core = lb_create(capacity, rate, 0);
+  if (core == NULL)
+  {
+    printf("Could not create the leaky bucket\n");
+    return 0;
+  }
+#endif
+
   printf("Leaky Bucket initialized:\n");
   printf("- Capacity: %d packets\n", capacity);
   printf("- Leak Rate: %d packets/second\n", rate);
   printf("- Initial Level: %d packets\n\n", current_level);
+  return 1;
+}
+
+// Pick up a reloaded configuration (one atomic load, never blocks)
+void apply_config()
+{
+  const BucketConfig *cfg = config_current();
+
+  if (cfg != NULL && cfg->generation != applied_generation)
+  {
+    // Slot length depends on the rate, so re-express the level in new slots
+    if (use_gcra)
+    {
+      int level = gcra_level(tat, gcra_now(time(NULL), leak_rate));
+      tat = gcra_from_level(level, gcra_now(time(NULL), cfg->leak_rate));
+    }
+
+    if (cfg->leak_rate != leak_rate)
+    {
+      PROBE_RATE_CHANGE(leak_rate, cfg->leak_rate, 0);
+    }
+    bucket_capacity = cfg->capacity;
+    leak_rate = cfg->leak_rate;
+    applied_generation = cfg->generation;
+#ifdef USE_CXX_CORE
+    lb_set_params(core, bucket_capacity, leak_rate);
+#endif
+    printf("CONFIG: Capacity %d packets, leak rate %d packets/second\n",
+           bucket_capacity, leak_rate);
+  }
+
+  // Done with the snapshot, the old one may now be freed
+  config_reader_quiescent(config_reader);
 }
 
 // Simulate the leaking process
 void leak_bucket()
 {
+  apply_config();
+
+  if (use_gcra)
+  {
+    // Nothing to update, the level is implied by the TAT
+    int new_level = gcra_level(tat, gcra_now(time(NULL), leak_rate));
+    if (new_level < current_level)
+    {
+      PROBE_LEAK(current_level - new_level, new_level, leak_rate);
+      printf("Leaked %d packets. Current level: %d/%d\n",
+             current_level - new_level, new_level, bucket_capacity);
+    }
+    current_level = new_level;
+    return;
+  }
+
+#ifdef USE_CXX_CORE
+  int packets_to_leak = lb_leak(core);
+  current_level = lb_level(core);
+
+  if (packets_to_leak > 0)
+  {
+    last_leak_time = time(NULL);
+    PROBE_LEAK(packets_to_leak, current_level, leak_rate);
+    printf("Leaked %d packets. Current level: %d/%d\n",
+           packets_to_leak, current_level, bucket_capacity);
+  }
+#else
   time_t current_time = time(NULL);
   int time_elapsed = current_time - last_leak_time;
 
@@ -43,10 +145,23 @@ void leak_bucket()
 
     if (packets_to_leak > 0)
     {
+      PROBE_LEAK(packets_to_leak, current_level, leak_rate);
       printf("Leaked %d packets. Current level: %d/%d\n",
              packets_to_leak, current_level, bucket_capacity);
     }
   }
+#endif
+}
+
+// Empty the bucket and restart the leak clock
+void reset_bucket()
+{
+  current_level = 0;
+  last_leak_time = time(NULL);
+  tat = 0;
+#ifdef USE_CXX_CORE
+  lb_reset(core);
+#endif
 }
 
 // Add a packet to the bucket
@@ -58,15 +173,37 @@ int add_packet(int packet_size)
   printf("Attempting to add packet of size %d...\n", packet_size);
 
   // Check if packet can fit in bucket
-  if (current_level + packet_size <= bucket_capacity)
+  int fits;
+  if (use_gcra)
+  {
+    int64_t now = gcra_now(time(NULL), leak_rate);
+    fits = gcra_admit(&tat, now, packet_size, bucket_capacity);
+    current_level = gcra_level(tat, now);
+  }
+  else
+  {
+#ifdef USE_CXX_CORE
+    fits = lb_add_packet(core, packet_size, LB_PRIORITY_NORMAL);
+    current_level = lb_level(core);
+#else
+    fits = current_level + packet_size <= bucket_capacity;
+    if (fits)
+    {
+      current_level += packet_size;
+    }
+#endif
+  }
+
+  if (fits)
   {
-    current_level += packet_size;
+    PROBE_ACCEPT(0, packet_size, current_level, leak_rate);
     printf("✓ Packet accepted. Current level: %d/%d\n",
            current_level, bucket_capacity);
     return 1; // Success
   }
   else
   {
+    PROBE_DROP(0, packet_size, current_level, leak_rate, DROP_OVERFLOW);
     printf("✗ Packet dropped! Bucket overflow. Current level: %d/%d\n",
            current_level, bucket_capacity);
     return 0; // Failure - packet dropped
@@ -148,53 +285,6 @@ void simulate_basic_traffic()
   printf("Drop Rate: %.2f%%\n", (float)dropped / total * 100);
 }
 
-// Interactive simulation
-void interactive_simulation()
-{
-  printf("\n=== Interactive Mode ===\n");
-  printf("Enter packet sizes (0 to exit):\n");
-
-  int packet_size;
-  int accepted = 0, dropped = 0, total = 0;
-
-  while (1)
-  {
-    printf("\nEnter packet size: ");
-    scanf("%d", &packet_size);
-
-    if (packet_size <= 0)
-    {
-      break;
-    }
-
-    printf("\n--- Processing packet of size %d ---\n", packet_size);
-
-    if (add_packet(packet_size))
-    {
-      accepted++;
-    }
-    else
-    {
-      dropped++;
-    }
-    total++;
-
-    print_status();
-
-    // Simulate 1 second processing time
-    sleep(1);
-  }
-
-  if (total > 0)
-  {
-    printf("\n=== Interactive Session Results ===\n");
-    printf("Total Packets: %d\n", total);
-    printf("Packets Accepted: %d\n", accepted);
-    printf("Packets Dropped: %d\n", dropped);
-    printf("Drop Rate: %.2f%%\n", (float)dropped / total * 100);
-  }
-}
-
 // Burst traffic test
 void test_burst_traffic()
 {
@@ -240,8 +330,7 @@ void demonstrate_rate_limiting()
   printf("\n=== Rate Limiting Demonstration ===\n");
 
   // Reset bucket
-  current_level = 0;
-  last_leak_time = time(NULL);
+  reset_bucket();
 
   printf("Sending packets at different rates...\n");
 
@@ -268,53 +357,303 @@ void demonstrate_rate_limiting()
   }
 }
 
-int main()
+#ifdef USE_CXX_CORE
+// Color packets instead of accepting or dropping them (RFC 2697/2698).
+// Rates and bursts are the bucket's, read as bytes: committed rate =
+// leak_rate, committed burst = capacity, peak/excess twice that.
+void demonstrate_color_marking()
 {
-  printf("=== Leaky Bucket Algorithm (Simple Version) ===\n\n");
+  const char *names[] = {"GREEN", "YELLOW", "RED"};
+  lb_marker *sr = lb_srtcm_create(leak_rate, bucket_capacity, 2 * bucket_capacity);
+  lb_marker *tr = lb_trtcm_create(leak_rate, bucket_capacity, 2 * leak_rate,
+                                  2 * bucket_capacity);
+  int sizes[] = {5, 8, 6, 10, 4, 12, 3, 7, 9, 6};
+  int num_packets = sizeof(sizes) / sizeof(sizes[0]);
+
+  printf("\n=== Three-Color Marking ===\n");
+  printf("srTCM: CIR %d, CBS %d, EBS %d\n", leak_rate, bucket_capacity, 2 * bucket_capacity);
+  printf("trTCM: CIR %d, CBS %d, PIR %d, PBS %d\n", leak_rate, bucket_capacity,
+         2 * leak_rate, 2 * bucket_capacity);
+
+  for (int i = 0; i < num_packets; i++)
+  {
+    int sr_color = lb_mark(sr, sizes[i], LB_GREEN);
+    int tr_color = lb_mark(tr, sizes[i], LB_GREEN);
+    printf("Packet %2d (size %2d): srTCM %-6s  trTCM %-6s\n", i + 1, sizes[i],
+           names[sr_color], names[tr_color]);
+    usleep(500000);
+  }
+
+  lb_marker_destroy(sr);
+  lb_marker_destroy(tr);
+}
+#endif
+
+// Reference level-tracking step, same arithmetic as leak_bucket()/add_packet()
+static int level_step(int *level, time_t *last, time_t now, int size)
+{
+  int elapsed = now - *last;
+  if (elapsed > 0)
+  {
+    int packets_to_leak = elapsed * leak_rate;
+    if (packets_to_leak > *level)
+      packets_to_leak = *level;
+    *level -= packets_to_leak;
+    *last = now;
+  }
+
+  if (size <= 0) // Status check only
+    return 1;
+  if (*level + size <= bucket_capacity)
+  {
+    *level += size;
+    return 1;
+  }
+  return 0;
+}
+
+// Replay one packet sequence through both forms in virtual time.
+// gaps_ms[i] is the delay before packet i, a size of 0 is a status check.
+static int replay_sequence(const char *name, const int *sizes, const int *gaps_ms,
+                           int count)
+{
+  int mismatches = 0;
+
+  // time(NULL) has one second resolution, so try every sub-second phase
+  for (int phase = 0; phase < 1000; phase += 50)
+  {
+    int level = 0;
+    time_t last = 1700000000;
+    int64_t gcra_tat = 0;
+    long ms = phase;
+
+    for (int i = 0; i < count; i++)
+    {
+      ms += gaps_ms[i];
+      time_t now = 1700000000 + ms / 1000;
+      int64_t slots = gcra_now(now, leak_rate);
+
+      int expected = level_step(&level, &last, now, sizes[i]);
+      int got = sizes[i] > 0
+                    ? gcra_admit(&gcra_tat, slots, sizes[i], bucket_capacity)
+                    : 1;
+
+      if (expected != got || level != gcra_level(gcra_tat, slots))
+      {
+        mismatches++;
+      }
+    }
+  }
+
+  printf("%-22s %3d packets x 20 phases: %s\n", name, count,
+         mismatches == 0 ? "identical" : "MISMATCH");
+  return mismatches;
+}
+
+// Check GCRA against level tracking on the test sequences above
+void verify_gcra()
+{
+  printf("\n=== GCRA Equivalence Check ===\n");
+  printf("Capacity %d, leak rate %d packets/second\n\n",
+         bucket_capacity, leak_rate);
+
+  int mismatches = 0;
+
+  // simulate_basic_traffic(): packet, status, 1s sleep
+  int basic_sizes[] = {5, 0, 3, 0, 8, 0, 12, 0, 7, 0};
+  int basic_gaps[] = {0, 0, 1000, 0, 1000, 0, 1000, 0, 1000, 0};
+  mismatches += replay_sequence("Basic traffic", basic_sizes, basic_gaps, 10);
+
+  // test_burst_traffic(): five size-10 packets 0.5s apart, then 3s recovery
+  int burst_sizes[] = {10, 0, 10, 0, 10, 0, 10, 0, 10, 0, 0};
+  int burst_gaps[] = {0, 0, 500, 0, 500, 0, 500, 0, 500, 0, 3500};
+  mismatches += replay_sequence("Burst traffic", burst_sizes, burst_gaps, 11);
+
+  // demonstrate_rate_limiting(): slow 2s sends, then fast 0.5s sends
+  int rate_sizes[] = {5, 0, 5, 0, 5, 0, 8, 0, 8, 0, 8, 0};
+  int rate_gaps[] = {0, 0, 2000, 0, 2000, 0, 2000, 0, 500, 0, 500, 0};
+  mismatches += replay_sequence("Rate limiting", rate_sizes, rate_gaps, 12);
+
+  // Random traffic around the leak rate
+  enum { RANDOM_PACKETS = 10000 };
+  static int random_sizes[RANDOM_PACKETS];
+  static int random_gaps[RANDOM_PACKETS];
+  srand(42);
+  for (int i = 0; i < RANDOM_PACKETS; i++)
+  {
+    random_sizes[i] = rand() % 13;
+    random_gaps[i] = rand() % 1500;
+  }
+  mismatches += replay_sequence("Random traffic", random_sizes, random_gaps,
+                                RANDOM_PACKETS);
+
+  printf("\nResult: %s\n", mismatches == 0
+                                ? "GCRA reproduces every accept/drop decision"
+                                : "GCRA and level tracking disagree!");
+}
+
+// Every test in sequence
+void run_all_tests()
+{
+  simulate_basic_traffic();
+  test_burst_traffic();
+  demonstrate_rate_limiting();
+}
+
+// The same tests with GCRA in place of level tracking
+void run_all_tests_gcra()
+{
+  use_gcra = 1;
+  reset_bucket();
+  run_all_tests();
+  use_gcra = 0;
+  reset_bucket();
+}
+
+// Built-in tests, started with RUN <n> on the control socket
+typedef struct
+{
+  const char *name;
+  void (*run)();
+} Test;
+
+static const Test tests[] = {
+    {"Basic automatic simulation", simulate_basic_traffic},
+    {"Burst traffic test", test_burst_traffic},
+    {"Rate limiting demonstration", demonstrate_rate_limiting},
+    {"Run all tests", run_all_tests},
+    {"Run all tests in GCRA mode", run_all_tests_gcra},
+    {"Verify GCRA against level tracking", verify_gcra},
+#ifdef USE_CXX_CORE
+    {"Three-color marking (srTCM/trTCM)", demonstrate_color_marking},
+#endif
+};
+
+#define NUM_TESTS (int)(sizeof(tests) / sizeof(tests[0]))
+
+// Serve the control socket until EXIT. Packets and tests arrive without
+// scanf, so nothing here waits on a human.
+void run_control_mode()
+{
+  ControlCommand cmd;
+  ControlStats stats = {0};
+  int running = 1;
 
-  // Initialize bucket with capacity 20 and leak rate 3 packets/second
-  initialize_bucket(20, 3);
+  printf("Control socket on %s, send RUN <n> for a test or EXIT to stop:\n",
+         CONTROL_SOCKET_PATH);
+  for (int i = 0; i < NUM_TESTS; i++)
+  {
+    printf("%d. %s\n", i + 1, tests[i].name);
+  }
+
+  while (running)
+  {
+    // Publish state for STATS queries, answered by the control thread
+    stats.level = current_level;
+    stats.capacity = bucket_capacity;
+    stats.leak_rate = leak_rate;
+    stats.base_leak_rate = leak_rate;
+    control_publish_stats(&stats);
+
+    // Commands arrive through a lock-free mailbox, idle briefly when empty
+    if (!control_poll_command(&cmd))
+    {
+      config_reader_quiescent(config_reader);
+      usleep(1000);
+      continue;
+    }
 
-  int choice;
+    switch (cmd.type)
+    {
+    case CMD_ADD_PACKET:
+      stats.received++;
+      if (add_packet(cmd.arg1))
+      {
+        stats.accepted++;
+        control_reply(cmd.id, "ACCEPTED level=%d/%d", current_level, bucket_capacity);
+      }
+      else
+      {
+        stats.dropped++;
+        control_reply(cmd.id, "DROPPED level=%d/%d", current_level, bucket_capacity);
+      }
+      break;
 
-  printf("Choose simulation mode:\n");
-  printf("1. Basic automatic simulation\n");
-  printf("2. Interactive mode\n");
-  printf("3. Burst traffic test\n");
-  printf("4. Rate limiting demonstration\n");
-  printf("5. Run all tests\n");
-  printf("Enter choice (1-5): ");
-  scanf("%d", &choice);
+    case CMD_SET_MODE:
+      control_reply(cmd.id, "ERR fixed bucket has no leak modes");
+      break;
+
+    case CMD_RUN:
+      if (cmd.arg1 > NUM_TESTS)
+      {
+        control_reply(cmd.id, "ERR tests are 1-%d", NUM_TESTS);
+        break;
+      }
+      // Tests take seconds, answer before starting one
+      control_reply(cmd.id, "OK running %s", tests[cmd.arg1 - 1].name);
+      printf("\n");
+      tests[cmd.arg1 - 1].run();
+      break;
+
+    case CMD_RESET:
+      reset_bucket();
+      stats.received = stats.accepted = stats.dropped = 0;
+      printf("Bucket reset\n");
+      control_reply(cmd.id, "OK reset");
+      break;
+
+    case CMD_EXIT:
+      control_reply(cmd.id, "OK exiting");
+      running = 0;
+      break;
+    }
+  }
+}
 
-  switch (choice)
+int main(int argc, char *argv[])
+{
+  printf("=== Leaky Bucket Algorithm (Simple Version) ===\n\n");
+
+  // Load parameters from a config file and watch it for changes
+  config_reader = config_reader_register();
+  int created;
+  if (argc > 1 && config_load(argv[1]))
+  {
+    const BucketConfig *cfg = config_current();
+    created = initialize_bucket(cfg->capacity, cfg->leak_rate);
+    applied_generation = cfg->generation;
+    config_watch_start(argv[1]);
+  }
+  else
+  {
+    // Initialize bucket with capacity 20 and leak rate 3 packets/second
+    created = initialize_bucket(20, 3);
+  }
+
+  int status = 0;
+  if (!created)
   {
-  case 1:
-    simulate_basic_traffic();
-    break;
-
-  case 2:
-    interactive_simulation();
-    break;
-
-  case 3:
-    test_burst_traffic();
-    break;
-
-  case 4:
-    demonstrate_rate_limiting();
-    break;
-
-  case 5:
-    simulate_basic_traffic();
-    test_burst_traffic();
-    demonstrate_rate_limiting();
-    break;
-
-  default:
-    printf("Invalid choice. Running basic simulation...\n");
-    simulate_basic_traffic();
+    status = 1;
+  }
+  else if (control_start(CONTROL_SOCKET_PATH))
+  {
+    run_control_mode();
+    control_stop();
+  }
+  else
+  {
+    printf("Could not open control socket %s\n", CONTROL_SOCKET_PATH);
+    status = 1;
   }
 
+  // Stop reading before the watcher can wait on us
+  config_reader_unregister(config_reader);
+  config_watch_stop();
+
+#ifdef USE_CXX_CORE
+  lb_destroy(core);
+#endif
+
   printf("\n=== Program finished ===\n");
-  return 0;
-}
\ No newline at end of file
+  return status;
+}
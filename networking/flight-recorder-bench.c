@@ -0,0 +1,179 @@
+// Build: gcc -O2 flight-recorder-bench.c flight-recorder.c -o flight-recorder-bench -pthread -lm
+// Usage: ./flight-recorder-bench [hours-of-virtual-time] [file-megabytes]
+//
+// Records the adaptive bucket of variable-leaky-bucket.c, simulated with
+// 1 ms steps under a slowly swinging bursty load, sampling every step. Then
+// prints the producer cost per sample, the compressed size per sample and
+// how many hours of 1 kHz history fit in the file, and reads the file back
+// to check every sample that survived against what was recorded.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "flight-recorder.h"
+
+#define STEP_US 1000
+#define CAPACITY 1000
+#define BASE_RATE 3000 // Packets per second
+#define START_US 1700000000000000LL
+#define BENCH_FILE "flight-recorder-bench.rec"
+
+static double now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint32_t sample_hash(const RecorderSample *s)
+{
+  uint64_t h = (uint64_t)s->time_us * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)(uint32_t)s->level * 0xC2B2AE3D27D4EB4FULL;
+  h ^= (uint64_t)(uint32_t)s->rate * 0x165667B19E3779F9ULL;
+  h ^= (uint64_t)s->accepted * 0xD6E8FEB86659FD93ULL;
+  h ^= (uint64_t)s->dropped * 0xFF51AFD7ED558CCDULL;
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+// Same thresholds as adaptive_leak_rate()
+static int adaptive_rate(int level)
+{
+  float fill = (float)level / CAPACITY;
+  if (fill > 0.8)
+    return BASE_RATE * 3;
+  if (fill > 0.6)
+    return BASE_RATE * 2;
+  if (fill > 0.4)
+    return (int)(BASE_RATE * 1.5);
+  if (fill < 0.2)
+    return (int)(BASE_RATE * 0.7);
+  return BASE_RATE;
+}
+
+typedef struct
+{
+  const uint32_t *hashes;
+  long steps;
+  long matched;
+  long mismatched;
+  int64_t oldest_us;
+} CheckState;
+
+static void check_sample(void *arg, int thread, const RecorderSample *s)
+{
+  CheckState *check = arg;
+  long i = (s->time_us - START_US) / STEP_US;
+  (void)thread;
+
+  if (i < 0 || i >= check->steps || check->hashes[i] != sample_hash(s))
+  {
+    check->mismatched++;
+    return;
+  }
+  if (check->matched++ == 0 || s->time_us < check->oldest_us)
+  {
+    check->oldest_us = s->time_us;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  double hours = argc > 1 ? atof(argv[1]) : 1.0;
+  size_t megabytes = argc > 2 ? strtoul(argv[2], NULL, 10) : 8;
+  long steps = (long)(hours * 3600 * 1e6 / STEP_US);
+  uint32_t *hashes = malloc(steps * sizeof(uint32_t));
+
+  if (!recorder_open(BENCH_FILE, megabytes << 20))
+  {
+    return 1;
+  }
+  printf("=== Flight recorder: %.2f h at 1 kHz (%ld samples), %zu MB file ===\n", hours,
+         steps, megabytes);
+
+  srand(42);
+  int level = 0, rate = BASE_RATE;
+  unsigned accepted = 0, dropped = 0;
+  double leak_credit = 0, recording_ns = 0;
+  long waits = 0;
+
+  for (long i = 0; i < steps; i++)
+  {
+    // Offered load swings between 50% and 150% of the base rate over ten
+    // minutes, arriving in bursts
+    double t = i * (STEP_US / 1e6);
+    double offered = BASE_RATE * (1.0 + 0.5 * sin(t * 2 * M_PI / 600)) * STEP_US / 1e6;
+    int arrivals = rand() % 8 == 0 ? (int)(offered * 8 * (rand() % 100) / 100) : 0;
+
+    leak_credit += rate * (STEP_US / 1e6);
+    int leaked = (int)leak_credit < level ? (int)leak_credit : level;
+    leak_credit -= (int)leak_credit;
+    level -= leaked;
+    for (int a = 0; a < arrivals; a++)
+    {
+      if (level < CAPACITY)
+      {
+        level++;
+        accepted++;
+      }
+      else
+      {
+        dropped++;
+      }
+    }
+    rate = adaptive_rate(level);
+
+    RecorderSample s = {START_US + i * STEP_US, level, rate, accepted, dropped};
+    hashes[i] = sample_hash(&s);
+
+    // Only the time spent inside recorder_record_at counts; a full ring
+    // means the bench outran the flusher, so let it catch up
+    double start = now_ns();
+    while (!recorder_record_at(s.time_us, s.level, s.rate, s.accepted, s.dropped))
+    {
+      recording_ns += now_ns() - start;
+      waits++;
+      usleep(1000);
+      start = now_ns();
+    }
+    recording_ns += now_ns() - start;
+  }
+
+  recorder_close();
+  RecorderStats stats = recorder_stats();
+  // The ring-full retries were counted as overruns; none were lost
+  stats.overruns -= waits;
+
+  CheckState check = {hashes, steps, 0, 0, 0};
+  long read = recorder_read(BENCH_FILE, check_sample, &check);
+
+  double bytes_per_sample = 0, hours_fit = 0;
+  if (check.matched > 0)
+  {
+    bytes_per_sample = (double)stats.bytes_used / check.matched;
+    hours_fit = stats.file_size / bytes_per_sample / 1000 / 3600;
+  }
+
+  printf("  recording:     %.1f ns per sample (%ld waits for the flusher)\n",
+         recording_ns / steps, waits);
+  printf("  flushed:       %lu samples, %lu lost to overruns\n", stats.samples, stats.overruns);
+  printf("  read back:     %ld samples, %ld match, %ld differ\n", read, check.matched,
+         check.mismatched);
+  printf("  compression:   %.2f bytes per sample (%zu raw)\n", bytes_per_sample,
+         sizeof(RecorderSample));
+  printf("  history:       %.2f h of 1 kHz samples fit in %zu MB (oldest kept: %.2f h ago)\n",
+         hours_fit, megabytes, (START_US + steps * STEP_US - check.oldest_us) / 3.6e9);
+
+  free(hashes);
+  unlink(BENCH_FILE);
+
+  if (read < 0 || check.mismatched > 0 || check.matched == 0)
+  {
+    printf("\nFAIL: recording does not read back\n");
+    return 1;
+  }
+  printf("\nAll samples read back intact\n");
+  return 0;
+}
@@ -0,0 +1,607 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "flight-recorder.h"
+
+#define FILE_MAGIC "LBREC01"
+#define SLOT_MAGIC 0x534C4F54 // "SLOT"
+#define HEADER_SIZE 4096
+#define MAX_SAMPLE_BITS (5 * (5 + 64)) // Worst case: every field raw
+
+// Start of the file
+typedef struct
+{
+  char magic[8];
+  uint32_t slot_size;
+  uint32_t num_slots;
+} FileHeader;
+
+// Start of every slot, the bitstream follows it. A slot holds samples of
+// one thread; the first is stored whole, the rest relative to it.
+typedef struct
+{
+  uint32_t magic;
+  uint32_t thread;
+  atomic_ulong seq;   // Order slots were started in, 0 = unused
+  atomic_uint count;  // Samples in the slot, published after the bits
+  atomic_uint bits;   // Bitstream length
+  RecorderSample first;
+} SlotHeader;
+
+#define SLOT_DATA_BITS ((RECORDER_SLOT_SIZE - sizeof(SlotHeader)) * 8)
+
+typedef struct
+{
+  // Producer and consumer indexes on their own cache lines
+  _Alignas(64) atomic_uint tail;
+  _Alignas(64) atomic_uint head;
+  RecorderSample samples[RECORDER_RING_SIZE];
+
+  // Encoder state, flusher thread only
+  int slot;         // Slot being filled, -1 if none
+  uint32_t count;
+  uint32_t bits;
+  RecorderSample prev;
+  int64_t prev_dt;
+  int64_t prev_dacc;
+  int64_t prev_ddrop;
+} Ring;
+
+// Rings, one per recording thread
+static _Atomic(Ring *) rings[RECORDER_MAX_THREADS];
+static atomic_int num_rings = 0;
+static atomic_uint ring_epoch = 1;
+static _Thread_local Ring *my_ring = NULL;
+static _Thread_local unsigned my_epoch = 0;
+
+// Mapped file
+static unsigned char *file_map = NULL;
+static size_t file_size = 0;
+static int num_slots = 0;
+static int next_slot = 0;
+static unsigned long next_seq = 1;
+static int *slot_owner = NULL; // Thread filling each slot, -1 if closed
+
+static pthread_t flush_thread;
+static atomic_int recorder_running = 0;
+static atomic_ulong total_samples = 0;
+static atomic_ulong total_overruns = 0;
+static RecorderStats final_stats; // Kept by recorder_close()
+
+static inline SlotHeader *slot_at(unsigned char *map, int index)
+{
+  return (SlotHeader *)(map + HEADER_SIZE + (size_t)index * RECORDER_SLOT_SIZE);
+}
+
+// ---------- Bitstream ----------
+
+static void put_bits(unsigned char *data, uint32_t *pos, uint64_t value, int n)
+{
+  for (int i = n - 1; i >= 0; i--)
+  {
+    if ((value >> i) & 1)
+    {
+      data[*pos >> 3] |= 0x80 >> (*pos & 7);
+    }
+    (*pos)++;
+  }
+}
+
+static uint64_t get_bits(const unsigned char *data, uint32_t *pos, int n)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < n; i++)
+  {
+    value = (value << 1) | ((data[*pos >> 3] >> (7 - (*pos & 7))) & 1);
+    (*pos)++;
+  }
+  return value;
+}
+
+// Prefix code on the zigzag value: 0 | 10+7 | 110+9 | 1110+12 | 11110+32 | 11111+64
+static void put_signed(unsigned char *data, uint32_t *pos, int64_t v)
+{
+  uint64_t z = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+
+  if (z == 0)
+    put_bits(data, pos, 0, 1);
+  else if (z < (1 << 7))
+  {
+    put_bits(data, pos, 0x2, 2);
+    put_bits(data, pos, z, 7);
+  }
+  else if (z < (1 << 9))
+  {
+    put_bits(data, pos, 0x6, 3);
+    put_bits(data, pos, z, 9);
+  }
+  else if (z < (1 << 12))
+  {
+    put_bits(data, pos, 0xE, 4);
+    put_bits(data, pos, z, 12);
+  }
+  else if (z < (1ULL << 32))
+  {
+    put_bits(data, pos, 0x1E, 5);
+    put_bits(data, pos, z, 32);
+  }
+  else
+  {
+    put_bits(data, pos, 0x1F, 5);
+    put_bits(data, pos, z, 64);
+  }
+}
+
+static int64_t get_signed(const unsigned char *data, uint32_t *pos)
+{
+  static const int widths[] = {7, 9, 12, 32, 64};
+  int ones = 0;
+
+  while (ones < 5 && get_bits(data, pos, 1))
+  {
+    ones++;
+  }
+  if (ones == 0)
+  {
+    return 0;
+  }
+  // The number of leading ones picks the width (five ones have no 0 after)
+  uint64_t z = get_bits(data, pos, widths[ones - 1]);
+  return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+// ---------- Writer ----------
+
+// Claim the next slot nobody is filling, oldest first. -1 if none is free.
+static int claim_slot(int thread)
+{
+  for (int tries = 0; tries < num_slots; tries++)
+  {
+    int index = next_slot;
+    next_slot = (next_slot + 1) % num_slots;
+    if (slot_owner[index] < 0)
+    {
+      slot_owner[index] = thread;
+      return index;
+    }
+  }
+  return -1;
+}
+
+// Make the ring's samples so far visible to readers
+static void publish_slot(Ring *r)
+{
+  if (r->slot >= 0)
+  {
+    SlotHeader *slot = slot_at(file_map, r->slot);
+    atomic_store_explicit(&slot->bits, r->bits, memory_order_release);
+    atomic_store_explicit(&slot->count, r->count, memory_order_release);
+  }
+}
+
+static void start_slot(Ring *r, int thread, const RecorderSample *s)
+{
+  if (r->slot >= 0)
+  {
+    publish_slot(r);
+    slot_owner[r->slot] = -1;
+  }
+
+  r->slot = claim_slot(thread);
+  if (r->slot < 0)
+  {
+    atomic_fetch_add(&total_overruns, 1);
+    return;
+  }
+
+  // Invalidate before rewriting, a concurrent reader skips the slot
+  SlotHeader *slot = slot_at(file_map, r->slot);
+  atomic_store_explicit(&slot->seq, 0, memory_order_release);
+  atomic_store_explicit(&slot->count, 0, memory_order_release);
+  memset(slot + 1, 0, RECORDER_SLOT_SIZE - sizeof(SlotHeader));
+  slot->magic = SLOT_MAGIC;
+  slot->thread = thread;
+  slot->first = *s;
+  atomic_store_explicit(&slot->bits, 0, memory_order_release);
+  atomic_store_explicit(&slot->seq, next_seq++, memory_order_release);
+
+  r->count = 1;
+  r->bits = 0;
+  r->prev = *s;
+  r->prev_dt = 0;
+  r->prev_dacc = 0;
+  r->prev_ddrop = 0;
+}
+
+static void encode_sample(Ring *r, int thread, const RecorderSample *s)
+{
+  if (r->slot < 0 || r->bits + MAX_SAMPLE_BITS > SLOT_DATA_BITS)
+  {
+    start_slot(r, thread, s);
+    return;
+  }
+
+  unsigned char *data = (unsigned char *)(slot_at(file_map, r->slot) + 1);
+  int64_t dt = s->time_us - r->prev.time_us;
+  int64_t dacc = (int32_t)(s->accepted - r->prev.accepted);
+  int64_t ddrop = (int32_t)(s->dropped - r->prev.dropped);
+
+  put_signed(data, &r->bits, dt - r->prev_dt);
+  put_signed(data, &r->bits, (int64_t)s->level - r->prev.level);
+  put_signed(data, &r->bits, (int64_t)s->rate - r->prev.rate);
+  put_signed(data, &r->bits, dacc - r->prev_dacc);
+  put_signed(data, &r->bits, ddrop - r->prev_ddrop);
+
+  r->prev = *s;
+  r->prev_dt = dt;
+  r->prev_dacc = dacc;
+  r->prev_ddrop = ddrop;
+  r->count++;
+}
+
+// Move everything waiting in the rings into the file
+static void drain_rings()
+{
+  int n = atomic_load(&num_rings);
+  if (n > RECORDER_MAX_THREADS)
+  {
+    n = RECORDER_MAX_THREADS;
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    Ring *r = atomic_load_explicit(&rings[i], memory_order_acquire);
+    if (r == NULL)
+    {
+      continue;
+    }
+
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head == tail)
+    {
+      continue;
+    }
+    atomic_fetch_add(&total_samples, tail - head);
+    for (; head != tail; head++)
+    {
+      encode_sample(r, i, &r->samples[head & (RECORDER_RING_SIZE - 1)]);
+    }
+    atomic_store_explicit(&r->head, head, memory_order_release);
+    publish_slot(r);
+  }
+}
+
+static void *flush_loop(void *arg)
+{
+  (void)arg;
+  while (atomic_load(&recorder_running))
+  {
+    drain_rings();
+    usleep(RECORDER_FLUSH_MS * 1000);
+  }
+  drain_rings();
+  return NULL;
+}
+
+int recorder_open(const char *path, size_t max_bytes)
+{
+  if (atomic_load(&recorder_running))
+  {
+    return 0;
+  }
+  if (max_bytes == 0)
+  {
+    max_bytes = RECORDER_DEFAULT_SIZE;
+  }
+
+  num_slots = (int)((max_bytes - HEADER_SIZE) / RECORDER_SLOT_SIZE);
+  if (max_bytes <= HEADER_SIZE || num_slots < 2)
+  {
+    num_slots = 2;
+  }
+  file_size = HEADER_SIZE + (size_t)num_slots * RECORDER_SLOT_SIZE;
+
+  // Keep the previous run's history, it is what a recorder is there for
+  char previous[4096];
+  if (snprintf(previous, sizeof(previous), "%s.1", path) < (int)sizeof(previous) &&
+      access(path, F_OK) == 0 && rename(path, previous) < 0)
+  {
+    perror(previous);
+  }
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    perror(path);
+    return 0;
+  }
+  if (ftruncate(fd, file_size) < 0)
+  {
+    perror("ftruncate");
+    close(fd);
+    return 0;
+  }
+  file_map = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (file_map == MAP_FAILED)
+  {
+    perror("mmap");
+    file_map = NULL;
+    return 0;
+  }
+
+  slot_owner = malloc(num_slots * sizeof(int));
+  if (slot_owner == NULL)
+  {
+    munmap(file_map, file_size);
+    file_map = NULL;
+    return 0;
+  }
+  for (int i = 0; i < num_slots; i++)
+  {
+    slot_owner[i] = -1;
+  }
+  next_slot = 0;
+  next_seq = 1;
+  atomic_store(&total_samples, 0);
+  atomic_store(&total_overruns, 0);
+
+  FileHeader *header = (FileHeader *)file_map;
+  memcpy(header->magic, FILE_MAGIC, sizeof(header->magic));
+  header->slot_size = RECORDER_SLOT_SIZE;
+  header->num_slots = num_slots;
+
+  atomic_store(&recorder_running, 1);
+  if (pthread_create(&flush_thread, NULL, flush_loop, NULL) != 0)
+  {
+    atomic_store(&recorder_running, 0);
+    munmap(file_map, file_size);
+    file_map = NULL;
+    free(slot_owner);
+    slot_owner = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+int recorder_record_at(int64_t time_us, int level, int rate, unsigned accepted,
+                       unsigned dropped)
+{
+  if (!atomic_load_explicit(&recorder_running, memory_order_relaxed))
+  {
+    return 0;
+  }
+
+  // First sample of this thread since the recorder was opened: get a ring
+  unsigned epoch = atomic_load_explicit(&ring_epoch, memory_order_relaxed);
+  if (my_epoch != epoch)
+  {
+    int index = atomic_fetch_add(&num_rings, 1);
+    my_epoch = epoch;
+    my_ring = index < RECORDER_MAX_THREADS ? calloc(1, sizeof(Ring)) : NULL;
+    if (my_ring != NULL)
+    {
+      my_ring->slot = -1;
+      atomic_store_explicit(&rings[index], my_ring, memory_order_release);
+    }
+  }
+
+  Ring *r = my_ring;
+  if (r == NULL)
+  {
+    return 0;
+  }
+
+  unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+  if (tail - head == RECORDER_RING_SIZE)
+  {
+    atomic_fetch_add_explicit(&total_overruns, 1, memory_order_relaxed);
+    return 0;
+  }
+
+  RecorderSample *s = &r->samples[tail & (RECORDER_RING_SIZE - 1)];
+  s->time_us = time_us;
+  s->level = level;
+  s->rate = rate;
+  s->accepted = accepted;
+  s->dropped = dropped;
+  atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+  return 1;
+}
+
+int recorder_record(int level, int rate, unsigned accepted, unsigned dropped)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return recorder_record_at(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000, level, rate,
+                            accepted, dropped);
+}
+
+// Callers guarantee no thread is recording (see flight-recorder.h), so
+// the rings can be freed without waiting for anyone
+void recorder_close(void)
+{
+  if (!atomic_load(&recorder_running))
+  {
+    return;
+  }
+  atomic_store(&recorder_running, 0);
+  pthread_join(flush_thread, NULL);
+
+  final_stats = recorder_stats();
+  msync(file_map, file_size, MS_SYNC);
+  munmap(file_map, file_size);
+  file_map = NULL;
+
+  // Threads that record again after a reopen get fresh rings
+  int n = atomic_exchange(&num_rings, 0);
+  for (int i = 0; i < n && i < RECORDER_MAX_THREADS; i++)
+  {
+    free(atomic_exchange(&rings[i], NULL));
+  }
+  atomic_fetch_add(&ring_epoch, 1);
+  free(slot_owner);
+  slot_owner = NULL;
+}
+
+RecorderStats recorder_stats(void)
+{
+  RecorderStats stats;
+  if (file_map == NULL)
+  {
+    return final_stats;
+  }
+  stats.samples = atomic_load(&total_samples);
+  stats.overruns = atomic_load(&total_overruns);
+  stats.file_size = file_size;
+  stats.bytes_used = 0;
+  for (int i = 0; i < num_slots; i++)
+  {
+    SlotHeader *slot = slot_at(file_map, i);
+    if (atomic_load(&slot->seq) != 0)
+    {
+      stats.bytes_used += sizeof(SlotHeader) + (atomic_load(&slot->bits) + 7) / 8;
+    }
+  }
+  return stats;
+}
+
+// ---------- Reader ----------
+
+typedef struct
+{
+  unsigned long seq;
+  int index;
+} SlotOrder;
+
+static int compare_seq(const void *a, const void *b)
+{
+  unsigned long x = ((const SlotOrder *)a)->seq;
+  unsigned long y = ((const SlotOrder *)b)->seq;
+  return x < y ? -1 : x > y;
+}
+
+// Decode one slot into out[], returns the number of samples
+static uint32_t decode_slot(SlotHeader *slot, uint32_t count, RecorderSample *out)
+{
+  const unsigned char *data = (const unsigned char *)(slot + 1);
+  uint32_t bits = atomic_load_explicit(&slot->bits, memory_order_acquire);
+  uint32_t pos = 0;
+  RecorderSample s = slot->first;
+  int64_t dt = 0, dacc = 0, ddrop = 0;
+
+  if (bits > SLOT_DATA_BITS)
+  {
+    return 0;
+  }
+  out[0] = s;
+  for (uint32_t n = 1; n < count; n++)
+  {
+    // The writer starts a sample only with MAX_SAMPLE_BITS to spare, so
+    // this bound keeps a torn or corrupt slot from reading past its end
+    if (pos >= bits || pos + MAX_SAMPLE_BITS > SLOT_DATA_BITS)
+    {
+      return n; // Torn: the slot was being rewritten
+    }
+    dt += get_signed(data, &pos);
+    s.time_us += dt;
+    s.level += (int32_t)get_signed(data, &pos);
+    s.rate += (int32_t)get_signed(data, &pos);
+    dacc += get_signed(data, &pos);
+    s.accepted += (uint32_t)dacc;
+    ddrop += get_signed(data, &pos);
+    s.dropped += (uint32_t)ddrop;
+    if (pos > bits)
+    {
+      return n;
+    }
+    out[n] = s;
+  }
+  return count;
+}
+
+long recorder_read(const char *path,
+                   void (*fn)(void *arg, int thread, const RecorderSample *sample),
+                   void *arg)
+{
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+
+  if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < HEADER_SIZE)
+  {
+    if (fd >= 0)
+      close(fd);
+    return -1;
+  }
+  unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    return -1;
+  }
+
+  const FileHeader *header = (const FileHeader *)map;
+  int slots = header->num_slots;
+  if (memcmp(header->magic, FILE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->slot_size != RECORDER_SLOT_SIZE ||
+      HEADER_SIZE + (size_t)slots * RECORDER_SLOT_SIZE > (size_t)st.st_size)
+  {
+    munmap(map, st.st_size);
+    return -1;
+  }
+
+  // Oldest slot first
+  SlotOrder *order = malloc(slots * sizeof(SlotOrder));
+  RecorderSample *samples = malloc((SLOT_DATA_BITS / 5 + 1) * sizeof(RecorderSample));
+  int used = 0;
+  for (int i = 0; i < slots; i++)
+  {
+    SlotHeader *slot = slot_at(map, i);
+    unsigned long seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (slot->magic == SLOT_MAGIC && seq != 0)
+    {
+      order[used].seq = seq;
+      order[used].index = i;
+      used++;
+    }
+  }
+  qsort(order, used, sizeof(SlotOrder), compare_seq);
+
+  long total = 0;
+  for (int i = 0; i < used; i++)
+  {
+    SlotHeader *slot = slot_at(map, order[i].index);
+    uint32_t count = atomic_load_explicit(&slot->count, memory_order_acquire);
+    if (count == 0 || count > SLOT_DATA_BITS / 5 + 1)
+    {
+      continue;
+    }
+    uint32_t n = decode_slot(slot, count, samples);
+
+    // Skip it if the writer started reusing the slot meanwhile
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != order[i].seq)
+    {
+      continue;
+    }
+    for (uint32_t k = 0; k < n; k++)
+    {
+      fn(arg, slot->thread, &samples[k]);
+    }
+    total += n;
+  }
+
+  free(order);
+  free(samples);
+  munmap(map, st.st_size);
+  return total;
+}
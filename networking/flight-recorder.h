@@ -0,0 +1,77 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+// Always-on recorder of bucket level, leak rate and accept/drop counters.
+//
+// Recording a sample is a store into a per-thread single-producer ring; it
+// never blocks and never takes a lock (a full ring drops the sample and
+// counts an overrun). A background thread drains the rings, compresses the
+// samples and writes them into a memory-mapped file of fixed-size slots:
+//
+//   time        delta-of-delta  (regular sampling costs 1 bit)
+//   level, rate delta
+//   accepted,   delta-of-delta  (a steady accept/drop rate costs 1 bit)
+//   dropped
+//
+// each as a Gorilla-style variable-length code. Slots are reused oldest
+// first once the file is full, so the file never grows past its size and
+// always holds the most recent history. recorder_read() and recorder-dump
+// decode a file, also while it is still being written.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECORDER_MAX_THREADS 64
+#define RECORDER_RING_SIZE 4096        // Samples per thread, power of two
+#define RECORDER_SLOT_SIZE 16384       // Bytes per file slot
+#define RECORDER_DEFAULT_SIZE (8 << 20)
+#define RECORDER_FLUSH_MS 50
+
+typedef struct
+{
+  int64_t time_us;   // Wall clock, microseconds since the epoch
+  int32_t level;
+  int32_t rate;
+  uint32_t accepted; // Running totals
+  uint32_t dropped;
+} RecorderSample;
+
+typedef struct
+{
+  unsigned long samples;  // Written to the file
+  unsigned long overruns; // Dropped because a ring was full
+  size_t bytes_used;      // Slot bytes holding samples
+  size_t file_size;
+} RecorderStats;
+
+// Create the file at path, at most max_bytes big (0 = default), and start
+// the flusher. An existing recording is renamed to <path>.1 first, so the
+// previous run's history survives a restart. Returns 1 on success.
+int recorder_open(const char *path, size_t max_bytes);
+
+// Record a sample stamped with the current time. Returns 0 if the ring was
+// full or the recorder is not open.
+int recorder_record(int level, int rate, unsigned accepted, unsigned dropped);
+
+// Same with an explicit timestamp (simulations, replays)
+int recorder_record_at(int64_t time_us, int level, int rate, unsigned accepted,
+                       unsigned dropped);
+
+// Flush everything recorded so far, stop the flusher and close the file.
+// This frees every thread's ring, so no thread may be inside, or enter,
+// recorder_record() or recorder_record_at() until it returns: stop or
+// join the recording threads first. Recording after it returns is fine
+// and returns 0 until the next recorder_open().
+void recorder_close(void);
+
+// Counters of the open recorder, or the final ones after recorder_close()
+RecorderStats recorder_stats(void);
+
+// Decode a recording oldest slot first. fn is called for every sample with
+// the index of the thread that recorded it. Returns the number of samples,
+// -1 if the file is not a recording.
+long recorder_read(const char *path,
+                   void (*fn)(void *arg, int thread, const RecorderSample *sample),
+                   void *arg);
+
+#endif
@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <immintrin.h>
+
+#include "flow-table.h"
+
+static int active_kernel = FLOW_KERNEL_AUTO;
+
+int flow_table_init(FlowTable *table, int num_flows, int capacity, int rate,
+                    int32_t now)
+{
+  // 64-byte alignment keeps every array on its own cache lines
+  size_t bytes = ((size_t)num_flows * sizeof(int32_t) + 63) & ~(size_t)63;
+
+  table->num_flows = num_flows;
+  table->levels = aligned_alloc(64, bytes);
+  table->capacities = aligned_alloc(64, bytes);
+  table->rates = aligned_alloc(64, bytes);
+  table->last_ts = aligned_alloc(64, bytes);
+
+  if (!table->levels || !table->capacities || !table->rates || !table->last_ts)
+  {
+    flow_table_free(table);
+    return 0;
+  }
+
+  for (int f = 0; f < num_flows; f++)
+  {
+    table->levels[f] = 0;
+    table->capacities[f] = capacity;
+    table->rates[f] = rate;
+    table->last_ts[f] = now;
+  }
+  return 1;
+}
+
+void flow_table_free(FlowTable *table)
+{
+  free(table->levels);
+  free(table->capacities);
+  free(table->rates);
+  free(table->last_ts);
+  table->levels = table->capacities = table->rates = table->last_ts = NULL;
+  table->num_flows = 0;
+}
+
+void flow_table_apply_config(FlowTable *table, const BucketConfig *cfg)
+{
+  for (int f = 0; f < table->num_flows; f++)
+  {
+    FlowParams params = config_flow_params(cfg, f);
+    table->capacities[f] = params.capacity;
+    table->rates[f] = params.leak_rate;
+  }
+}
+
+// One packet against one flow, same steps as leak_bucket() + add_packet()
+static inline int admit_one(FlowTable *t, int32_t flow, int32_t size, int32_t now)
+{
+  int32_t level = t->levels[flow];
+  int32_t elapsed = now - t->last_ts[flow];
+
+  if (elapsed > 0)
+  {
+    // elapsed * rate can pass INT32_MAX, take it in 64 bits
+    int64_t leak = (int64_t)elapsed * t->rates[flow];
+    if (leak > level)
+    {
+      leak = level;
+    }
+    level -= (int32_t)leak;
+    t->last_ts[flow] = now;
+  }
+
+  if (level + size <= t->capacities[flow])
+  {
+    t->levels[flow] = level + size;
+    return 1;
+  }
+  t->levels[flow] = level;
+  return 0;
+}
+
+static int admit_scalar(FlowTable *t, const int32_t *flows, const int32_t *sizes,
+                        int count, int32_t now, uint8_t *accepted)
+{
+  int total = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    accepted[i] = admit_one(t, flows[i], sizes[i], now);
+    total += accepted[i];
+  }
+  return total;
+}
+
+// min(elapsed * rate, level) per lane, the product taken in 64 bits as in
+// admit_one(): even lanes in the low halves of 64-bit lanes, odd lanes in
+// the high halves. All three are non-negative.
+__attribute__((target("avx2"))) static inline __m256i
+leak_avx2(__m256i elapsed, __m256i rate, __m256i level)
+{
+  const __m256i low = _mm256_set1_epi64x(0xffffffff);
+  __m256i even = _mm256_mul_epu32(elapsed, rate);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(elapsed, 32), _mm256_srli_epi64(rate, 32));
+  __m256i level_even = _mm256_and_si256(level, low);
+  __m256i level_odd = _mm256_srli_epi64(level, 32);
+
+  even = _mm256_blendv_epi8(even, level_even, _mm256_cmpgt_epi64(even, level_even));
+  odd = _mm256_blendv_epi8(odd, level_odd, _mm256_cmpgt_epi64(odd, level_odd));
+  return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+}
+
+__attribute__((target("avx2"))) static int
+admit_avx2(FlowTable *t, const int32_t *flows, const int32_t *sizes, int count,
+           int32_t now, uint8_t *accepted)
+{
+  const __m256i vnow = _mm256_set1_epi32(now);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i rotate[4] = {
+      _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0),
+      _mm256_setr_epi32(2, 3, 4, 5, 6, 7, 0, 1),
+      _mm256_setr_epi32(3, 4, 5, 6, 7, 0, 1, 2),
+      _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3),
+  };
+  int32_t new_levels[8] __attribute__((aligned(32)));
+  int32_t new_last[8] __attribute__((aligned(32)));
+  int total = 0;
+  int i = 0;
+
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i idx = _mm256_loadu_si256((const __m256i *)(flows + i));
+
+    // Duplicate flows must see each other's updates: run the group in order.
+    // Comparing against rotations by 1..4 covers every pair of lanes.
+    __m256i dup = zero;
+    for (int r = 0; r < 4; r++)
+    {
+      dup = _mm256_or_si256(
+          dup, _mm256_cmpeq_epi32(idx, _mm256_permutevar8x32_epi32(idx, rotate[r])));
+    }
+    if (!_mm256_testz_si256(dup, dup))
+    {
+      total += admit_scalar(t, flows + i, sizes + i, 8, now, accepted + i);
+      continue;
+    }
+
+    __m256i level = _mm256_i32gather_epi32(t->levels, idx, 4);
+    __m256i cap = _mm256_i32gather_epi32(t->capacities, idx, 4);
+    __m256i rate = _mm256_i32gather_epi32(t->rates, idx, 4);
+    __m256i last = _mm256_i32gather_epi32(t->last_ts, idx, 4);
+    __m256i size = _mm256_loadu_si256((const __m256i *)(sizes + i));
+
+    __m256i elapsed = _mm256_max_epi32(_mm256_sub_epi32(vnow, last), zero);
+    __m256i leak = leak_avx2(elapsed, rate, level);
+    level = _mm256_sub_epi32(level, leak);
+
+    __m256i next = _mm256_add_epi32(level, size);
+    __m256i drop = _mm256_cmpgt_epi32(next, cap);
+    level = _mm256_blendv_epi8(next, level, drop);
+    last = _mm256_max_epi32(last, vnow);
+
+    // AVX2 has no scatter, write the 8 lanes back one by one
+    _mm256_store_si256((__m256i *)new_levels, level);
+    _mm256_store_si256((__m256i *)new_last, last);
+    for (int j = 0; j < 8; j++)
+    {
+      t->levels[flows[i + j]] = new_levels[j];
+      t->last_ts[flows[i + j]] = new_last[j];
+    }
+
+    int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(drop)) & 0xff;
+    for (int j = 0; j < 8; j++)
+    {
+      accepted[i + j] = (mask >> j) & 1;
+    }
+    total += __builtin_popcount(mask);
+  }
+
+  return total + admit_scalar(t, flows + i, sizes + i, count - i, now, accepted + i);
+}
+
+// Same as leak_avx2()
+__attribute__((target("avx512f"))) static inline __m512i
+leak_avx512(__m512i elapsed, __m512i rate, __m512i level)
+{
+  const __m512i low = _mm512_set1_epi64(0xffffffff);
+  __m512i even = _mm512_mul_epu32(elapsed, rate);
+  __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(elapsed, 32), _mm512_srli_epi64(rate, 32));
+
+  even = _mm512_min_epu64(even, _mm512_and_si512(level, low));
+  odd = _mm512_min_epu64(odd, _mm512_srli_epi64(level, 32));
+  return _mm512_mask_blend_epi32(0xaaaa, even, _mm512_slli_epi64(odd, 32));
+}
+
+__attribute__((target("avx512f,avx512cd"))) static int
+admit_avx512(FlowTable *t, const int32_t *flows, const int32_t *sizes, int count,
+             int32_t now, uint8_t *accepted)
+{
+  const __m512i vnow = _mm512_set1_epi32(now);
+  const __m512i zero = _mm512_setzero_si512();
+  int total = 0;
+  int i = 0;
+
+  for (; i + 16 <= count; i += 16)
+  {
+    __m512i idx = _mm512_loadu_si512(flows + i);
+
+    // Any lane whose flow appears earlier in the vector forces the slow path
+    __m512i conflicts = _mm512_conflict_epi32(idx);
+    if (_mm512_test_epi32_mask(conflicts, conflicts))
+    {
+      total += admit_scalar(t, flows + i, sizes + i, 16, now, accepted + i);
+      continue;
+    }
+
+    __m512i level = _mm512_i32gather_epi32(idx, t->levels, 4);
+    __m512i cap = _mm512_i32gather_epi32(idx, t->capacities, 4);
+    __m512i rate = _mm512_i32gather_epi32(idx, t->rates, 4);
+    __m512i last = _mm512_i32gather_epi32(idx, t->last_ts, 4);
+    __m512i size = _mm512_loadu_si512(sizes + i);
+
+    __m512i elapsed = _mm512_max_epi32(_mm512_sub_epi32(vnow, last), zero);
+    __m512i leak = leak_avx512(elapsed, rate, level);
+    level = _mm512_sub_epi32(level, leak);
+
+    __m512i next = _mm512_add_epi32(level, size);
+    __mmask16 ok = _mm512_cmple_epi32_mask(next, cap);
+    level = _mm512_mask_mov_epi32(level, ok, next);
+    last = _mm512_max_epi32(last, vnow);
+
+    _mm512_i32scatter_epi32(t->levels, idx, level, 4);
+    _mm512_i32scatter_epi32(t->last_ts, idx, last, 4);
+
+    _mm_storeu_si128((__m128i *)(accepted + i),
+                     _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(ok, 1)));
+    total += __builtin_popcount(ok);
+  }
+
+  return total + admit_scalar(t, flows + i, sizes + i, count - i, now, accepted + i);
+}
+
+static int best_kernel()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+  {
+    return FLOW_KERNEL_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return FLOW_KERNEL_AVX2;
+  }
+  return FLOW_KERNEL_SCALAR;
+}
+
+int flow_table_set_kernel(int kernel)
+{
+  int best = best_kernel();
+
+  // Never pick a kernel the CPU cannot run
+  active_kernel = (kernel == FLOW_KERNEL_AUTO || kernel > best) ? best : kernel;
+  return active_kernel;
+}
+
+const char *flow_table_kernel_name(int kernel)
+{
+  switch (kernel)
+  {
+  case FLOW_KERNEL_AVX512:
+    return "AVX-512";
+  case FLOW_KERNEL_AVX2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+
+int flow_table_admit_batch(FlowTable *table, const int32_t *flows,
+                           const int32_t *sizes, int count, int32_t now,
+                           uint8_t *accepted)
+{
+  if (active_kernel == FLOW_KERNEL_AUTO)
+  {
+    flow_table_set_kernel(FLOW_KERNEL_AUTO);
+  }
+
+  switch (active_kernel)
+  {
+  case FLOW_KERNEL_AVX512:
+    return admit_avx512(table, flows, sizes, count, now, accepted);
+  case FLOW_KERNEL_AVX2:
+    return admit_avx2(table, flows, sizes, count, now, accepted);
+  default:
+    return admit_scalar(table, flows, sizes, count, now, accepted);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef FLOW_TABLE_H
+#define FLOW_TABLE_H
+
+// Many fixed-rate leaky buckets (one per flow) in structure-of-arrays form,
+// with a batch admission kernel that handles 8 (AVX2) or 16 (AVX-512)
+// packets per step. Each packet runs the same logic as add_packet() in
+// fixed-leaky-bucket.c against its flow's bucket.
+//
+// Time is an int32 tick count chosen by the caller; rates are packets per
+// tick. The kernel is picked at runtime from the CPU features, with a
+// scalar fallback everywhere else.
+
+#include <stdint.h>
+
+#include "bucket-config.h"
+
+typedef struct
+{
+  int num_flows;
+  int32_t *levels;     // Current level per flow
+  int32_t *capacities; // Capacity per flow
+  int32_t *rates;      // Leak rate per flow (packets per tick)
+  int32_t *last_ts;    // Last leak time per flow
+} FlowTable;
+
+// Kernel selection
+#define FLOW_KERNEL_AUTO 0
+#define FLOW_KERNEL_SCALAR 1
+#define FLOW_KERNEL_AVX2 2
+#define FLOW_KERNEL_AVX512 3
+
+// Allocate a table with every flow at the same capacity and rate
+int flow_table_init(FlowTable *table, int num_flows, int capacity, int rate,
+                    int32_t now);
+void flow_table_free(FlowTable *table);
+
+// Take per-flow capacity and rate from a config snapshot
+void flow_table_apply_config(FlowTable *table, const BucketConfig *cfg);
+
+// Offer a batch of packets that all arrive at tick now.
+// accepted[i] is set to 1 or 0, returns the number accepted.
+int flow_table_admit_batch(FlowTable *table, const int32_t *flows,
+                           const int32_t *sizes, int count, int32_t now,
+                           uint8_t *accepted);
+
+// Force a kernel (for benchmarks), returns the kernel actually used
+int flow_table_set_kernel(int kernel);
+const char *flow_table_kernel_name(int kernel);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef GCRA_H
+#define GCRA_H
+
+// Generic Cell Rate Algorithm (virtual scheduling) form of the leaky bucket.
+//
+// Time is measured in "packet slots": now * leak_rate, i.e. how many
+// packets the bucket could have leaked since the epoch. Instead of a level
+// and a last-leak time each bucket keeps one value, the theoretical
+// arrival time (TAT). The level is simply TAT - now when positive, so
+//
+//   level-tracking:  level = max(0, level - elapsed * rate)
+//                    accept if level + size <= capacity
+//   GCRA:            tat = max(tat, now)
+//                    accept if tat + size - now <= capacity
+//
+// give identical decisions, with 8 bytes of state and no multiply or
+// clamp per packet.
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Current time in packet slots for a given leak rate
+static inline int64_t gcra_now(int64_t seconds, int leak_rate)
+{
+  return seconds * leak_rate;
+}
+
+// Admit a packet, returns 1 if accepted (and charges it), 0 if dropped
+static inline int gcra_admit(int64_t *tat, int64_t now, int size, int capacity)
+{
+  int64_t t = *tat > now ? *tat : now;
+
+  if (t + size - now > capacity)
+  {
+    return 0;
+  }
+  *tat = t + size;
+  return 1;
+}
+
+// Same as gcra_admit() for a TAT shared between threads or processes
+static inline int gcra_admit_atomic(_Atomic int64_t *tat, int64_t now, int size,
+                                    int capacity)
+{
+  int64_t old = atomic_load_explicit(tat, memory_order_relaxed);
+
+  do
+  {
+    int64_t t = old > now ? old : now;
+    if (t + size - now > capacity)
+    {
+      return 0;
+    }
+    if (atomic_compare_exchange_weak_explicit(tat, &old, t + size,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed))
+    {
+      return 1;
+    }
+  } while (1);
+}
+
+// Equivalent bucket level at time now
+static inline int gcra_level(int64_t tat, int64_t now)
+{
+  return tat > now ? (int)(tat - now) : 0;
+}
+
+// TAT that represents a given level at time now (used when the rate changes)
+static inline int64_t gcra_from_level(int level, int64_t now)
+{
+  return now + level;
+}
+
+#endif
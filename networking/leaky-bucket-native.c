@@ -0,0 +1,385 @@
+// Native backend for simple-leaky-bucket.py (CPython extension "leakybucket")
+//
+// Build: gcc -O2 -shared -fPIC $(python3-config --includes) leaky-bucket-native.c -o leakybucket$(python3-config --extension-suffix)
+// Usage: python3 simple-leaky-bucket.py --native
+//
+// Same queue and tick loop as the Python version, with packets kept in a C
+// ring buffer instead of dicts in a deque. leaky_bucket_algorithm() runs the
+// whole loop (and the optional tick delay) with the GIL released and returns
+// the send schedule in one bytes object.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_QUEUE_SIZE 20
+#define BUCKET_SIZE 10
+
+typedef struct
+{
+  long long size;
+  long long id;
+} Packet;
+
+// One record per sent packet in the schedule returned to Python
+typedef struct
+{
+  int64_t tick;
+  int64_t id;
+  int64_t size;
+} SentRecord;
+
+static Packet *queue = NULL;
+static Py_ssize_t queue_capacity = 0; // max_queue_size
+static Py_ssize_t queue_front = 0;
+static Py_ssize_t queue_count = 0;
+static long long bucket_size = BUCKET_SIZE;
+
+// Set while the tick loop runs without the GIL, the queue is off limits then
+static int running = 0;
+
+static int check_idle()
+{
+  if (running)
+  {
+    PyErr_SetString(PyExc_RuntimeError, "leaky_bucket_algorithm() is running");
+    return 0;
+  }
+  return 1;
+}
+
+// Resize the ring, keeping queued packets in order
+static int resize_queue(Py_ssize_t capacity)
+{
+  Packet *ring = PyMem_RawMalloc((capacity > 0 ? capacity : 1) * sizeof(Packet));
+  if (ring == NULL)
+  {
+    PyErr_NoMemory();
+    return 0;
+  }
+  for (Py_ssize_t i = 0; i < queue_count; i++)
+  {
+    ring[i] = queue[(queue_front + i) % queue_capacity];
+  }
+  PyMem_RawFree(queue);
+  queue = ring;
+  queue_capacity = capacity;
+  queue_front = 0;
+  return 1;
+}
+
+static inline int push_packet(long long size, long long id)
+{
+  if (queue_count >= queue_capacity)
+  {
+    return 0;
+  }
+  Packet *p = &queue[(queue_front + queue_count) % queue_capacity];
+  p->size = size;
+  p->id = id;
+  queue_count++;
+  return 1;
+}
+
+// ---------- Module functions ----------
+
+static PyObject *lb_configure(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static char *keywords[] = {"bucket_size", "max_queue_size", NULL};
+  long long new_bucket = bucket_size;
+  Py_ssize_t new_capacity = queue_capacity;
+  (void)self;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Ln:configure", keywords,
+                                   &new_bucket, &new_capacity))
+    return NULL;
+  if (!check_idle())
+    return NULL;
+  if (new_capacity < queue_count || new_capacity < 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "max_queue_size is below the packets already queued");
+    return NULL;
+  }
+  if (new_capacity != queue_capacity && !resize_queue(new_capacity))
+    return NULL;
+
+  bucket_size = new_bucket;
+  Py_RETURN_NONE;
+}
+
+static PyObject *lb_enqueue_packet(PyObject *self, PyObject *args)
+{
+  long long size, id;
+  (void)self;
+
+  if (!PyArg_ParseTuple(args, "LL:enqueue_packet", &size, &id) || !check_idle())
+    return NULL;
+  return PyBool_FromLong(push_packet(size, id));
+}
+
+// Element i of a 1-D integer buffer, widened to long long. Read by item
+// size rather than format letter, so '=' (standard sizes, where 'l' is 4
+// bytes) and '@' (native, where 'l' is 8 on LP64) both come out right.
+static inline long long buffer_item(const Py_buffer *view, int is_signed, Py_ssize_t i)
+{
+  const char *p = (const char *)view->buf + i * view->strides[0];
+
+  if (is_signed)
+  {
+    switch (view->itemsize)
+    {
+    case 1: return *(const int8_t *)p;
+    case 2: return *(const int16_t *)p;
+    case 4: return *(const int32_t *)p;
+    default: return *(const int64_t *)p;
+    }
+  }
+  switch (view->itemsize)
+  {
+  case 1: return *(const uint8_t *)p;
+  case 2: return *(const uint16_t *)p;
+  case 4: return *(const uint32_t *)p;
+  default: return (long long)*(const uint64_t *)p;
+  }
+}
+
+// Whether the integer format of a buffer checked by get_int_buffer() is signed
+static inline int buffer_signed(const Py_buffer *view)
+{
+  const char *f = view->format;
+  return strchr("bhilq", f[*f == '@' || *f == '=']) != NULL;
+}
+
+static int get_int_buffer(PyObject *obj, Py_buffer *view, const char *name)
+{
+  if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT | PyBUF_STRIDES) < 0)
+    return 0;
+
+  const char *f = view->format;
+  if (*f == '@' || *f == '=')
+    f++;
+  if (view->ndim != 1 || f[0] == '\0' || f[1] != '\0' || strchr("bBhHiIlLqQ", f[0]) == NULL ||
+      (view->itemsize != 1 && view->itemsize != 2 && view->itemsize != 4 &&
+       view->itemsize != 8))
+  {
+    PyErr_Format(PyExc_TypeError, "%s must be a 1-D buffer of integers", name);
+    PyBuffer_Release(view);
+    return 0;
+  }
+  return 1;
+}
+
+static PyObject *lb_enqueue_batch(PyObject *self, PyObject *args)
+{
+  PyObject *sizes_obj, *ids_obj;
+  Py_buffer sizes, ids;
+  (void)self;
+
+  if (!PyArg_ParseTuple(args, "OO:enqueue_batch", &sizes_obj, &ids_obj) || !check_idle())
+    return NULL;
+  if (!get_int_buffer(sizes_obj, &sizes, "sizes"))
+    return NULL;
+  if (!get_int_buffer(ids_obj, &ids, "ids"))
+  {
+    PyBuffer_Release(&sizes);
+    return NULL;
+  }
+  if (sizes.shape[0] != ids.shape[0])
+  {
+    PyErr_SetString(PyExc_ValueError, "sizes and ids differ in length");
+    PyBuffer_Release(&sizes);
+    PyBuffer_Release(&ids);
+    return NULL;
+  }
+
+  // Same as enqueue_packet() in a loop: packets past a full queue are dropped
+  Py_ssize_t accepted = 0;
+  int sizes_signed = buffer_signed(&sizes), ids_signed = buffer_signed(&ids);
+  running = 1;
+  Py_BEGIN_ALLOW_THREADS
+  for (Py_ssize_t i = 0; i < sizes.shape[0]; i++)
+  {
+    accepted += push_packet(buffer_item(&sizes, sizes_signed, i),
+                            buffer_item(&ids, ids_signed, i));
+  }
+  Py_END_ALLOW_THREADS
+  running = 0;
+
+  PyBuffer_Release(&sizes);
+  PyBuffer_Release(&ids);
+  return PyLong_FromSsize_t(accepted);
+}
+
+static PyObject *lb_dequeue_packet(PyObject *self, PyObject *noargs)
+{
+  (void)self;
+  (void)noargs;
+
+  if (!check_idle())
+    return NULL;
+  if (queue_count == 0)
+    Py_RETURN_NONE;
+
+  Packet p = queue[queue_front];
+  queue_front = (queue_front + 1) % queue_capacity;
+  queue_count--;
+  return Py_BuildValue("{s:L,s:L}", "size", p.size, "id", p.id);
+}
+
+static PyObject *lb_peek_packet(PyObject *self, PyObject *noargs)
+{
+  (void)self;
+  (void)noargs;
+
+  if (!check_idle())
+    return NULL;
+  if (queue_count == 0)
+    Py_RETURN_NONE;
+
+  Packet p = queue[queue_front];
+  return Py_BuildValue("{s:L,s:L}", "size", p.size, "id", p.id);
+}
+
+static PyObject *lb_queue_length(PyObject *self, PyObject *noargs)
+{
+  (void)self;
+  (void)noargs;
+  return PyLong_FromSsize_t(queue_count);
+}
+
+// The tick loop, runs without the GIL. Returns the number of ticks; no
+// queued packet may be larger than the bucket (see oversized_packet()).
+static long long run_ticks(SentRecord *sent, double tick_delay)
+{
+  long long tick = 1;
+  Py_ssize_t n = 0;
+
+  while (queue_count > 0)
+  {
+    long long counter = bucket_size;
+
+    while (queue_count > 0 && counter >= queue[queue_front].size)
+    {
+      Packet p = queue[queue_front];
+      queue_front = (queue_front + 1) % queue_capacity;
+      queue_count--;
+
+      sent[n].tick = tick;
+      sent[n].id = p.id;
+      sent[n].size = p.size;
+      n++;
+      counter -= p.size;
+    }
+    tick++;
+
+    if (tick_delay > 0)
+    {
+      struct timespec ts;
+      ts.tv_sec = (time_t)tick_delay;
+      ts.tv_nsec = (long)((tick_delay - ts.tv_sec) * 1e9);
+      nanosleep(&ts, NULL);
+    }
+  }
+  return tick - 1;
+}
+
+// A queued packet that can never fit in the bucket (the Python version
+// would spin forever on it), or NULL. Checked before the loop so an error
+// leaves the queue as it was rather than losing the packets already sent.
+static const Packet *oversized_packet()
+{
+  for (Py_ssize_t i = 0; i < queue_count; i++)
+  {
+    const Packet *p = &queue[(queue_front + i) % queue_capacity];
+    if (p->size > bucket_size)
+      return p;
+  }
+  return NULL;
+}
+
+static PyObject *lb_leaky_bucket_algorithm(PyObject *self, PyObject *args,
+                                           PyObject *kwargs)
+{
+  static char *keywords[] = {"tick_delay", NULL};
+  double tick_delay = 0;
+  (void)self;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|d:leaky_bucket_algorithm",
+                                   keywords, &tick_delay) ||
+      !check_idle())
+    return NULL;
+
+  const Packet *oversized = oversized_packet();
+  if (oversized != NULL)
+  {
+    PyErr_Format(PyExc_ValueError, "packet %lld (size %lld) is larger than the bucket (%lld)",
+                 oversized->id, oversized->size, bucket_size);
+    return NULL;
+  }
+
+  // Every queued packet is sent exactly once, so the schedule size is known
+  PyObject *sent = PyBytes_FromStringAndSize(NULL, queue_count * sizeof(SentRecord));
+  if (sent == NULL)
+    return NULL;
+  SentRecord *records = (SentRecord *)PyBytes_AS_STRING(sent);
+
+  long long ticks;
+  running = 1;
+  Py_BEGIN_ALLOW_THREADS
+  ticks = run_ticks(records, tick_delay);
+  Py_END_ALLOW_THREADS
+  running = 0;
+
+  return Py_BuildValue("(LN)", ticks, sent);
+}
+
+static PyMethodDef lb_methods[] = {
+    {"configure", (PyCFunction)(void (*)(void))lb_configure, METH_VARARGS | METH_KEYWORDS,
+     "configure(bucket_size=10, max_queue_size=20)\n"
+     "Set the bucket size and queue limit."},
+    {"enqueue_packet", lb_enqueue_packet, METH_VARARGS,
+     "enqueue_packet(size, packet_id) -> bool\n"
+     "Add a packet, returns False if the queue is full and it was dropped."},
+    {"enqueue_batch", lb_enqueue_batch, METH_VARARGS,
+     "enqueue_batch(sizes, ids) -> int\n"
+     "Enqueue packets from two 1-D integer buffers (array.array, NumPy arrays,\n"
+     "memoryviews), returns how many were accepted."},
+    {"dequeue_packet", lb_dequeue_packet, METH_NOARGS,
+     "dequeue_packet() -> dict or None"},
+    {"peek_packet", lb_peek_packet, METH_NOARGS,
+     "peek_packet() -> dict or None"},
+    {"queue_length", lb_queue_length, METH_NOARGS,
+     "queue_length() -> int"},
+    {"leaky_bucket_algorithm", (PyCFunction)(void (*)(void))lb_leaky_bucket_algorithm,
+     METH_VARARGS | METH_KEYWORDS,
+     "leaky_bucket_algorithm(tick_delay=0.0) -> (ticks, sent)\n"
+     "Drain the queue. sent is a bytes object of int64 (tick, id, size)\n"
+     "records in send order, e.g. memoryview(sent).cast('q')."},
+    {NULL, NULL, 0, NULL},
+};
+
+static void lb_free(void *module)
+{
+  (void)module;
+  PyMem_RawFree(queue);
+  queue = NULL;
+  queue_capacity = 0;
+  queue_front = 0;
+  queue_count = 0;
+}
+
+static struct PyModuleDef lb_module = {
+    PyModuleDef_HEAD_INIT, "leakybucket",
+    "Native queue and tick loop for simple-leaky-bucket.py", -1, lb_methods,
+    NULL, NULL, NULL, lb_free,
+};
+
+PyMODINIT_FUNC PyInit_leakybucket(void)
+{
+  if (queue == NULL && !resize_queue(MAX_QUEUE_SIZE))
+    return NULL;
+  return PyModule_Create(&lb_module);
+}
@@ -0,0 +1,177 @@
+// Build: g++ -O2 -std=c++17 -c leaky-bucket-shim.cpp
+
+#include <new>
+#include <variant>
+
+#include "leaky-bucket.hpp"
+#include "leaky-bucket-shim.h"
+
+using namespace leaky;
+
+// One instantiation per leak mode, picked at runtime by lb_set_mode()
+using AnyBucket = std::variant<LeakyBucket<WallClock, StaticRate>,
+                               LeakyBucket<WallClock, AdaptiveRate>,
+                               LeakyBucket<WallClock, ScheduledRate>,
+                               LeakyBucket<WallClock, LoadBasedRate>,
+                               LeakyBucket<WallClock, PriorityRate>>;
+
+struct lb_bucket
+{
+  AnyBucket impl;
+  int mode;
+  const WeekSchedule *schedule; // For mode 2, owned by the caller
+};
+
+// A rebuilt scheduled policy starts without a schedule, hand it over again
+static void attach_schedule(lb_bucket *bucket)
+{
+  if (auto *b = std::get_if<LeakyBucket<WallClock, ScheduledRate>>(&bucket->impl))
+  {
+    b->policy().set_schedule(bucket->schedule);
+  }
+}
+
+static AnyBucket make_bucket(int capacity, int base_rate, int mode)
+{
+  switch (mode)
+  {
+  case 1:
+    return LeakyBucket<WallClock, AdaptiveRate>(capacity, base_rate);
+  case 2:
+    return LeakyBucket<WallClock, ScheduledRate>(capacity, base_rate);
+  case 3:
+    return LeakyBucket<WallClock, LoadBasedRate>(capacity, base_rate);
+  case 4:
+    return LeakyBucket<WallClock, PriorityRate>(capacity, base_rate);
+  default:
+    return LeakyBucket<WallClock, StaticRate>(capacity, base_rate);
+  }
+}
+
+extern "C" lb_bucket *lb_create(int capacity, int base_rate, int mode)
+{
+  return new (std::nothrow) lb_bucket{make_bucket(capacity, base_rate, mode), mode, nullptr};
+}
+
+extern "C" void lb_destroy(lb_bucket *bucket)
+{
+  delete bucket;
+}
+
+extern "C" void lb_set_mode(lb_bucket *bucket, int mode)
+{
+  if (mode == bucket->mode)
+  {
+    return;
+  }
+
+  std::visit(
+      [&](auto &old)
+      {
+        AnyBucket next = make_bucket(old.capacity(), old.policy().base, mode);
+        std::visit([&](auto &b)
+                   { b.restore(old.level(), old.last_leak()); },
+                   next);
+        bucket->impl = std::move(next);
+      },
+      bucket->impl);
+  bucket->mode = mode;
+  attach_schedule(bucket);
+}
+
+extern "C" void lb_set_params(lb_bucket *bucket, int capacity, int base_rate)
+{
+  std::visit([&](auto &b)
+             {
+               b.set_capacity(capacity);
+               b.set_base_rate(base_rate); },
+             bucket->impl);
+  attach_schedule(bucket);
+}
+
+extern "C" void lb_set_schedule(lb_bucket *bucket, const WeekSchedule *schedule)
+{
+  bucket->schedule = schedule;
+  attach_schedule(bucket);
+}
+
+extern "C" int lb_leak(lb_bucket *bucket)
+{
+  return std::visit([](auto &b)
+                    { return b.leak(); },
+                    bucket->impl);
+}
+
+extern "C" int lb_add_packet(lb_bucket *bucket, int size, int priority)
+{
+  return std::visit([&](auto &b)
+                    { return b.add_packet(size, priority) ? 1 : 0; },
+                    bucket->impl);
+}
+
+extern "C" void lb_reset(lb_bucket *bucket)
+{
+  std::visit([](auto &b)
+             { b.reset(); },
+             bucket->impl);
+}
+
+extern "C" int lb_level(const lb_bucket *bucket)
+{
+  return std::visit([](const auto &b)
+                    { return b.level(); },
+                    bucket->impl);
+}
+
+extern "C" int lb_capacity(const lb_bucket *bucket)
+{
+  return std::visit([](const auto &b)
+                    { return b.capacity(); },
+                    bucket->impl);
+}
+
+extern "C" int lb_rate(const lb_bucket *bucket)
+{
+  return std::visit([](const auto &b)
+                    { return b.rate(); },
+                    bucket->impl);
+}
+
+extern "C" int lb_rate_changes(const lb_bucket *bucket)
+{
+  return std::visit([](const auto &b)
+                    { return b.rate_changes(); },
+                    bucket->impl);
+}
+
+// Markers: a variant again, so lb_mark() dispatches without a vtable
+using AnyMarker = std::variant<SrTcm<SteadyClock>, TrTcm<SteadyClock>>;
+
+struct lb_marker
+{
+  AnyMarker impl;
+};
+
+extern "C" lb_marker *lb_srtcm_create(long long cir, long long cbs, long long ebs)
+{
+  return new (std::nothrow) lb_marker{SrTcm<SteadyClock>(cir, cbs, ebs)};
+}
+
+extern "C" lb_marker *lb_trtcm_create(long long cir, long long cbs, long long pir,
+                                      long long pbs)
+{
+  return new (std::nothrow) lb_marker{TrTcm<SteadyClock>(cir, cbs, pir, pbs)};
+}
+
+extern "C" void lb_marker_destroy(lb_marker *marker)
+{
+  delete marker;
+}
+
+extern "C" int lb_mark(lb_marker *marker, long long size, int color_in)
+{
+  Color in = color_in == LB_RED ? Color::Red : color_in == LB_YELLOW ? Color::Yellow : Color::Green;
+  return std::visit([&](auto &m)
+                    { return static_cast<int>(m.mark(size, in)); },
+                    marker->impl);
+}
@@ -0,0 +1,68 @@
+#ifndef LEAKY_BUCKET_SHIM_H
+#define LEAKY_BUCKET_SHIM_H
+
+// C interface to the templated core in leaky-bucket.hpp, so the C programs
+// can run on it unchanged. Buckets use the wall clock and whole-packet
+// levels, exactly like fixed-leaky-bucket.c and variable-leaky-bucket.c.
+
+#include "rate-schedule.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct lb_bucket lb_bucket;
+
+  // mode: 0=fixed rate, 1=adaptive, 2=scheduled, 3=load-based, 4=priority
+  lb_bucket *lb_create(int capacity, int base_rate, int mode);
+  void lb_destroy(lb_bucket *bucket);
+
+  // Switch leak mode, keeping the current level
+  void lb_set_mode(lb_bucket *bucket, int mode);
+  void lb_set_params(lb_bucket *bucket, int capacity, int base_rate);
+
+  // Weekly schedule for mode 2, the same table variable-leaky-bucket.c
+  // uses. The bucket keeps the pointer, so the schedule must outlive it;
+  // call again after changing it. Without one mode 2 leaks at the base rate.
+  void lb_set_schedule(lb_bucket *bucket, const WeekSchedule *schedule);
+
+  // Returns packets leaked since the last call
+  int lb_leak(lb_bucket *bucket);
+
+  // Packet priorities, only mode 4 looks at them
+#define LB_PRIORITY_HIGH 1
+#define LB_PRIORITY_MEDIUM 2
+#define LB_PRIORITY_NORMAL 3
+#define LB_PRIORITY_LOW 4
+
+  // Returns 1 if accepted, 0 if dropped
+  int lb_add_packet(lb_bucket *bucket, int size, int priority);
+  void lb_reset(lb_bucket *bucket);
+
+  int lb_level(const lb_bucket *bucket);
+  int lb_capacity(const lb_bucket *bucket);
+  int lb_rate(const lb_bucket *bucket);
+  int lb_rate_changes(const lb_bucket *bucket);
+
+  // Three-color markers (RFC 2697 srTCM, RFC 2698 trTCM) on the monotonic
+  // clock. Rates in bytes per second, bursts in bytes.
+  typedef struct lb_marker lb_marker;
+
+#define LB_GREEN 0
+#define LB_YELLOW 1
+#define LB_RED 2
+
+  lb_marker *lb_srtcm_create(long long cir, long long cbs, long long ebs);
+  lb_marker *lb_trtcm_create(long long cir, long long cbs, long long pir, long long pbs);
+  void lb_marker_destroy(lb_marker *marker);
+
+  // Color a packet of size bytes. Pass LB_GREEN for color-blind marking,
+  // or the color set upstream for color-aware marking.
+  int lb_mark(lb_marker *marker, long long size, int color_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
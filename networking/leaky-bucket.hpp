@@ -0,0 +1,572 @@
+#ifndef LEAKY_BUCKET_HPP
+#define LEAKY_BUCKET_HPP
+
+// Header-only leaky bucket core shared by the fixed and variable buckets.
+//
+//   LeakyBucket<Clock, RatePolicy, LevelT>
+//
+// Clock      - where time comes from (WallClock, SteadyClock, ManualClock)
+// RatePolicy - StaticRate, or one of the dynamic policies that mirror
+//              variable-leaky-bucket.c (AdaptiveRate, ScheduledRate,
+//              LoadBasedRate, PriorityRate)
+// LevelT     - int for whole packets, Fixed<N> for fractional levels
+//
+// Everything is resolved at compile time: with StaticRate and int levels
+// add_packet() is a clock read, a multiply, a clamp and a compare.
+//
+// SrTcm<Clock> and TrTcm<Clock> are three-color markers on the same clocks
+// (RFC 2697 single rate, RFC 2698 two rate): instead of accept/drop they
+// color each packet green, yellow or red.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <type_traits>
+
+#include "rate-schedule.h"
+
+namespace leaky
+{
+
+// Wall clock in whole seconds, the granularity used by the C programs
+struct WallClock
+{
+  using rep = std::int64_t;
+  static constexpr rep ticks_per_second = 1;
+
+  rep now() const { return static_cast<rep>(std::time(nullptr)); }
+};
+
+// Monotonic nanosecond clock
+struct SteadyClock
+{
+  using rep = std::int64_t;
+  static constexpr rep ticks_per_second = 1000000000;
+
+  rep now() const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+};
+
+// Clock advanced by the caller, for simulations and trace replays
+template <std::int64_t TicksPerSecond = 1>
+struct ManualClock
+{
+  using rep = std::int64_t;
+  static constexpr rep ticks_per_second = TicksPerSecond;
+
+  rep ticks = 0;
+
+  rep now() const { return ticks; }
+  void advance(rep n) { ticks += n; }
+};
+
+// Signed fixed-point level with FracBits fractional bits
+template <int FracBits>
+struct Fixed
+{
+  static constexpr std::int64_t one = std::int64_t(1) << FracBits;
+
+  std::int64_t raw = 0;
+
+  constexpr Fixed() = default;
+  constexpr Fixed(int whole) : raw(std::int64_t(whole) * one) {}
+
+  static constexpr Fixed from_raw(std::int64_t r)
+  {
+    Fixed f;
+    f.raw = r;
+    return f;
+  }
+
+  constexpr int to_int() const { return static_cast<int>(raw >> FracBits); }
+  constexpr double to_double() const { return double(raw) / double(one); }
+
+  constexpr Fixed &operator+=(Fixed o)
+  {
+    raw += o.raw;
+    return *this;
+  }
+  constexpr Fixed &operator-=(Fixed o)
+  {
+    raw -= o.raw;
+    return *this;
+  }
+  friend constexpr Fixed operator+(Fixed a, Fixed b) { return from_raw(a.raw + b.raw); }
+  friend constexpr Fixed operator-(Fixed a, Fixed b) { return from_raw(a.raw - b.raw); }
+  friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+  friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+  friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+  friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+  friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+  friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+};
+
+template <class T>
+struct is_fixed : std::false_type
+{
+};
+
+template <int FracBits>
+struct is_fixed<Fixed<FracBits>> : std::true_type
+{
+};
+
+// Level as a fraction of capacity, used by the adaptive policy
+template <class LevelT>
+inline double fill_fraction(LevelT level, LevelT capacity)
+{
+  if constexpr (is_fixed<LevelT>::value)
+    return level.to_double() / capacity.to_double();
+  else
+    return double(level) / double(capacity);
+}
+
+// Inputs a dynamic rate policy may look at before each packet
+struct RateContext
+{
+  double fill;          // current_level / capacity
+  int priority;         // 1=high .. 4=low
+  std::int64_t seconds; // Clock reading in seconds
+};
+
+// Constant leak rate (fixed-leaky-bucket.c)
+struct StaticRate
+{
+  static constexpr bool is_dynamic = false;
+
+  int base;
+
+  explicit StaticRate(int base_rate) : base(base_rate) {}
+  int rate() const { return base; }
+  bool update(const RateContext &) { return false; }
+};
+
+// Rate follows the fill level, see adaptive_leak_rate()
+struct AdaptiveRate
+{
+  static constexpr bool is_dynamic = true;
+
+  int base;
+  int current;
+
+  explicit AdaptiveRate(int base_rate) : base(base_rate), current(base_rate) {}
+  int rate() const { return current; }
+
+  bool update(const RateContext &ctx)
+  {
+    int old = current;
+    if (ctx.fill > 0.8)
+      current = base * 3;
+    else if (ctx.fill > 0.6)
+      current = base * 2;
+    else if (ctx.fill > 0.4)
+      current = static_cast<int>(base * 1.5);
+    else if (ctx.fill < 0.2)
+      current = static_cast<int>(base * 0.7);
+    else
+      current = base;
+    return old != current;
+  }
+};
+
+// Rate follows a compiled weekly schedule (rate-schedule.h), exactly like
+// scheduled_leak_rate(). The schedule is the caller's and must outlive the
+// policy; without one the base rate applies. Needs a clock that reads
+// wall-clock time (WallClock, or a ManualClock set to epoch times).
+struct ScheduledRate
+{
+  static constexpr bool is_dynamic = true;
+
+  int base;
+  int current;
+  const WeekSchedule *schedule = nullptr;
+  ScheduleCursor cursor{};
+
+  explicit ScheduledRate(int base_rate) : base(base_rate), current(base_rate) {}
+  int rate() const { return current; }
+
+  // Call again after changing the table, it drops the cached transition
+  void set_schedule(const WeekSchedule *week)
+  {
+    schedule = week;
+    schedule_cursor_reset(&cursor);
+  }
+
+  bool update(const RateContext &ctx)
+  {
+    int old = current;
+    current = schedule != nullptr
+                  ? schedule_rate(schedule, &cursor, static_cast<time_t>(ctx.seconds))
+                  : base;
+    return old != current;
+  }
+};
+
+// Rate follows a simulated system load, see load_based_leak_rate()
+struct LoadBasedRate
+{
+  static constexpr bool is_dynamic = true;
+
+  int base;
+  int current;
+  int load = 50;
+
+  explicit LoadBasedRate(int base_rate) : base(base_rate), current(base_rate) {}
+  int rate() const { return current; }
+
+  bool update(const RateContext &)
+  {
+    int old = current;
+    load += std::rand() % 21 - 10;
+    if (load < 0)
+      load = 0;
+    if (load > 100)
+      load = 100;
+
+    if (load > 80)
+      current = 1;
+    else if (load > 60)
+      current = static_cast<int>(base * 0.7);
+    else if (load > 40)
+      current = base;
+    else if (load > 20)
+      current = static_cast<int>(base * 1.5);
+    else
+      current = base * 2;
+    return old != current;
+  }
+};
+
+// Rate follows the packet priority, see priority_leak_rate()
+struct PriorityRate
+{
+  static constexpr bool is_dynamic = true;
+
+  int base;
+  int current;
+
+  explicit PriorityRate(int base_rate) : base(base_rate), current(base_rate) {}
+  int rate() const { return current; }
+
+  bool update(const RateContext &ctx)
+  {
+    int old = current;
+    switch (ctx.priority)
+    {
+    case 1:
+      current = base * 3;
+      break;
+    case 2:
+      current = base * 2;
+      break;
+    case 4:
+      current = static_cast<int>(base * 0.5);
+      break;
+    default:
+      current = base;
+    }
+    return old != current;
+  }
+};
+
+template <class Clock, class RatePolicy = StaticRate, class LevelT = int>
+class LeakyBucket
+{
+public:
+  using level_type = LevelT;
+  using time_type = typename Clock::rep;
+
+  static constexpr time_type ticks_per_second = Clock::ticks_per_second;
+
+  LeakyBucket(LevelT capacity, int base_rate, Clock clock = Clock())
+      : clock_(clock), policy_(base_rate), capacity_(capacity), level_(),
+        last_leak_(clock_.now())
+  {
+  }
+
+  // Drain according to the time since the last leak, returns the amount
+  LevelT leak()
+  {
+    time_type now = clock_.now();
+    time_type elapsed = now - last_leak_;
+    if (elapsed <= 0)
+    {
+      return LevelT();
+    }
+
+    int rate = policy_.rate();
+    LevelT leaked;
+
+    if constexpr (is_fixed<LevelT>::value)
+    {
+      __int128 raw = (__int128)elapsed * rate * LevelT::one / ticks_per_second;
+      leaked = raw > level_.raw ? level_ : LevelT::from_raw(std::int64_t(raw));
+      last_leak_ = now;
+    }
+    else if constexpr (ticks_per_second == 1)
+    {
+      leaked = static_cast<LevelT>(elapsed * rate);
+      if (leaked > level_)
+        leaked = level_;
+      last_leak_ = now;
+    }
+    else
+    {
+      // Whole packets from a fine clock: keep the unspent fraction of time
+      std::int64_t whole = std::int64_t(elapsed) * rate / ticks_per_second;
+      if (whole >= level_ || rate == 0)
+      {
+        leaked = whole >= level_ ? level_ : LevelT();
+        last_leak_ = now;
+      }
+      else
+      {
+        leaked = static_cast<LevelT>(whole);
+        last_leak_ += static_cast<time_type>(whole * ticks_per_second / rate);
+      }
+    }
+
+    level_ -= leaked;
+    return leaked;
+  }
+
+  // Offer a packet, returns true if it fits
+  bool add_packet(LevelT size, int priority = 3)
+  {
+    if constexpr (RatePolicy::is_dynamic)
+    {
+      RateContext ctx{fill_fraction(level_, capacity_), priority,
+                      static_cast<std::int64_t>(clock_.now() / ticks_per_second)};
+      if (policy_.update(ctx))
+      {
+        rate_changes_++;
+      }
+    }
+
+    leak();
+
+    if (level_ + size <= capacity_)
+    {
+      level_ += size;
+      return true;
+    }
+    return false;
+  }
+
+  // Empty the bucket and restart the leak clock
+  void reset()
+  {
+    level_ = LevelT();
+    last_leak_ = clock_.now();
+    rate_changes_ = 0;
+  }
+
+  // Carry state over from another bucket (e.g. when switching policy)
+  void restore(LevelT level, time_type last_leak)
+  {
+    level_ = level;
+    last_leak_ = last_leak;
+  }
+
+  void set_capacity(LevelT capacity) { capacity_ = capacity; }
+  void set_base_rate(int base_rate) { policy_ = RatePolicy(base_rate); }
+
+  LevelT level() const { return level_; }
+  LevelT capacity() const { return capacity_; }
+  int rate() const { return policy_.rate(); }
+  int rate_changes() const { return rate_changes_; }
+  time_type last_leak() const { return last_leak_; }
+  Clock &clock() { return clock_; }
+  RatePolicy &policy() { return policy_; }
+
+private:
+  Clock clock_;
+  RatePolicy policy_;
+  LevelT capacity_;
+  LevelT level_;
+  time_type last_leak_;
+  int rate_changes_ = 0;
+};
+
+// ---------- Three-color markers (RFC 2697 / RFC 2698) ----------
+
+enum class Color : std::uint8_t
+{
+  Green = 0,
+  Yellow = 1,
+  Red = 2,
+};
+
+// Both buckets of a marker and their refill time, packed into half a cache
+// line. Token counts are in bytes * ticks_per_second, so a refill is one
+// multiply per bucket with no remainder to carry.
+struct alignas(32) MarkerState
+{
+  std::int64_t last; // Clock reading of the last refill
+  std::int64_t c;    // Committed bucket Tc
+  std::int64_t e;    // Excess bucket Te (srTCM) or peak bucket Tp (trTCM)
+};
+
+// Ticks after which every bucket refilling at rate is full anyway; longer
+// gaps are clamped to it so elapsed * rate cannot overflow
+inline std::int64_t marker_fill_ticks(std::int64_t burst, std::int64_t rate)
+{
+  return rate > 0 ? burst / rate + 1 : 0;
+}
+
+// Single rate three color marker (RFC 2697). Tokens arrive at CIR; they
+// fill the committed bucket (CBS) first and overflow into the excess
+// bucket (EBS). Green fits Tc, yellow fits Te, red fits neither.
+template <class Clock>
+class SrTcm
+{
+public:
+  using time_type = typename Clock::rep;
+
+  static constexpr time_type ticks_per_second = Clock::ticks_per_second;
+
+  // Rates in bytes per second, bursts in bytes. Both buckets start full.
+  SrTcm(std::int64_t cir, std::int64_t cbs, std::int64_t ebs, Clock clock = Clock())
+      : clock_(clock), cir_(cir), cbs_(cbs * ticks_per_second),
+        ebs_(ebs * ticks_per_second), fill_ticks_(marker_fill_ticks(cbs_ + ebs_, cir))
+  {
+    state_.last = clock_.now();
+    state_.c = cbs_;
+    state_.e = ebs_;
+  }
+
+  // Color a packet. Color-blind callers leave in as Green; color-aware
+  // callers pass the color set upstream, which can only get worse here.
+  Color mark(std::int64_t size, Color in = Color::Green)
+  {
+    refill();
+    std::int64_t need = size * ticks_per_second;
+
+    if (in == Color::Green && state_.c >= need)
+    {
+      state_.c -= need;
+      return Color::Green;
+    }
+    if (in != Color::Red && state_.e >= need)
+    {
+      state_.e -= need;
+      return Color::Yellow;
+    }
+    return Color::Red;
+  }
+
+  std::int64_t committed_tokens() const { return state_.c / ticks_per_second; }
+  std::int64_t excess_tokens() const { return state_.e / ticks_per_second; }
+  const MarkerState &state() const { return state_; }
+  Clock &clock() { return clock_; }
+
+private:
+  void refill()
+  {
+    time_type now = clock_.now();
+    std::int64_t elapsed = now - state_.last;
+    state_.last = now;
+    if (elapsed > fill_ticks_)
+      elapsed = fill_ticks_;
+    if (elapsed < 0)
+      elapsed = 0;
+
+    std::int64_t c = state_.c + elapsed * cir_;
+    if (c > cbs_)
+    {
+      std::int64_t e = state_.e + (c - cbs_);
+      state_.e = e < ebs_ ? e : ebs_;
+      c = cbs_;
+    }
+    state_.c = c;
+  }
+
+  Clock clock_;
+  std::int64_t cir_;
+  std::int64_t cbs_;
+  std::int64_t ebs_;
+  std::int64_t fill_ticks_;
+  MarkerState state_;
+};
+
+// Two rate three color marker (RFC 2698). The peak bucket (PIR, PBS) and
+// the committed bucket (CIR, CBS) refill independently. Red exceeds the
+// peak, yellow stays within the peak but exceeds the committed rate.
+template <class Clock>
+class TrTcm
+{
+public:
+  using time_type = typename Clock::rep;
+
+  static constexpr time_type ticks_per_second = Clock::ticks_per_second;
+
+  TrTcm(std::int64_t cir, std::int64_t cbs, std::int64_t pir, std::int64_t pbs,
+        Clock clock = Clock())
+      : clock_(clock), cir_(cir), cbs_(cbs * ticks_per_second), pir_(pir),
+        pbs_(pbs * ticks_per_second)
+  {
+    std::int64_t c_fill = marker_fill_ticks(cbs_, cir);
+    std::int64_t p_fill = marker_fill_ticks(pbs_, pir);
+    fill_ticks_ = c_fill > p_fill ? c_fill : p_fill;
+    state_.last = clock_.now();
+    state_.c = cbs_;
+    state_.e = pbs_;
+  }
+
+  Color mark(std::int64_t size, Color in = Color::Green)
+  {
+    refill();
+    std::int64_t need = size * ticks_per_second;
+
+    if (in == Color::Red || state_.e < need)
+    {
+      return Color::Red;
+    }
+    state_.e -= need;
+    if (in == Color::Yellow || state_.c < need)
+    {
+      return Color::Yellow;
+    }
+    state_.c -= need;
+    return Color::Green;
+  }
+
+  std::int64_t committed_tokens() const { return state_.c / ticks_per_second; }
+  std::int64_t peak_tokens() const { return state_.e / ticks_per_second; }
+  const MarkerState &state() const { return state_; }
+  Clock &clock() { return clock_; }
+
+private:
+  void refill()
+  {
+    time_type now = clock_.now();
+    std::int64_t elapsed = now - state_.last;
+    state_.last = now;
+    if (elapsed > fill_ticks_)
+      elapsed = fill_ticks_;
+    if (elapsed < 0)
+      elapsed = 0;
+
+    std::int64_t c = state_.c + elapsed * cir_;
+    std::int64_t p = state_.e + elapsed * pir_;
+    state_.c = c < cbs_ ? c : cbs_;
+    state_.e = p < pbs_ ? p : pbs_;
+  }
+
+  Clock clock_;
+  std::int64_t cir_;
+  std::int64_t cbs_;
+  std::int64_t pir_;
+  std::int64_t pbs_;
+  std::int64_t fill_ticks_;
+  MarkerState state_;
+};
+
+} // namespace leaky
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+// USDT (user-level statically defined tracing) probes for the buckets.
+//
+// Each probe compiles to a single nop plus an ELF note describing where
+// its arguments live; nothing runs until a tracer such as bpftrace or perf
+// attaches to it, so they stay in production builds. See bpftrace/ for
+// sample scripts. Provider name: leakybucket.
+//
+//   accept(flow, size, level, rate)        packet admitted, level after it
+//   drop(flow, size, level, rate, reason)  packet refused, DROP_* reason
+//   leak(leaked, level, rate)              level drained by the leak
+//   rate_change(old_rate, new_rate, mode)  leak rate switched
+//   dequeue(id, size, sojourn_us, queued)  shaper sent a packet
+//
+// "flow" identifies the traffic: 0 in the fixed bucket (a single flow),
+// the packet priority in the variable bucket and the packet id in the
+// queue shaper. "rate" is the leak rate in packets per second, or the
+// counter reset value n per tick for the shaper. "level" is the bucket
+// level, or the queue length for the shaper.
+//
+// Uses <sys/sdt.h> from systemtap (package systemtap-sdt-dev or
+// systemtap-sdt-devel); without it, or with -DLEAKY_BUCKET_NO_PROBES, the
+// probes compile to nothing.
+
+#define DROP_OVERFLOW 0 // Bucket or queue full
+#define DROP_AQM_EARLY 1 // AQM dropped on enqueue (RED, PIE)
+#define DROP_AQM_SOJOURN 2 // AQM dropped on dequeue (CoDel)
+
+#if !defined(LEAKY_BUCKET_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LEAKY_BUCKET_PROBES 1
+#endif
+#endif
+
+#ifdef LEAKY_BUCKET_PROBES
+#define PROBE_ACCEPT(flow, size, level, rate) \
+  DTRACE_PROBE4(leakybucket, accept, flow, size, level, rate)
+#define PROBE_DROP(flow, size, level, rate, reason) \
+  DTRACE_PROBE5(leakybucket, drop, flow, size, level, rate, reason)
+#define PROBE_LEAK(leaked, level, rate) \
+  DTRACE_PROBE3(leakybucket, leak, leaked, level, rate)
+#define PROBE_RATE_CHANGE(old_rate, new_rate, mode) \
+  DTRACE_PROBE3(leakybucket, rate_change, old_rate, new_rate, mode)
+#define PROBE_DEQUEUE(id, size, sojourn_us, queued) \
+  DTRACE_PROBE4(leakybucket, dequeue, id, size, sojourn_us, queued)
+#else
+#define PROBE_ACCEPT(flow, size, level, rate) ((void)0)
+#define PROBE_DROP(flow, size, level, rate, reason) ((void)0)
+#define PROBE_LEAK(leaked, level, rate) ((void)0)
+#define PROBE_RATE_CHANGE(old_rate, new_rate, mode) ((void)0)
+#define PROBE_DEQUEUE(id, size, sojourn_us, queued) ((void)0)
+#endif
+
+#endif
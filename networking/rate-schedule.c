@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rate-schedule.h"
+
+#define MINUTES_PER_DAY (24 * 60)
+
+static const char *day_names[7] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+
+// Day index 0..6 for a three-letter name, -1 if unknown
+static int parse_day(const char *text, int length)
+{
+  if (length != 3)
+  {
+    return -1;
+  }
+  for (int d = 0; d < 7; d++)
+  {
+    if (strncmp(text, day_names[d], 3) == 0)
+    {
+      return d;
+    }
+  }
+  return -1;
+}
+
+// "mon-fri", "sat,sun", "mon,wed-fri", "fri-mon" or "*"
+static int parse_days(const char *text, int *days)
+{
+  *days = 0;
+  if (strcmp(text, "*") == 0)
+  {
+    *days = 0x7f;
+    return 1;
+  }
+
+  while (*text != '\0')
+  {
+    int first = parse_day(text, strcspn(text, ",-"));
+    if (first < 0)
+    {
+      return 0;
+    }
+    text += 3;
+
+    int last = first;
+    if (*text == '-')
+    {
+      last = parse_day(text + 1, strcspn(text + 1, ","));
+      if (last < 0)
+      {
+        return 0;
+      }
+      text += 4;
+    }
+
+    // Ranges may wrap around the weekend (fri-mon)
+    for (int d = first;; d = (d + 1) % 7)
+    {
+      *days |= 1 << d;
+      if (d == last)
+        break;
+    }
+
+    if (*text == ',')
+    {
+      text++;
+    }
+    else if (*text != '\0')
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// "HH:MM", 24:00 allowed only when allow_end is set
+static int parse_clock(const char *text, int allow_end, int *minutes)
+{
+  int hours, mins, used;
+
+  if (sscanf(text, "%2d:%2d%n", &hours, &mins, &used) != 2 || used != 5 ||
+      mins < 0 || mins > 59 || hours < 0 || hours > 24 ||
+      (hours == 24 && (mins != 0 || !allow_end)))
+  {
+    return 0;
+  }
+  *minutes = hours * 60 + mins;
+  return 1;
+}
+
+int schedule_parse_window(char *text, ScheduleWindow *window)
+{
+  char *days = strtok(text, " \t");
+  char *times = strtok(NULL, " \t");
+  char *rate = strtok(NULL, " \t");
+  char *end;
+
+  if (days == NULL || times == NULL || rate == NULL || strtok(NULL, " \t") != NULL)
+  {
+    return 0;
+  }
+  if (!parse_days(days, &window->days))
+  {
+    return 0;
+  }
+  if (strlen(times) != 11 || times[5] != '-' || !parse_clock(times, 0, &window->start) ||
+      !parse_clock(times + 6, 1, &window->end))
+  {
+    return 0;
+  }
+  if (strncmp(rate, "rate=", 5) != 0)
+  {
+    return 0;
+  }
+  window->rate = (int)strtol(rate + 5, &end, 10);
+  return end != rate + 5 && *end == '\0' && window->rate >= 0;
+}
+
+int schedule_compile(WeekSchedule *schedule, const ScheduleWindow *windows,
+                     int num_windows, int base_rate)
+{
+  // Paint the week minute by minute, then keep only the changes. Runs once
+  // per config load, so simplicity beats cleverness here.
+  int *week = malloc(SCHEDULE_MINUTES_PER_WEEK * sizeof(int));
+  if (week == NULL)
+  {
+    return 0;
+  }
+  for (int m = 0; m < SCHEDULE_MINUTES_PER_WEEK; m++)
+  {
+    week[m] = base_rate;
+  }
+
+  for (int w = 0; w < num_windows; w++)
+  {
+    const ScheduleWindow *win = &windows[w];
+    int length = win->end > win->start ? win->end - win->start
+                                       : win->end + MINUTES_PER_DAY - win->start;
+
+    for (int d = 0; d < 7; d++)
+    {
+      if (!(win->days & (1 << d)))
+      {
+        continue;
+      }
+      // A window running past midnight on Sunday continues on Monday
+      int start = d * MINUTES_PER_DAY + win->start;
+      for (int m = 0; m < length; m++)
+      {
+        week[(start + m) % SCHEDULE_MINUTES_PER_WEEK] = win->rate;
+      }
+    }
+  }
+
+  int n = 0;
+  for (int m = 0; m < SCHEDULE_MINUTES_PER_WEEK; m++)
+  {
+    if (m > 0 && week[m] == week[m - 1])
+    {
+      continue;
+    }
+    if (n == SCHEDULE_MAX_TRANSITIONS)
+    {
+      free(week);
+      return 0;
+    }
+    schedule->minute[n] = m;
+    schedule->rate[n] = week[m];
+    n++;
+  }
+  schedule->num_transitions = n;
+  schedule->timezone[0] = '\0';
+
+  free(week);
+  return 1;
+}
+
+void schedule_use_timezone(const WeekSchedule *schedule)
+{
+  // Empty keeps whatever zone the process started with
+  if (schedule->timezone[0] != '\0')
+  {
+    setenv("TZ", schedule->timezone, 1);
+    tzset();
+  }
+}
+
+int schedule_seek(const WeekSchedule *schedule, ScheduleCursor *cursor, time_t now)
+{
+  struct tm local;
+  localtime_r(&now, &local);
+  int minute = ((local.tm_wday + 6) % 7) * MINUTES_PER_DAY + local.tm_hour * 60 + local.tm_min;
+
+  // Last transition at or before this minute
+  int lo = 0, hi = schedule->num_transitions - 1;
+  while (lo < hi)
+  {
+    int mid = (lo + hi + 1) / 2;
+    if (schedule->minute[mid] <= minute)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  int next_minute = lo + 1 < schedule->num_transitions ? schedule->minute[lo + 1]
+                                                       : SCHEDULE_MINUTES_PER_WEEK;
+
+  // Let mktime() turn the local wall-clock time of the next transition
+  // into an absolute time, which gets daylight saving changes right
+  local.tm_min += next_minute - minute;
+  local.tm_sec = 0;
+  local.tm_isdst = -1;
+  time_t next = mktime(&local);
+
+  cursor->index = lo;
+  cursor->rate = schedule->rate[lo];
+  cursor->next_change = next > now ? next : now + 60;
+  return cursor->rate;
+}
+
+void schedule_print(const WeekSchedule *schedule)
+{
+  printf("Rate schedule (%s):\n",
+         schedule->timezone[0] != '\0' ? schedule->timezone : "local time");
+  for (int i = 0; i < schedule->num_transitions; i++)
+  {
+    int m = schedule->minute[i];
+    printf("  %s %02d:%02d  rate %d\n", day_names[m / MINUTES_PER_DAY],
+           m % MINUTES_PER_DAY / 60, m % 60, schedule->rate[i]);
+  }
+}
@@ -0,0 +1,98 @@
+#ifndef RATE_SCHEDULE_H
+#define RATE_SCHEDULE_H
+
+// Weekly leak-rate schedule for the scheduled mode of the variable bucket.
+//
+// Windows are read from the config file, one per line:
+//
+//   window mon-fri 09:00-17:00 rate=6
+//   window sat,sun 00:00-24:00 rate=2
+//   window * 22:00-06:00 rate=1      # wraps past midnight
+//
+// Days are mon..sun, ranges and lists of them, or * for every day. Later
+// windows win where they overlap; time not covered by any window leaks at
+// the base rate. Times are local time in the configured time zone.
+//
+// Windows are compiled once into a sorted table of rate transitions over
+// the week. At run time a cursor caches the current rate and the absolute
+// time of the next transition, so the per-packet check is one compare; the
+// table is only searched (and the time zone consulted) when that time
+// passes.
+
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SCHEDULE_MAX_TRANSITIONS 256
+#define SCHEDULE_MINUTES_PER_WEEK (7 * 24 * 60)
+
+// One "window" line as written in the config
+typedef struct
+{
+  int days;  // Bit 0 = Monday .. bit 6 = Sunday
+  int start; // Minutes after midnight
+  int end;   // Minutes after midnight, at most 24:00; <= start wraps
+  int rate;
+} ScheduleWindow;
+
+// Compiled schedule: rate[i] applies from minute[i] (minutes after Monday
+// 00:00) until minute[i + 1]. minute[0] is always 0.
+typedef struct
+{
+  int num_transitions;
+  int minute[SCHEDULE_MAX_TRANSITIONS];
+  int rate[SCHEDULE_MAX_TRANSITIONS];
+  char timezone[64]; // TZ name, empty for the system zone
+} WeekSchedule;
+
+// Cached position in a schedule
+typedef struct
+{
+  time_t next_change; // Absolute time the rate changes next
+  int rate;
+  int index;          // Entry of the table in effect
+} ScheduleCursor;
+
+// Parse the part of a window line after "window", returns 1 on success
+int schedule_parse_window(char *text, ScheduleWindow *window);
+
+// Compile windows into a transition table, base_rate filling the gaps.
+// Returns 0 if there are more transitions than fit.
+int schedule_compile(WeekSchedule *schedule, const ScheduleWindow *windows,
+                     int num_windows, int base_rate);
+
+// Make the schedule's time zone the local one. TZ is process-wide, so call
+// this from the thread that reads the schedule, not the config watcher.
+void schedule_use_timezone(const WeekSchedule *schedule);
+
+// Force the next schedule_rate() call to look the rate up again
+static inline void schedule_cursor_reset(ScheduleCursor *cursor)
+{
+  cursor->next_change = 0;
+}
+
+// Slow path: find the entry for now and the time of the next transition
+int schedule_seek(const WeekSchedule *schedule, ScheduleCursor *cursor, time_t now);
+
+// Leak rate at time now
+static inline int schedule_rate(const WeekSchedule *schedule, ScheduleCursor *cursor,
+                                time_t now)
+{
+  if (now < cursor->next_change)
+  {
+    return cursor->rate;
+  }
+  return schedule_seek(schedule, cursor, now);
+}
+
+// Print the table, one line per transition
+void schedule_print(const WeekSchedule *schedule);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+// Build: gcc recorder-dump.c flight-recorder.c -o recorder-dump -pthread
+// Usage: ./recorder-dump <recording> [thread]
+//
+// Writes a flight recorder file as CSV on stdout, oldest sample first,
+// optionally only the samples of one thread. A summary goes to stderr.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "flight-recorder.h"
+
+typedef struct
+{
+  int thread; // -1 = all
+  long written;
+  int64_t first_us;
+  int64_t last_us;
+} DumpState;
+
+void write_sample(void *arg, int thread, const RecorderSample *s)
+{
+  DumpState *state = arg;
+
+  if (state->thread >= 0 && thread != state->thread)
+  {
+    return;
+  }
+  if (state->written == 0 || s->time_us < state->first_us)
+  {
+    state->first_us = s->time_us;
+  }
+  if (state->written == 0 || s->time_us > state->last_us)
+  {
+    state->last_us = s->time_us;
+  }
+  state->written++;
+
+  printf("%d,%lld,%d,%d,%u,%u\n", thread, (long long)s->time_us, s->level, s->rate,
+         s->accepted, s->dropped);
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: %s <recording> [thread]\n", argv[0]);
+    return 1;
+  }
+
+  DumpState state = {argc > 2 ? atoi(argv[2]) : -1, 0, 0, 0};
+
+  printf("thread,time_us,level,rate,accepted,dropped\n");
+  long total = recorder_read(argv[1], write_sample, &state);
+  if (total < 0)
+  {
+    fprintf(stderr, "%s: not a flight recorder file\n", argv[1]);
+    return 1;
+  }
+
+  fprintf(stderr, "%ld samples written (%ld in file), %.1f s of history\n", state.written,
+          total, (state.last_us - state.first_us) / 1e6);
+  return 0;
+}
@@ -0,0 +1,69 @@
+# Pure-Python vs native (leaky-bucket-native.c) leaky bucket
+#
+# Build the extension first, see the top of leaky-bucket-native.c
+# Usage: python3 simple-leaky-bucket-bench.py [packets]
+
+import importlib.util
+import os
+import random
+import sys
+import time
+from array import array
+
+import leakybucket
+
+# The pure version lives in a file with dashes in its name
+here = os.path.dirname(os.path.abspath(__file__))
+spec = importlib.util.spec_from_file_location("simple_leaky_bucket",
+                                              os.path.join(here, "simple-leaky-bucket.py"))
+pure = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(pure)
+
+def run_pure(sizes, ids):
+    pure.MAX_QUEUE_SIZE = len(sizes)
+    pure.packet_queue.clear()
+    start = time.perf_counter()
+    for size, packet_id in zip(sizes, ids):
+        pure.enqueue_packet(size, packet_id, verbose=False)
+    enqueued = time.perf_counter()
+    ticks, sent = pure.leaky_bucket_algorithm(verbose=False, tick_delay=0)
+    done = time.perf_counter()
+    return ticks, sent, enqueued - start, done - enqueued
+
+def run_native(sizes, ids, batch):
+    leakybucket.configure(bucket_size=pure.BUCKET_SIZE, max_queue_size=len(sizes))
+    start = time.perf_counter()
+    if batch:
+        leakybucket.enqueue_batch(sizes, ids)
+    else:
+        for size, packet_id in zip(sizes, ids):
+            leakybucket.enqueue_packet(size, packet_id)
+    enqueued = time.perf_counter()
+    ticks, sent = leakybucket.leaky_bucket_algorithm()
+    done = time.perf_counter()
+    return ticks, sent, enqueued - start, done - enqueued
+
+def main():
+    n = int(sys.argv[1]) if len(sys.argv) > 1 else 1000000
+    random.seed(7)
+    sizes = array("i", (random.randint(1, pure.BUCKET_SIZE) for _ in range(n)))
+    ids = array("q", range(1, n + 1))
+
+    print(f"=== Leaky Bucket: pure Python vs native ({n} packets) ===\n")
+
+    p_ticks, p_sent, p_enqueue, p_loop = run_pure(sizes, ids)
+    print(f"{'pure Python':<22} enqueue {p_enqueue:7.3f}s  tick loop {p_loop:7.3f}s  ({p_ticks} ticks)")
+
+    # Flatten the pure schedule the same way the native one is laid out
+    expected = array("q", (v for record in p_sent for v in record))
+
+    for name, batch in (("native, per packet", False), ("native, batch", True)):
+        ticks, sent, enqueue, loop = run_native(sizes, ids, batch)
+        same = ticks == p_ticks and memoryview(sent).cast("q") == memoryview(expected)
+        print(f"{name:<22} enqueue {enqueue:7.3f}s  tick loop {loop:7.3f}s  "
+              f"enqueue {p_enqueue / enqueue:6.0f}x  loop {p_loop / loop:6.0f}x  "
+              f"total {(p_enqueue + p_loop) / (enqueue + loop):6.0f}x  "
+              f"{'same schedule' if same else 'DIFFERENT'}")
+
+if __name__ == "__main__":
+    main()
@@ -1,15 +1,26 @@
+// Build: gcc simple-leaky-bucket.c bucket-config.c rate-schedule.c aqm.c -o simple-leaky-bucket -pthread -lm
+// Usage: ./simple-leaky-bucket [config-file]
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
-#define MAX_QUEUE_SIZE 20
+#include "aqm.h"
+#include "bucket-config.h"
+#include "probes.h"
+
+#define MAX_QUEUE_SIZE 20 // Storage for the queue, upper bound for the limit
 #define BUCKET_SIZE 10
+#define TICK_SECONDS 2
+#define AQM_TIME_SCALE 400 // 2 s ticks: the CoDel target becomes one tick
 
 // Simple packet structure
 typedef struct
 {
   int size;
   int id;
+  long long enqueue_us; // When it joined the queue
 } Packet;
 
 // Simple queue for packets
@@ -18,21 +29,73 @@ int queue_front = 0;
 int queue_rear = 0;
 int queue_count = 0;
 
+// Runtime parameters, replaced when the config file is reloaded
+int bucket_size = BUCKET_SIZE;
+int queue_limit = MAX_QUEUE_SIZE;
+int aqm_policy = AQM_TAIL_DROP;
+Aqm aqm;
+unsigned long applied_generation = 0;
+int config_reader = -1;
+
+// Monotonic time in microseconds, for packet timestamps
+long long now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Pick up a reloaded configuration (one atomic load, never blocks)
+void apply_config()
+{
+  const BucketConfig *cfg = config_current();
+
+  if (cfg != NULL && cfg->generation != applied_generation)
+  {
+    bucket_size = cfg->bucket_size;
+    queue_limit = cfg->max_queue_size < MAX_QUEUE_SIZE ? cfg->max_queue_size
+                                                       : MAX_QUEUE_SIZE;
+    if (cfg->aqm != aqm_policy || aqm.limit != queue_limit)
+    {
+      aqm_policy = cfg->aqm;
+      aqm_init(&aqm, aqm_policy, queue_limit, AQM_TIME_SCALE, now_us());
+    }
+    applied_generation = cfg->generation;
+    printf("CONFIG: Bucket size %d, queue limit %d, AQM %s\n", bucket_size,
+           queue_limit, aqm_name(aqm_policy));
+  }
+
+  // Done with the snapshot, the old one may now be freed
+  config_reader_quiescent(config_reader);
+}
+
 // Add packet to queue
 void enqueue_packet(int size, int id)
 {
-  if (queue_count < MAX_QUEUE_SIZE)
+  apply_config();
+  long long now = now_us();
+
+  if (!aqm_drop_on_enqueue(&aqm, queue_count, now))
   {
     queue[queue_rear].size = size;
     queue[queue_rear].id = id;
+    queue[queue_rear].enqueue_us = now;
     queue_rear = (queue_rear + 1) % MAX_QUEUE_SIZE;
     queue_count++;
+    PROBE_ACCEPT(id, size, queue_count, bucket_size);
     printf("Added packet %d (size %d) to queue no %d\n", id, size, queue_count);
   }
-  else
+  else if (queue_count >= queue_limit)
   {
+    PROBE_DROP(id, size, queue_count, bucket_size, DROP_OVERFLOW);
     printf("Queue full! Packet %d (size %d) dropped\n", id, size);
   }
+  else
+  {
+    PROBE_DROP(id, size, queue_count, bucket_size, DROP_AQM_EARLY);
+    printf("%s: Packet %d (size %d) dropped early, %d packets queued\n",
+           aqm_name(aqm_policy), id, size, queue_count);
+  }
 }
 
 // Remove packet from front of queue
@@ -89,14 +152,15 @@ void leaky_bucket_algorithm()
   int tick = 1;
 
   printf("\n=== Starting Leaky Bucket Algorithm ===\n");
-  printf("Bucket size (n): %d\n", BUCKET_SIZE);
+  printf("Bucket size (n): %d\n", bucket_size);
 
   while (queue_count > 0)
   { // Continue while packets exist
     printf("\n--- CLOCK TICK %d ---\n", tick);
 
     // Initialize counter to n at the tick of the clock
-    counter = BUCKET_SIZE;
+    apply_config();
+    counter = bucket_size;
     printf("Step: Initialize counter to n = %d\n", counter);
 
     // Step 1: Repeat until n is smaller than packet size at head of queue
@@ -124,9 +188,22 @@ void leaky_bucket_algorithm()
 
       // Step 1.1: Pop a packet out of the head of the queue
       Packet p = dequeue_packet();
-      printf("Step 1.1: Popped packet %d (size %d) from queue\n", p.id, p.size);
+      long long now = now_us();
+      long long sojourn = now - p.enqueue_us;
+      printf("Step 1.1: Popped packet %d (size %d) from queue after %.1f s\n",
+             p.id, p.size, sojourn / 1e6);
+
+      // The AQM may drop it here instead (CoDel), the counter is not charged
+      if (aqm_drop_on_dequeue(&aqm, sojourn, queue_count, now))
+      {
+        PROBE_DROP(p.id, p.size, queue_count, bucket_size, DROP_AQM_SOJOURN);
+        printf("%s: Packet %d dropped, it waited longer than the target\n",
+               aqm_name(aqm_policy), p.id);
+        continue;
+      }
 
       // Step 1.2: Send the packet into the network
+      PROBE_DEQUEUE(p.id, p.size, sojourn, queue_count);
       printf("Step 1.2: ");
       send_packet(p);
 
@@ -147,14 +224,23 @@ void leaky_bucket_algorithm()
     tick++;
 
     // Simulate clock tick delay
-    sleep(2);
+    sleep(TICK_SECONDS);
   }
 
   printf("\n=== Complete - All packets processed ===\n");
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+  aqm_init(&aqm, aqm_policy, queue_limit, AQM_TIME_SCALE, now_us());
+
+  // Load parameters from a config file and watch it for changes
+  config_reader = config_reader_register();
+  if (argc > 1 && config_load(argv[1]))
+  {
+    config_watch_start(argv[1]);
+  }
+
   enqueue_packet(3, 101); // Packet ID 101, size 3
   enqueue_packet(2, 102); // Packet ID 102, size 2
   enqueue_packet(5, 103); // Packet ID 103, size 5
@@ -170,5 +256,9 @@ int main()
   // Run the leaky bucket algorithm
   leaky_bucket_algorithm();
 
+  // Stop reading before the watcher can wait on us
+  config_reader_unregister(config_reader);
+  config_watch_stop();
+
   return 0;
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+import sys
 import time
 from collections import deque
 
@@ -11,14 +12,19 @@ def create_packet(size, packet_id):
     """Create a packet as a dictionary"""
     return {"size": size, "id": packet_id}
 
-def enqueue_packet(size, packet_id):
-    """Add packet to queue"""
+def quiet(*args, **kwargs):
+    """Stand-in for print when output is turned off"""
+
+def enqueue_packet(size, packet_id, verbose=True):
+    """Add packet to queue, returns True if it was accepted"""
+    log = print if verbose else quiet
     if len(packet_queue) < MAX_QUEUE_SIZE:
         packet = create_packet(size, packet_id)
         packet_queue.append(packet)
-        print(f"Added packet {packet_id} (size {size}) to queue no {len(packet_queue)}")
-    else:
-        print(f"Queue full! Packet {packet_id} (size {size}) dropped")
+        log(f"Added packet {packet_id} (size {size}) to queue no {len(packet_queue)}")
+        return True
+    log(f"Queue full! Packet {packet_id} (size {size}) dropped")
+    return False
 
 def dequeue_packet():
     """Remove packet from front of queue"""
@@ -33,77 +39,111 @@ def peek_packet():
         return packet_queue[0]
     return None  # Invalid packet indicator
 
-def send_packet(packet):
+def send_packet(packet, log=print):
     """Send packet into network (simulation)"""
-    print(f"SENT: Packet {packet['id']} (size {packet['size']}) into the network")
+    log(f"SENT: Packet {packet['id']} (size {packet['size']}) into the network")
 
-def show_queue_status():
+def show_queue_status(log=print):
     """Display current queue status"""
     queue_count = len(packet_queue)
-    print(f"Queue status: {queue_count} packets waiting")
+    log(f"Queue status: {queue_count} packets waiting")
     if queue_count > 0:
         next_packet = packet_queue[0]
-        print(f"Next packet: ID={next_packet['id']}, size={next_packet['size']}")
+        log(f"Next packet: ID={next_packet['id']}, size={next_packet['size']}")
+
+def leaky_bucket_algorithm(verbose=True, tick_delay=2):
+    """Main leaky bucket algorithm - following exact steps
 
-def leaky_bucket_algorithm():
-    """Main leaky bucket algorithm - following exact steps"""
+    Returns (ticks, sent) where sent lists (tick, id, size) for every
+    packet in the order it was sent.
+    """
+    log = print if verbose else quiet
+    sent = []
     tick = 1
     
-    print("\n=== Starting Leaky Bucket Algorithm ===")
-    print(f"Bucket size (n): {BUCKET_SIZE}")
+    log("\n=== Starting Leaky Bucket Algorithm ===")
+    log(f"Bucket size (n): {BUCKET_SIZE}")
     
     while len(packet_queue) > 0:  # Continue while packets exist
-        print(f"\n--- CLOCK TICK {tick} ---")
+        log(f"\n--- CLOCK TICK {tick} ---")
         
         # Initialize counter to n at the tick of the clock
         counter = BUCKET_SIZE
-        print(f"Step: Initialize counter to n = {counter}")
+        log(f"Step: Initialize counter to n = {counter}")
         
         # Step 1: Repeat until n is smaller than packet size at head of queue
         while True:
             # Check if queue is empty
             if len(packet_queue) == 0:
-                print("Queue is empty - no more packets to process")
+                log("Queue is empty - no more packets to process")
                 break
             
             # Check packet at head of queue
             head_packet = peek_packet()
             
-            print(f"Counter = {counter}, Head packet size = {head_packet['size']}")
+            log(f"Counter = {counter}, Head packet size = {head_packet['size']}")
             
             # Check condition: is counter smaller than packet size?
             if counter < head_packet['size']:
-                print(f"Counter ({counter}) < Packet size ({head_packet['size']}) - stopping this tick")
+                log(f"Counter ({counter}) < Packet size ({head_packet['size']}) - stopping this tick")
                 break  # Exit the repeat loop
             
             # Step 1.1: Pop a packet out of the head of the queue
             packet = dequeue_packet()
-            print(f"Step 1.1: Popped packet {packet['id']} (size {packet['size']}) from queue")
+            log(f"Step 1.1: Popped packet {packet['id']} (size {packet['size']}) from queue")
             
             # Step 1.2: Send the packet into the network
-            print("Step 1.2: ", end="")
-            send_packet(packet)
+            log("Step 1.2: ", end="")
+            send_packet(packet, log)
+            sent.append((tick, packet['id'], packet['size']))
             
             # Step 1.3: Decrement the counter by the size of packet
             counter = counter - packet['size']
-            print(f"Step 1.3: Decremented counter by {packet['size']}, new counter = {counter}")
+            log(f"Step 1.3: Decremented counter by {packet['size']}, new counter = {counter}")
             
-            print(f"\n\nRemaining packets in queue: {len(packet_queue)}")
+            log(f"\n\nRemaining packets in queue: {len(packet_queue)}")
         
         # Step 2: Reset counter and go to step 1 (next clock tick)
-        print("Step 2: Reset counter and wait for next clock tick")
+        log("Step 2: Reset counter and wait for next clock tick")
         
         # Show status before next tick
-        show_queue_status()
+        show_queue_status(log)
         
         tick += 1
         
         # Simulate clock tick delay
-        time.sleep(2)
+        if tick_delay > 0:
+            time.sleep(tick_delay)
     
-    print("\n=== Complete - All packets processed ===")
+    log("\n=== Complete - All packets processed ===")
+    return tick - 1, sent
+
+def native_main():
+    """Same run on the native backend (leaky-bucket-native.c)"""
+    import leakybucket
+
+    packets = [(3, 101), (2, 102), (5, 103), (4, 104), (1, 105), (6, 106), (3, 107), (7, 108)]
+    leakybucket.configure(bucket_size=BUCKET_SIZE, max_queue_size=MAX_QUEUE_SIZE)
+    for size, packet_id in packets:
+        if leakybucket.enqueue_packet(size, packet_id):
+            print(f"Added packet {packet_id} (size {size}) to queue no {leakybucket.queue_length()}")
+        else:
+            print(f"Queue full! Packet {packet_id} (size {size}) dropped")
+
+    print("\n=== Starting Leaky Bucket Algorithm (native) ===")
+    print(f"Bucket size (n): {BUCKET_SIZE}")
+    ticks, sent = leakybucket.leaky_bucket_algorithm(tick_delay=2)
+    records = memoryview(sent).cast("q")
+    for i in range(0, len(records), 3):
+        tick, packet_id, size = records[i:i + 3]
+        print(f"Tick {tick}: SENT: Packet {packet_id} (size {size}) into the network")
+    print(f"\n=== Complete - All packets processed in {ticks} ticks ===")
 
 def main():
+    if "--native" in sys.argv[1:]:
+        native_main()
+        return
+
     # Add packets to the queue
     enqueue_packet(3, 101)  # Packet ID 101, size 3
     enqueue_packet(2, 102)  # Packet ID 102, size 2
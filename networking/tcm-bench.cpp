@@ -0,0 +1,219 @@
+// Build: g++ -O2 -std=c++17 tcm-bench.cpp -o tcm-bench
+// Usage: ./tcm-bench [packets]
+//
+// Checks the srTCM/trTCM markers in leaky-bucket.hpp against a literal
+// reading of RFC 2697/2698 (tokens added one at a time, every tick) on a
+// random trace, color-blind and color-aware, then compares the per-packet
+// cost of marking with add_packet() on the single bucket.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "leaky-bucket.hpp"
+
+using namespace leaky;
+
+// Trace rates in bytes per microsecond, so every tick adds whole tokens
+#define CIR_PER_US 40
+#define PIR_PER_US 80
+#define CBS 10000
+#define EBS 20000
+#define PBS 20000
+
+struct Arrival
+{
+  std::int64_t gap; // Ticks since the previous packet
+  std::int64_t size;
+  Color in;         // Pre-color for color-aware runs
+};
+
+static const char *color_names[3] = {"green", "yellow", "red"};
+
+static std::vector<Arrival> make_trace(std::size_t n, std::int64_t max_gap, unsigned seed,
+                                       bool colored)
+{
+  std::vector<Arrival> trace(n);
+  std::srand(seed);
+  for (auto &a : trace)
+  {
+    a.gap = std::rand() % (max_gap + 1);
+    a.size = 64 + std::rand() % (1500 - 64 + 1);
+    int r = std::rand() % 100;
+    a.in = !colored || r >= 25 ? Color::Green : r >= 5 ? Color::Yellow : Color::Red;
+  }
+  return trace;
+}
+
+// ---------- Reference: the RFC text, one token at a time ----------
+
+struct RefSrTcm
+{
+  std::int64_t tc = CBS, te = EBS;
+
+  void tick()
+  {
+    for (int i = 0; i < CIR_PER_US; i++)
+    {
+      if (tc < CBS)
+        tc++;
+      else if (te < EBS)
+        te++;
+    }
+  }
+
+  Color mark(std::int64_t b, Color in)
+  {
+    if (in == Color::Green && tc - b >= 0)
+    {
+      tc -= b;
+      return Color::Green;
+    }
+    if ((in == Color::Green || in == Color::Yellow) && te - b >= 0)
+    {
+      te -= b;
+      return Color::Yellow;
+    }
+    return Color::Red;
+  }
+};
+
+struct RefTrTcm
+{
+  std::int64_t tc = CBS, tp = PBS;
+
+  void tick()
+  {
+    for (int i = 0; i < CIR_PER_US; i++)
+      if (tc < CBS)
+        tc++;
+    for (int i = 0; i < PIR_PER_US; i++)
+      if (tp < PBS)
+        tp++;
+  }
+
+  Color mark(std::int64_t b, Color in)
+  {
+    if (in == Color::Red || tp - b < 0)
+      return Color::Red;
+    if (in == Color::Yellow || tc - b < 0)
+    {
+      tp -= b;
+      return Color::Yellow;
+    }
+    tp -= b;
+    tc -= b;
+    return Color::Green;
+  }
+};
+
+// Replay a trace through a marker and its reference, returns mismatches
+template <class Marker, class Ref>
+static std::size_t verify(const char *name, Marker &&marker, Ref ref,
+                          const std::vector<Arrival> &trace)
+{
+  std::size_t mismatches = 0, counts[3] = {0, 0, 0};
+
+  for (const Arrival &a : trace)
+  {
+    for (std::int64_t t = 0; t < a.gap; t++)
+      ref.tick();
+    marker.clock().advance(a.gap);
+
+    Color got = marker.mark(a.size, a.in);
+    Color want = ref.mark(a.size, a.in);
+    if (got != want && mismatches++ < 5)
+      std::printf("  mismatch: %s instead of %s\n", color_names[int(got)],
+                  color_names[int(want)]);
+    counts[int(got)]++;
+  }
+
+  std::printf("  %-22s green %6zu  yellow %6zu  red %6zu  %s\n", name, counts[0], counts[1],
+              counts[2], mismatches ? "MISMATCH" : "matches RFC");
+  return mismatches;
+}
+
+// ---------- Per-packet cost ----------
+
+using NsClock = ManualClock<1000000000>;
+
+template <class F>
+static double ns_per_packet(const std::vector<Arrival> &trace, int rounds, F &&step)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+    for (const Arrival &a : trace)
+      step(a);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         (double(trace.size()) * rounds);
+}
+
+int main(int argc, char *argv[])
+{
+  std::size_t packets = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+  std::printf("=== Three-color marker check (%zu packets) ===\n", packets);
+  std::printf("CIR %d B/us, PIR %d B/us, CBS %d, EBS %d, PBS %d\n", CIR_PER_US, PIR_PER_US,
+              CBS, EBS, PBS);
+
+  std::size_t mismatches = 0;
+  for (int colored = 0; colored <= 1; colored++)
+  {
+    // 782 byte packets every 12.5 us on average: ~63 B/us, between CIR and
+    // PIR on average, with random runs above both
+    auto trace = make_trace(packets, 25, 7 + colored, colored);
+    std::printf("\n%s:\n", colored ? "Color-aware (25% pre-colored)" : "Color-blind");
+    mismatches += verify("srTCM (RFC 2697)",
+                         SrTcm<ManualClock<1000000>>(CIR_PER_US * 1000000LL, CBS, EBS),
+                         RefSrTcm(), trace);
+    mismatches += verify("trTCM (RFC 2698)",
+                         TrTcm<ManualClock<1000000>>(CIR_PER_US * 1000000LL, CBS,
+                                                      PIR_PER_US * 1000000LL, PBS),
+                         RefTrTcm(), trace);
+  }
+
+  // Cost per packet: same trace, nanosecond clocks
+  auto trace = make_trace(1 << 16, 60000, 11, false);
+  int rounds = 300;
+  std::int64_t sink = 0;
+
+  LeakyBucket<NsClock, StaticRate, int> bucket(CBS, CIR_PER_US * 1000000);
+  SrTcm<NsClock> sr(CIR_PER_US * 1000000LL, CBS, EBS);
+  TrTcm<NsClock> tr(CIR_PER_US * 1000000LL, CBS, PIR_PER_US * 1000000LL, PBS);
+
+  double t_bucket = ns_per_packet(trace, rounds, [&](const Arrival &a)
+                                  { bucket.clock().advance(a.gap);
+                                    sink += bucket.add_packet(int(a.size)); });
+  double t_sr = ns_per_packet(trace, rounds, [&](const Arrival &a)
+                              { sr.clock().advance(a.gap);
+                                sink += int(sr.mark(a.size)); });
+  double t_tr = ns_per_packet(trace, rounds, [&](const Arrival &a)
+                              { tr.clock().advance(a.gap);
+                                sink += int(tr.mark(a.size)); });
+
+  // With a real clock the clock read is most of the cost for both
+  LeakyBucket<SteadyClock, StaticRate, int> live_bucket(CBS, CIR_PER_US * 1000000);
+  SrTcm<SteadyClock> live_sr(CIR_PER_US * 1000000LL, CBS, EBS);
+  double t_live_bucket = ns_per_packet(trace, rounds / 10, [&](const Arrival &a)
+                                       { sink += live_bucket.add_packet(int(a.size)); });
+  double t_live_sr = ns_per_packet(trace, rounds / 10, [&](const Arrival &a)
+                                   { sink += int(live_sr.mark(a.size)); });
+
+  std::printf("\n=== Per-packet cost (state %zu bytes) ===\n", sizeof(MarkerState));
+  std::printf("  manual clock:  bucket %.2f ns   srTCM %.2f ns (%.2fx)   trTCM %.2f ns (%.2fx)\n",
+              t_bucket, t_sr, t_sr / t_bucket, t_tr, t_tr / t_bucket);
+  std::printf("  steady clock:  bucket %.2f ns   srTCM %.2f ns (%.2fx)\n", t_live_bucket,
+              t_live_sr, t_live_sr / t_live_bucket);
+  std::printf("  (checksum %lld)\n", (long long)sink);
+
+  if (mismatches)
+  {
+    std::printf("\nFAIL: %zu packets colored differently from the RFC\n", mismatches);
+    return 1;
+  }
+  std::printf("\nAll packets colored as the RFCs specify\n");
+  return 0;
+}
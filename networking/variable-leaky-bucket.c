@@ -1,9 +1,29 @@
+// Build: gcc variable-leaky-bucket.c bucket-config.c rate-schedule.c control-plane.c flight-recorder.c -o variable-leaky-bucket -pthread
+// Usage: ./variable-leaky-bucket [config-file] [recording]
+//        then send commands on the control socket (see control-plane.h):
+//        socat - UNIX-CONNECT:/tmp/leaky-bucket.sock
+//
+// To run on the templated C++ core instead of the arithmetic below:
+//   g++ -O2 -std=c++17 -c leaky-bucket-shim.cpp
+//   gcc -DUSE_CXX_CORE variable-leaky-bucket.c bucket-config.c rate-schedule.c control-plane.c
+//       flight-recorder.c leaky-bucket-shim.o -o variable-leaky-bucket -pthread -lstdc++
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <math.h>
 
+#include "bucket-config.h"
+#include "control-plane.h"
+#include "flight-recorder.h"
+#include "probes.h"
+#include "rate-schedule.h"
+#ifdef USE_CXX_CORE
+#include "leaky-bucket-shim.h"
+#endif
+
 // Global variables for variable leak bucket
 int bucket_capacity = 30;
 int current_level = 0;
@@ -18,20 +38,105 @@ int total_packets_accepted = 0;
 int total_packets_dropped = 0;
 int leak_rate_changes = 0;
 
-// Initialize the variable leak bucket
-void initialize_variable_bucket(int capacity, int base_rate)
+// Scheduled mode: weekly rate table and the cached next transition
+WeekSchedule leak_schedule;
+ScheduleCursor schedule_cursor;
+
+// Hot-reloaded configuration
+unsigned long applied_generation = 0; // Config generation currently in use
+int config_reader = -1;               // Grace period slot of this thread
+
+#ifdef USE_CXX_CORE
+lb_bucket *core = NULL; // Templated core, the globals above mirror its state
+#endif
+
+// Built-in schedule for when the config has no window lines
+void load_default_schedule()
+{
+  ScheduleWindow windows[] = {
+      {0x1f, 9 * 60, 12 * 60, base_leak_rate * 2},     // Peak hours, weekdays
+      {0x7f, 20 * 60, 7 * 60, base_leak_rate * 6 / 10}, // Off-peak, every night
+      {1 << 6, 2 * 60, 4 * 60, 1},                      // Maintenance, Sunday
+  };
+
+  schedule_compile(&leak_schedule, windows, sizeof(windows) / sizeof(windows[0]),
+                   base_leak_rate);
+  schedule_cursor_reset(&schedule_cursor);
+}
+
+// Initialize the variable leak bucket, returns 0 if out of memory
+int initialize_variable_bucket(int capacity, int base_rate)
 {
   bucket_capacity = capacity;
   current_level = 0;
   base_leak_rate = base_rate;
   current_leak_rate = base_rate;
   last_leak_time = time(NULL);
+  load_default_schedule();
+
+#ifdef USE_CXX_CORE
+  lb_destroy(core);
+  core = lb_create(capacity, base_rate, leak_mode);
+  if (core == NULL)
+  {
+    printf("Could not create the leaky bucket\n");
+    return 0;
+  }
+  lb_set_schedule(core, &leak_schedule);
+#endif
 
   printf("Variable Leak Bucket initialized:\n");
   printf("- Capacity: %d packets\n", capacity);
   printf("- Base Leak Rate: %d packets/second\n", base_rate);
   printf("- Current Leak Rate: %d packets/second\n", current_leak_rate);
   printf("- Initial Level: %d packets\n\n", current_level);
+  return 1;
+}
+
+// Take the schedule from a config snapshot (the built-in one if it has no
+// windows). It is copied: the snapshot is only ours until quiescent.
+void apply_schedule(const BucketConfig *cfg)
+{
+  if (cfg->num_windows > 0)
+  {
+    leak_schedule = cfg->schedule;
+    schedule_cursor_reset(&schedule_cursor);
+  }
+  else
+  {
+    load_default_schedule();
+  }
+  strcpy(leak_schedule.timezone, cfg->schedule.timezone);
+  schedule_use_timezone(&leak_schedule);
+#ifdef USE_CXX_CORE
+  if (core != NULL)
+  {
+    lb_set_schedule(core, &leak_schedule); // Drops its cached transition
+  }
+#endif
+}
+
+// Pick up a reloaded configuration (one atomic load, never blocks)
+void apply_config()
+{
+  const BucketConfig *cfg = config_current();
+
+  if (cfg != NULL && cfg->generation != applied_generation)
+  {
+    bucket_capacity = cfg->capacity;
+    base_leak_rate = cfg->base_leak_rate;
+    leak_mode = cfg->leak_mode;
+    applied_generation = cfg->generation;
+    printf("CONFIG: Capacity %d packets, base leak rate %d packets/second, mode %d\n",
+           bucket_capacity, base_leak_rate, leak_mode);
+#ifdef USE_CXX_CORE
+    lb_set_params(core, bucket_capacity, base_leak_rate);
+#endif
+    apply_schedule(cfg);
+  }
+
+  // Done with the snapshot, the old one may now be freed
+  config_reader_quiescent(config_reader);
 }
 
 // Adaptive leak rate based on bucket fill level
@@ -74,38 +179,21 @@ void adaptive_leak_rate()
   }
 }
 
-// Scheduled leak rate based on time of day simulation
+// Scheduled leak rate from the weekly schedule. Between transitions this
+// is one compare against the cached time of the next one.
 void scheduled_leak_rate()
 {
   int old_rate = current_leak_rate;
-  time_t current_time = time(NULL);
-  int time_slot = (current_time % 60); // Simulate different time periods
-
-  if (time_slot < 15)
-  {
-    // Peak hours: high leak rate
-    current_leak_rate = base_leak_rate * 2;
-  }
-  else if (time_slot < 30)
-  {
-    // Business hours: normal rate
-    current_leak_rate = base_leak_rate;
-  }
-  else if (time_slot < 45)
-  {
-    // Off-peak: reduced rate
-    current_leak_rate = (int)(base_leak_rate * 0.6);
-  }
-  else
-  {
-    // Maintenance window: very low rate
-    current_leak_rate = 1;
-  }
+  current_leak_rate = schedule_rate(&leak_schedule, &schedule_cursor, time(NULL));
 
   if (old_rate != current_leak_rate)
   {
-    printf("SCHEDULED: Leak rate changed from %d to %d (time slot: %d)\n",
-           old_rate, current_leak_rate, time_slot);
+    struct tm until;
+    char until_text[32];
+    localtime_r(&schedule_cursor.next_change, &until);
+    strftime(until_text, sizeof(until_text), "%a %H:%M", &until);
+    printf("SCHEDULED: Leak rate changed from %d to %d (until %s)\n",
+           old_rate, current_leak_rate, until_text);
     leak_rate_changes++;
   }
 }
@@ -191,6 +279,8 @@ void priority_leak_rate(int packet_priority)
 // Update leak rate based on selected mode
 void update_leak_rate(int packet_priority)
 {
+  int old_rate = current_leak_rate;
+
   switch (leak_mode)
   {
   case 1:
@@ -208,11 +298,38 @@ void update_leak_rate(int packet_priority)
   default:
     current_leak_rate = base_leak_rate;
   }
+
+  if (current_leak_rate != old_rate)
+  {
+    PROBE_RATE_CHANGE(old_rate, current_leak_rate, leak_mode);
+  }
+}
+
+// Report packets that leaked out
+void report_leak(int packets_to_leak)
+{
+  if (packets_to_leak > 0)
+  {
+    PROBE_LEAK(packets_to_leak, current_level, current_leak_rate);
+    recorder_record(current_level, current_leak_rate, total_packets_accepted,
+                    total_packets_dropped);
+    printf("Leaked %d packets at rate %d/sec. Level: %d/%d\n",
+           packets_to_leak, current_leak_rate, current_level, bucket_capacity);
+  }
 }
 
 // Variable leak simulation
 void variable_leak_bucket()
 {
+#ifdef USE_CXX_CORE
+  int packets_to_leak = lb_leak(core);
+  current_level = lb_level(core);
+  if (packets_to_leak > 0)
+  {
+    last_leak_time = time(NULL);
+  }
+  report_leak(packets_to_leak);
+#else
   time_t current_time = time(NULL);
   int time_elapsed = current_time - last_leak_time;
 
@@ -228,13 +345,18 @@ void variable_leak_bucket()
 
     current_level -= packets_to_leak;
     last_leak_time = current_time;
-
-    if (packets_to_leak > 0)
-    {
-      printf("Leaked %d packets at rate %d/sec. Level: %d/%d\n",
-             packets_to_leak, current_leak_rate, current_level, bucket_capacity);
-    }
+    report_leak(packets_to_leak);
   }
+#endif
+}
+
+// Empty the bucket, the counters are left alone
+void empty_bucket()
+{
+  current_level = 0;
+#ifdef USE_CXX_CORE
+  lb_reset(core);
+#endif
 }
 
 // Add packet with priority support
@@ -242,19 +364,59 @@ int add_packet_with_priority(int packet_size, int priority)
 {
   total_packets_received++;
 
+  // Parameters may have been reloaded since the last packet
+  apply_config();
+
+#ifdef USE_CXX_CORE
+  // The core updates the rate, leaks and admits in one call; what it did
+  // is read back from the rate and level it reports
+  int old_rate = current_leak_rate;
+  int old_level = current_level;
+
+  lb_set_mode(core, leak_mode);
+  int fits = lb_add_packet(core, packet_size, priority);
+  int level = lb_level(core);
+  current_leak_rate = lb_rate(core);
+
+  if (current_leak_rate != old_rate)
+  {
+    printf("Leak rate changed from %d to %d (mode: %d)\n", old_rate, current_leak_rate,
+           leak_mode);
+    PROBE_RATE_CHANGE(old_rate, current_leak_rate, leak_mode);
+    leak_rate_changes++;
+  }
+
+  // The leak came before the packet went in, report it at that level
+  current_level = fits ? level - packet_size : level;
+  if (current_level < old_level)
+  {
+    last_leak_time = time(NULL);
+  }
+  report_leak(old_level - current_level);
+  current_level = level;
+#else
   // Update leak rate based on mode and priority
   update_leak_rate(priority);
 
   // Perform leaking
   variable_leak_bucket();
 
+  int fits = current_level + packet_size <= bucket_capacity;
+  if (fits)
+  {
+    current_level += packet_size;
+  }
+#endif
+
   printf("Packet arrived: size=%d, priority=%d\n", packet_size, priority);
 
   // Check if packet can fit
-  if (current_level + packet_size <= bucket_capacity)
+  if (fits)
   {
-    current_level += packet_size;
     total_packets_accepted++;
+    PROBE_ACCEPT(priority, packet_size, current_level, current_leak_rate);
+    recorder_record(current_level, current_leak_rate, total_packets_accepted,
+                    total_packets_dropped);
     printf("Packet accepted. Level: %d/%d (%.1f%% full)\n",
            current_level, bucket_capacity,
            (float)current_level / bucket_capacity * 100);
@@ -263,6 +425,9 @@ int add_packet_with_priority(int packet_size, int priority)
   else
   {
     total_packets_dropped++;
+    PROBE_DROP(priority, packet_size, current_level, current_leak_rate, DROP_OVERFLOW);
+    recorder_record(current_level, current_leak_rate, total_packets_accepted,
+                    total_packets_dropped);
     printf("Packet dropped! Overflow. Level: %d/%d\n",
            current_level, bucket_capacity);
     return 0;
@@ -278,6 +443,7 @@ int add_packet(int packet_size)
 // Display comprehensive status
 void print_detailed_status()
 {
+  apply_config();
   variable_leak_bucket();
   float fill_percentage = (float)current_level / bucket_capacity * 100;
   float accept_rate = total_packets_received > 0 ? (float)total_packets_accepted / total_packets_received * 100 : 0;
@@ -306,7 +472,7 @@ void test_adaptive_mode()
 {
   printf("\n=== ADAPTIVE LEAK RATE TEST ===\n");
   leak_mode = 1;
-  current_level = 0;
+  empty_bucket();
 
   // Fill bucket gradually and watch leak rate adapt
   int test_packets[] = {5, 8, 6, 10, 4, 12, 3, 7, 9};
@@ -326,15 +492,32 @@ void test_scheduled_mode()
 {
   printf("\n=== SCHEDULED LEAK RATE TEST ===\n");
   leak_mode = 2;
-  current_level = 0;
+  empty_bucket();
+  schedule_print(&leak_schedule);
+
+  // Walk the coming week from transition to transition
+  ScheduleCursor cursor;
+  time_t t = time(NULL);
+  schedule_cursor_reset(&cursor);
+  printf("\nNext week from now:\n");
+  for (int i = 0; i <= leak_schedule.num_transitions && i < 16; i++)
+  {
+    struct tm local;
+    char when[32];
+    int rate = schedule_rate(&leak_schedule, &cursor, t);
+    localtime_r(&t, &local);
+    strftime(when, sizeof(when), "%a %Y-%m-%d %H:%M %Z", &local);
+    printf("  %s  rate %d\n", when, rate);
+    t = cursor.next_change;
+  }
 
-  // Send packets across different time slots
-  for (int i = 0; i < 8; i++)
+  // Live packets use the rate in effect right now
+  for (int i = 0; i < 4; i++)
   {
-    printf("\n--- Time slot test %d ---\n", i + 1);
+    printf("\n--- Scheduled test %d ---\n", i + 1);
     add_packet(5);
     print_detailed_status();
-    sleep(8); // Move to next time slot
+    sleep(1);
   }
 }
 
@@ -343,7 +526,7 @@ void test_priority_mode()
 {
   printf("\n=== PRIORITY-BASED LEAK RATE TEST ===\n");
   leak_mode = 4;
-  current_level = 0;
+  empty_bucket();
 
   // Test different priority packets
   int priorities[] = {1, 4, 2, 3, 1, 4, 2};
@@ -359,133 +542,184 @@ void test_priority_mode()
   }
 }
 
-// Interactive mode selection
-void run_interactive_mode()
+// Publish bucket state for STATS queries on the control socket
+void publish_control_stats()
 {
-  int choice, packet_size, priority;
-
-  while (1)
-  {
-    printf("\n=== VARIABLE LEAK BUCKET MENU ===\n");
-    printf("1. Set Adaptive Mode\n");
-    printf("2. Set Scheduled Mode\n");
-    printf("3. Set Load-based Mode\n");
-    printf("4. Set Priority-based Mode\n");
-    printf("5. Add Normal Packet\n");
-    printf("6. Add Priority Packet\n");
-    printf("7. Show Status\n");
-    printf("8. Reset Bucket\n");
-    printf("0. Exit\n");
-    printf("Choice: ");
-    scanf("%d", &choice);
-
-    switch (choice)
-    {
-    case 1:
-      leak_mode = 1;
-      printf("✓ Switched to Adaptive Mode\n");
-      break;
+  ControlStats stats;
+  stats.level = current_level;
+  stats.capacity = bucket_capacity;
+  stats.leak_rate = current_leak_rate;
+  stats.base_leak_rate = base_leak_rate;
+  stats.mode = leak_mode;
+  stats.received = total_packets_received;
+  stats.accepted = total_packets_accepted;
+  stats.dropped = total_packets_dropped;
+  stats.rate_changes = leak_rate_changes;
+  control_publish_stats(&stats);
+}
 
-    case 2:
-      leak_mode = 2;
-      printf("✓ Switched to Scheduled Mode\n");
-      break;
+// Every automated test in sequence
+void run_all_tests()
+{
+  test_adaptive_mode();
+  printf("\n==================================================\n");
+  test_priority_mode();
+}
 
-    case 3:
-      leak_mode = 3;
-      printf("✓ Switched to Load-based Mode\n");
-      break;
+// Built-in tests, started with RUN <n> on the control socket
+typedef struct
+{
+  const char *name;
+  void (*run)();
+} Test;
+
+static const Test tests[] = {
+    {"Adaptive leak rate test", test_adaptive_mode},
+    {"Scheduled leak rate test", test_scheduled_mode},
+    {"Priority-based leak rate test", test_priority_mode},
+    {"Run all automated tests", run_all_tests},
+};
+
+#define NUM_TESTS (int)(sizeof(tests) / sizeof(tests[0]))
+
+// Serve the control socket until EXIT. Packets, modes and tests arrive
+// without scanf, so nothing here waits on a human.
+void run_control_mode()
+{
+  ControlCommand cmd;
+  int running = 1;
 
-    case 4:
-      leak_mode = 4;
-      printf("✓ Switched to Priority-based Mode\n");
-      break;
+  printf("\nControl socket on %s, send RUN <n> for a test or EXIT to stop:\n",
+         CONTROL_SOCKET_PATH);
+  for (int i = 0; i < NUM_TESTS; i++)
+  {
+    printf("%d. %s\n", i + 1, tests[i].name);
+  }
+  publish_control_stats();
+
+  while (running)
+  {
+    // Commands arrive through a lock-free mailbox, idle briefly when empty
+    if (!control_poll_command(&cmd))
+    {
+      config_reader_quiescent(config_reader);
+      usleep(1000);
+      continue;
+    }
 
-    case 5:
-      printf("Enter packet size: ");
-      scanf("%d", &packet_size);
-      add_packet(packet_size);
+    switch (cmd.type)
+    {
+    case CMD_ADD_PACKET:
+      if (add_packet_with_priority(cmd.arg1, cmd.arg2))
+        control_reply(cmd.id, "ACCEPTED level=%d/%d", current_level, bucket_capacity);
+      else
+        control_reply(cmd.id, "DROPPED level=%d/%d", current_level, bucket_capacity);
       break;
 
-    case 6:
-      printf("Enter packet size: ");
-      scanf("%d", &packet_size);
-      printf("Enter priority (1=high, 2=medium, 3=normal, 4=low): ");
-      scanf("%d", &priority);
-      add_packet_with_priority(packet_size, priority);
+    case CMD_SET_MODE:
+      leak_mode = cmd.arg1;
+      printf("✓ Switched to mode %d\n", leak_mode);
+      control_reply(cmd.id, "OK mode=%d", leak_mode);
       break;
 
-    case 7:
-      print_detailed_status();
+    case CMD_RUN:
+      if (cmd.arg1 > NUM_TESTS)
+      {
+        control_reply(cmd.id, "ERR tests are 1-%d", NUM_TESTS);
+        break;
+      }
+      // Tests take seconds, answer before starting one
+      control_reply(cmd.id, "OK running %s", tests[cmd.arg1 - 1].name);
+      tests[cmd.arg1 - 1].run();
       break;
 
-    case 8:
-      current_level = 0;
+    case CMD_RESET:
+      empty_bucket();
       total_packets_received = 0;
       total_packets_accepted = 0;
       total_packets_dropped = 0;
       leak_rate_changes = 0;
       printf("Bucket reset\n");
+      control_reply(cmd.id, "OK reset");
       break;
 
-    case 0:
-      return;
-
-    default:
-      printf("Invalid choice!\n");
+    case CMD_EXIT:
+      control_reply(cmd.id, "OK exiting");
+      running = 0;
+      break;
     }
+
+    publish_control_stats();
   }
 }
 
-int main()
+int main(int argc, char *argv[])
 {
   printf("=== VARIABLE-LENGTH LEAK BUCKET ALGORITHM ===\n");
 
   srand(time(NULL)); // Initialize random seed
-  initialize_variable_bucket(30, 3);
 
-  int choice;
-  printf("\nSelect test mode:\n");
-  printf("1. Adaptive leak rate test\n");
-  printf("2. Scheduled leak rate test\n");
-  printf("3. Priority-based leak rate test\n");
-  printf("4. Interactive mode\n");
-  printf("5. Run all automated tests\n");
-  printf("Enter choice (1-5): ");
-  scanf("%d", &choice);
-
-  switch (choice)
+  // Load parameters from a config file and watch it for changes
+  config_reader = config_reader_register();
+  int created;
+  if (argc > 1 && config_load(argv[1]))
   {
-  case 1:
-    test_adaptive_mode();
-    break;
+    const BucketConfig *cfg = config_current();
+    created = initialize_variable_bucket(cfg->capacity, cfg->base_leak_rate);
+    leak_mode = cfg->leak_mode;
+    applied_generation = cfg->generation;
+    apply_schedule(cfg);
+
+    // Level/rate history for tuning, read it with recorder-dump
+    if (argc <= 2 && cfg->recorder_path[0] != '\0')
+    {
+      recorder_open(cfg->recorder_path, 0);
+    }
+    config_watch_start(argv[1]);
+  }
+  else
+  {
+    created = initialize_variable_bucket(30, 3);
+  }
 
-  case 2:
-    test_scheduled_mode();
-    break;
+  // A recording named on the command line wins over the config file's
+  if (argc > 2)
+  {
+    recorder_open(argv[2], 0);
+  }
 
-  case 3:
-    test_priority_mode();
-    break;
+  int status = 0;
+  if (!created)
+  {
+    status = 1;
+  }
+  else if (control_start(CONTROL_SOCKET_PATH))
+  {
+    run_control_mode();
+    control_stop();
+  }
+  else
+  {
+    printf("Could not open control socket %s\n", CONTROL_SOCKET_PATH);
+    status = 1;
+  }
 
-  case 4:
-    run_interactive_mode();
-    break;
+  if (created)
+  {
+    printf("\n=== FINAL STATISTICS ===\n");
+    print_detailed_status();
+  }
 
-  case 5:
-    test_adaptive_mode();
-    printf("\n==================================================\n");
-    test_priority_mode();
-    break;
+  // Stop reading before the watcher can wait on us
+  config_reader_unregister(config_reader);
+  config_watch_stop();
+  recorder_close();
 
-  default:
-    printf("Running adaptive mode by default...\n");
-    test_adaptive_mode();
-  }
+#ifdef USE_CXX_CORE
+  lb_destroy(core);
+#endif
 
-  printf("\n=== FINAL STATISTICS ===\n");
-  print_detailed_status();
   printf("Program completed.\n");
 
-  return 0;
+  return status;
 }
\ No newline at end of file